@@ -0,0 +1,115 @@
+/*
+AfterCrashMarkerId.h
+
+Author:  Adam Sawicki, http://asawicki.info, adam__REMOVE__@asawicki.info
+Version: 1.0.0, 2026-10-19
+License: MIT
+
+Marker values with meaning, for VulkanAfterCrash.h and D3D12AfterCrash. Macro
+AFTER_CRASH_MARKER_ID("label") returns a 32-bit hash of the label and the place
+in source code where it is used - file name (without directory) and line number.
+It is calculated at compile time, so it is just a constant:
+
+    VkAfterCrash_CmdWriteMarker(cmdBuf, buffer, 0, AFTER_CRASH_MARKER_ID("Shadow pass"));
+    context.WriteMarker(0, AFTER_CRASH_MARKER_ID("Shadow pass"), Mode);
+
+Nothing is registered at runtime. Instead, script AfterCrashMarkers.py finds
+all uses of the macro in your source code and calculates the same hashes,
+building a table of IDs, labels and source locations:
+
+    python AfterCrashMarkers.py table -o Markers.txt Src/
+
+After a crash, save markers from the buffer to a file as raw array of uint32_t,
+e.g. fwrite(pData, sizeof(uint32_t), markerCount, file), and decode it:
+
+    python AfterCrashMarkers.py decode Markers.txt Markers.bin
+
+For the script to find them, pass the label as a plain string literal and keep
+the whole macro call in one line. Same label in different places gives
+different IDs, which tells exactly which of them was executed. 0 is never
+returned, as it is the value of markers never written.
+
+Requires C++14.
+
+////////////////////////////////////////////////////////////////////////////////
+
+Copyright 2026 Adam Sawicki
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+namespace AfterCrash
+{
+
+namespace Detail
+{
+
+// 32-bit FNV-1a. Must match function MarkerId in AfterCrashMarkers.py.
+constexpr uint32_t FNV_OFFSET_BASIS = 2166136261u;
+constexpr uint32_t FNV_PRIME = 16777619u;
+
+constexpr uint32_t HashByte(uint32_t hash, uint8_t b)
+{
+    return (hash ^ b) * FNV_PRIME;
+}
+
+// Including terminating zero, so "ab" + "c" and "a" + "bc" differ.
+constexpr uint32_t HashString(uint32_t hash, const char* str)
+{
+    for(; *str; ++str)
+        hash = HashByte(hash, (uint8_t)*str);
+    return HashByte(hash, 0);
+}
+
+// __FILE__ may contain directory, depending on how the compiler was invoked.
+constexpr const char* GetFileName(const char* path)
+{
+    const char* fileName = path;
+    for(; *path; ++path)
+    {
+        if(*path == '/' || *path == '\\')
+            fileName = path + 1;
+    }
+    return fileName;
+}
+
+} // namespace Detail
+
+/*
+Returns ID of a marker with given label, used in given source file and line.
+Use macro AFTER_CRASH_MARKER_ID instead of calling it directly.
+*/
+constexpr uint32_t MakeMarkerId(const char* label, const char* file, uint32_t line)
+{
+    uint32_t hash = Detail::FNV_OFFSET_BASIS;
+    hash = Detail::HashString(hash, label);
+    hash = Detail::HashString(hash, Detail::GetFileName(file));
+    for(uint32_t i = 0; i < 4; ++i)
+        hash = Detail::HashByte(hash, (uint8_t)(line >> (i * 8)));
+    return hash != 0 ? hash : 1;
+}
+
+} // namespace AfterCrash
+
+// integral_constant forces calculation at compile time, even in debug build.
+#define AFTER_CRASH_MARKER_ID(label) \
+    (std::integral_constant<uint32_t, AfterCrash::MakeMarkerId((label), __FILE__, __LINE__)>::value)
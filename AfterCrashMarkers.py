@@ -0,0 +1,164 @@
+# AfterCrashMarkers
+#
+# Builds table of marker IDs created with macro AFTER_CRASH_MARKER_ID from
+# AfterCrashMarkerId.h and uses it to decode markers saved after a crash from
+# a buffer of VulkanAfterCrash.h or D3D12AfterCrash.
+#
+# Usage:
+#     AfterCrashMarkers.py table [-o TABLE_FILE] SOURCE...
+#         Finds uses of the macro in given source files and directories
+#         (searched recursively) and writes the table, one marker per line:
+#         ID, file:line, label, separated with tabs.
+#     AfterCrashMarkers.py decode TABLE_FILE DUMP_FILE
+#         Prints markers from DUMP_FILE - a raw array of little-endian uint32
+#         values or a file written by a buffer of VulkanAfterCrash.h created
+#         with filePath - with labels and source locations of their IDs.
+#     AfterCrashMarkers.py trace [-o OUTPUT_FILE] TABLE_FILE TRACE_FILE
+#         Replaces names of regions in a trace written by
+#         VkAfterCrash_WriteProfilerTrace - hexadecimal IDs - with labels.
+#
+# Author:  Adam Sawicki, http://asawicki.info, adam__REMOVE__@asawicki.info
+# Version: 1.2.0
+# License: MIT
+
+import argparse
+import datetime
+import json
+import os.path
+import re
+import struct
+import sys
+
+# VkAfterCrash_FileHeader from VulkanAfterCrash.h.
+FILE_MAGIC = b'VkAfCrsh'
+FILE_HEADER_FORMAT = '<8sIIIIQ'
+
+SOURCE_EXTENSIONS = ('.c', '.cc', '.cpp', '.cxx', '.h', '.hh', '.hpp', '.hxx', '.inl')
+
+reMarkerId = re.compile(r'\bAFTER_CRASH_MARKER_ID\s*\(\s*"((?:[^"\\]|\\.)*)"\s*\)')
+reEscape = re.compile(r'\\(.)')
+
+# Must match AfterCrash::MakeMarkerId in AfterCrashMarkerId.h.
+def MarkerId(label, fileName, line):
+    data = label.encode('utf-8') + b'\0' + fileName.encode('utf-8') + b'\0' + struct.pack('<I', line)
+    result = 2166136261
+    for b in data:
+        result = ((result ^ b) * 16777619) & 0xFFFFFFFF
+    return result if result != 0 else 1
+
+def ListSourceFiles(paths):
+    for path in paths:
+        if os.path.isdir(path):
+            for dirPath, dirNames, fileNames in os.walk(path):
+                dirNames.sort()
+                for fileName in sorted(fileNames):
+                    if os.path.splitext(fileName)[1].lower() in SOURCE_EXTENSIONS:
+                        yield os.path.join(dirPath, fileName)
+        else:
+            yield path
+
+def FindMarkers(filePath):
+    fileName = os.path.basename(filePath)
+    with open(filePath, 'r', encoding='utf-8', errors='replace') as file:
+        for lineIndex, line in enumerate(file):
+            for match in reMarkerId.finditer(line):
+                # Only simple escapes like \" and \\ are supported.
+                label = reEscape.sub(r'\1', match[1])
+                yield (MarkerId(label, fileName, lineIndex + 1), '{0}:{1}'.format(filePath, lineIndex + 1), label)
+
+def WriteTable(args):
+    markers = {}
+    collisionCount = 0
+    for filePath in ListSourceFiles(args.Source):
+        for markerId, location, label in FindMarkers(filePath):
+            if markerId in markers and markers[markerId] != (location, label):
+                print('WARNING: ID 0x{0:08X} of "{1}" at {2} is the same as of "{3}" at {4}.'.format(
+                    markerId, label, location, markers[markerId][1], markers[markerId][0]), file=sys.stderr)
+                collisionCount += 1
+            markers[markerId] = (location, label)
+    output = open(args.output, 'w', encoding='utf-8') if args.output else sys.stdout
+    for markerId in sorted(markers):
+        output.write('0x{0:08X}\t{1}\t{2}\n'.format(markerId, markers[markerId][0], markers[markerId][1]))
+    if args.output:
+        output.close()
+    print('{0} markers, {1} collisions.'.format(len(markers), collisionCount), file=sys.stderr)
+    return 1 if collisionCount > 0 else 0
+
+def LoadTable(filePath):
+    markers = {}
+    with open(filePath, 'r', encoding='utf-8') as file:
+        for line in file:
+            fields = line.rstrip('\r\n').split('\t', 2)
+            if len(fields) == 3:
+                markers[int(fields[0], 16)] = (fields[1], fields[2])
+    return markers
+
+def Decode(args):
+    markers = LoadTable(args.Table)
+    with open(args.Dump, 'rb') as file:
+        data = file.read()
+    if data.startswith(FILE_MAGIC) and len(data) >= struct.calcsize(FILE_HEADER_FORMAT):
+        magic, version, headerSize, markerCount, reserved, creationTime = struct.unpack_from(FILE_HEADER_FORMAT, data)
+        if version != 1 or len(data) < headerSize + markerCount * 4:
+            print('ERROR: Unsupported version or truncated file {0}.'.format(args.Dump), file=sys.stderr)
+            return 1
+        print('Buffer created {0} UTC.'.format(
+            datetime.datetime.fromtimestamp(creationTime, datetime.timezone.utc).strftime('%Y-%m-%d %H:%M:%S')), file=sys.stderr)
+        data = data[headerSize : headerSize + markerCount * 4]
+    if len(data) % 4 != 0:
+        print('ERROR: Size of {0} is not a multiple of 4 bytes.'.format(args.Dump), file=sys.stderr)
+        return 1
+    values = struct.unpack('<{0}I'.format(len(data) // 4), data)
+    unknownCount = 0
+    for index, value in enumerate(values):
+        if value == 0:
+            continue # Never written.
+        if value in markers:
+            location, label = markers[value]
+            print('{0:8} 0x{1:08X} {2} ({3})'.format(index, value, label, location))
+        else:
+            print('{0:8} 0x{1:08X} ?'.format(index, value))
+            unknownCount += 1
+    print('{0} markers, {1} not written, {2} unknown.'.format(
+        len(values), values.count(0), unknownCount), file=sys.stderr)
+    return 0
+
+def Trace(args):
+    markers = LoadTable(args.Table)
+    with open(args.Trace, 'r', encoding='utf-8') as file:
+        trace = json.load(file)
+    unknownCount = 0
+    for event in trace['traceEvents']:
+        markerId = int(event['name'], 16)
+        if markerId in markers:
+            location, label = markers[markerId]
+            event['name'] = label
+            event.setdefault('args', {})['location'] = location
+        else:
+            unknownCount += 1
+    output = open(args.output, 'w', encoding='utf-8') if args.output else sys.stdout
+    json.dump(trace, output, indent=0)
+    if args.output:
+        output.close()
+    print('{0} regions, {1} unknown.'.format(len(trace['traceEvents']), unknownCount), file=sys.stderr)
+    return 0
+
+parser = argparse.ArgumentParser(description='Build table of marker IDs from AfterCrashMarkerId.h or decode markers saved after crash.')
+subparsers = parser.add_subparsers(dest='Command')
+subparsers.required = True
+tableParser = subparsers.add_parser('table', help='find marker IDs in source code and write their table')
+tableParser.add_argument('Source', nargs='+', help='source file or directory')
+tableParser.add_argument('-o', dest='output', help='output file, standard output if not specified')
+tableParser.set_defaults(func=WriteTable)
+decodeParser = subparsers.add_parser('decode', help='print markers from a dump of marker buffer with their labels')
+decodeParser.add_argument('Table', help='table written by command "table"')
+decodeParser.add_argument('Dump', help='raw array of uint32 markers or file of a file-backed buffer')
+decodeParser.set_defaults(func=Decode)
+traceParser = subparsers.add_parser('trace', help='replace marker IDs in a trace from VkAfterCrash_WriteProfilerTrace with their labels')
+traceParser.add_argument('Table', help='table written by command "table"')
+traceParser.add_argument('Trace', help='trace file in JSON format')
+traceParser.add_argument('-o', dest='output', help='output file, standard output if not specified')
+traceParser.set_defaults(func=Trace)
+
+args = parser.parse_args()
+sys.exit(args.func(args))
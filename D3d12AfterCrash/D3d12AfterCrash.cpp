@@ -2,13 +2,16 @@
 D3D12AfterCrash
 
 Author:  Adam Sawicki, http://asawicki.info, adam__REMOVE__@asawicki.info
-Version: 1.0.0, 2018-09-12
+Version: 1.4.0, 2026-10-19
 License: MIT
 
 For documentation and license, see accompanying file D3d12AfterCrash.h.
 */
 #include "D3d12AfterCrash.h"
 
+#include <atomic>
+#include <cassert>
+
 namespace D3D12AfterCrash
 {
 
@@ -39,12 +42,17 @@ public:
     BufferImpl() :
         m_pBuf(nullptr),
         m_BufGpuAddr(0),
-        m_pBufData(nullptr)
+        m_pBufData(nullptr),
+        m_MarkerCount(0),
+        m_NextMarkerIndex(0)
     {
     }
     HRESULT Init(Device* Parent, const BUFFER_DESC* Desc, UINT** ppData);
     virtual ~BufferImpl();
 
+    virtual UINT GetMarkerCount() const { return m_MarkerCount; }
+    virtual D3D12_GPU_VIRTUAL_ADDRESS GetGpuVirtualAddress() const { return m_BufGpuAddr; }
+
     virtual void WriteMarker(
         ID3D12GraphicsCommandList2* pCommandList,
         UINT MarkerIndex,
@@ -56,12 +64,56 @@ public:
         UINT Value,
         D3D12_WRITEBUFFERIMMEDIATE_MODE Mode);
 
+    virtual void WriteMarkers(
+        ID3D12GraphicsCommandList2* pCommandList,
+        UINT MarkerCount,
+        const MARKER* pMarkers);
+    virtual void WriteMarkers(
+        ID3D12GraphicsCommandList* pCommandList,
+        UINT MarkerCount,
+        const MARKER* pMarkers);
+    virtual void WriteMarkerRange(
+        ID3D12GraphicsCommandList2* pCommandList,
+        UINT FirstMarkerIndex,
+        UINT MarkerCount,
+        const UINT* pValues,
+        D3D12_WRITEBUFFERIMMEDIATE_MODE Mode);
+    virtual void WriteMarkerRange(
+        ID3D12GraphicsCommandList* pCommandList,
+        UINT FirstMarkerIndex,
+        UINT MarkerCount,
+        const UINT* pValues,
+        D3D12_WRITEBUFFERIMMEDIATE_MODE Mode);
+
+    virtual UINT AllocateMarkers(UINT MarkerCount);
+    virtual void BeginMarkerRange(UINT MarkerCount, MARKER_RANGE* pRange);
+    virtual UINT WriteNextMarker(
+        ID3D12GraphicsCommandList2* pCommandList,
+        MARKER_RANGE* pRange,
+        UINT Value,
+        D3D12_WRITEBUFFERIMMEDIATE_MODE Mode);
+    virtual UINT WriteNextMarker(
+        ID3D12GraphicsCommandList* pCommandList,
+        MARKER_RANGE* pRange,
+        UINT Value,
+        D3D12_WRITEBUFFERIMMEDIATE_MODE Mode);
+
 private:
     ID3D12Resource* m_pBuf;
     D3D12_GPU_VIRTUAL_ADDRESS m_BufGpuAddr;
     UINT* m_pBufData;
+    UINT m_MarkerCount;
+    // Index of the first free marker slot, from 0 to m_MarkerCount.
+    std::atomic<UINT> m_NextMarkerIndex;
+
+    UINT TakeNextMarker(MARKER_RANGE* pRange);
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// Global variables
+
+MARKER_LEVEL MarkerLevelThreshold = MARKER_LEVEL_FINE;
+
 ////////////////////////////////////////////////////////////////////////////////
 // Device class implementation
 
@@ -115,6 +167,8 @@ HRESULT CreateDevice(const DEVICE_DESC* Desc, Device** ppDevice)
 
 HRESULT BufferImpl::Init(Device* Parent, const BUFFER_DESC* Desc, UINT** ppData)
 {
+    m_MarkerCount = Desc->MarkerCount;
+
     D3D12_HEAP_PROPERTIES heapProperties = { D3D12_HEAP_TYPE_READBACK };
     
     D3D12_RESOURCE_DESC resourceDesc = { D3D12_RESOURCE_DIMENSION_BUFFER };
@@ -174,4 +228,226 @@ void BufferImpl::WriteMarker(
     commandList2->Release();
 }
 
+// Number of markers passed to a single WriteBufferImmediate call by
+// WriteMarkers and WriteMarkerRange, limited by size of arrays on the stack.
+static const UINT MAX_BATCH_MARKER_COUNT = 256;
+
+void BufferImpl::WriteMarkers(
+    ID3D12GraphicsCommandList2* pCommandList,
+    UINT MarkerCount,
+    const MARKER* pMarkers)
+{
+    D3D12_WRITEBUFFERIMMEDIATE_PARAMETER params[MAX_BATCH_MARKER_COUNT];
+    D3D12_WRITEBUFFERIMMEDIATE_MODE modes[MAX_BATCH_MARKER_COUNT];
+    while(MarkerCount > 0)
+    {
+        const UINT batchMarkerCount = MarkerCount < MAX_BATCH_MARKER_COUNT ? MarkerCount : MAX_BATCH_MARKER_COUNT;
+        for(UINT i = 0; i < batchMarkerCount; ++i)
+        {
+            assert(pMarkers[i].MarkerIndex < m_MarkerCount);
+            params[i].Dest = m_BufGpuAddr + pMarkers[i].MarkerIndex * sizeof(UINT);
+            params[i].Value = pMarkers[i].Value;
+            modes[i] = pMarkers[i].Mode;
+        }
+        pCommandList->WriteBufferImmediate(batchMarkerCount, params, modes);
+        pMarkers += batchMarkerCount;
+        MarkerCount -= batchMarkerCount;
+    }
+}
+
+void BufferImpl::WriteMarkers(
+    ID3D12GraphicsCommandList* pCommandList,
+    UINT MarkerCount,
+    const MARKER* pMarkers)
+{
+    ID3D12GraphicsCommandList2* commandList2;
+    pCommandList->QueryInterface(IID_PPV_ARGS(&commandList2));
+    WriteMarkers(commandList2, MarkerCount, pMarkers);
+    commandList2->Release();
+}
+
+void BufferImpl::WriteMarkerRange(
+    ID3D12GraphicsCommandList2* pCommandList,
+    UINT FirstMarkerIndex,
+    UINT MarkerCount,
+    const UINT* pValues,
+    D3D12_WRITEBUFFERIMMEDIATE_MODE Mode)
+{
+    assert(FirstMarkerIndex + MarkerCount <= m_MarkerCount);
+    D3D12_WRITEBUFFERIMMEDIATE_PARAMETER params[MAX_BATCH_MARKER_COUNT];
+    D3D12_WRITEBUFFERIMMEDIATE_MODE modes[MAX_BATCH_MARKER_COUNT];
+    for(UINT i = 0; i < MAX_BATCH_MARKER_COUNT; ++i)
+        modes[i] = Mode;
+    while(MarkerCount > 0)
+    {
+        const UINT batchMarkerCount = MarkerCount < MAX_BATCH_MARKER_COUNT ? MarkerCount : MAX_BATCH_MARKER_COUNT;
+        for(UINT i = 0; i < batchMarkerCount; ++i)
+        {
+            params[i].Dest = m_BufGpuAddr + (FirstMarkerIndex + i) * sizeof(UINT);
+            params[i].Value = pValues[i];
+        }
+        pCommandList->WriteBufferImmediate(batchMarkerCount, params, modes);
+        FirstMarkerIndex += batchMarkerCount;
+        pValues += batchMarkerCount;
+        MarkerCount -= batchMarkerCount;
+    }
+}
+
+void BufferImpl::WriteMarkerRange(
+    ID3D12GraphicsCommandList* pCommandList,
+    UINT FirstMarkerIndex,
+    UINT MarkerCount,
+    const UINT* pValues,
+    D3D12_WRITEBUFFERIMMEDIATE_MODE Mode)
+{
+    ID3D12GraphicsCommandList2* commandList2;
+    pCommandList->QueryInterface(IID_PPV_ARGS(&commandList2));
+    WriteMarkerRange(commandList2, FirstMarkerIndex, MarkerCount, pValues, Mode);
+    commandList2->Release();
+}
+
+UINT BufferImpl::AllocateMarkers(UINT MarkerCount)
+{
+    assert(MarkerCount > 0 && MarkerCount <= m_MarkerCount);
+    UINT nextMarkerIndex = m_NextMarkerIndex.load(std::memory_order_relaxed);
+    for(;;)
+    {
+        // Range would cross the end of the buffer. Leave the rest unused and
+        // start again from the beginning.
+        const UINT firstMarkerIndex =
+            MarkerCount <= m_MarkerCount - nextMarkerIndex ? nextMarkerIndex : 0;
+        if(m_NextMarkerIndex.compare_exchange_weak(
+            nextMarkerIndex, firstMarkerIndex + MarkerCount,
+            std::memory_order_relaxed, std::memory_order_relaxed))
+        {
+            return firstMarkerIndex;
+        }
+    }
+}
+
+void BufferImpl::BeginMarkerRange(UINT MarkerCount, MARKER_RANGE* pRange)
+{
+    pRange->MarkerCount = MarkerCount;
+    pRange->NextMarkerIndex = AllocateMarkers(MarkerCount);
+    pRange->EndMarkerIndex = pRange->NextMarkerIndex + MarkerCount;
+}
+
+UINT BufferImpl::TakeNextMarker(MARKER_RANGE* pRange)
+{
+    if(pRange->NextMarkerIndex == pRange->EndMarkerIndex)
+    {
+        pRange->NextMarkerIndex = AllocateMarkers(pRange->MarkerCount);
+        pRange->EndMarkerIndex = pRange->NextMarkerIndex + pRange->MarkerCount;
+    }
+    return pRange->NextMarkerIndex++;
+}
+
+UINT BufferImpl::WriteNextMarker(
+    ID3D12GraphicsCommandList2* pCommandList,
+    MARKER_RANGE* pRange,
+    UINT Value,
+    D3D12_WRITEBUFFERIMMEDIATE_MODE Mode)
+{
+    const UINT markerIndex = TakeNextMarker(pRange);
+    WriteMarker(pCommandList, markerIndex, Value, Mode);
+    return markerIndex;
+}
+
+UINT BufferImpl::WriteNextMarker(
+    ID3D12GraphicsCommandList* pCommandList,
+    MARKER_RANGE* pRange,
+    UINT Value,
+    D3D12_WRITEBUFFERIMMEDIATE_MODE Mode)
+{
+    const UINT markerIndex = TakeNextMarker(pRange);
+    WriteMarker(pCommandList, markerIndex, Value, Mode);
+    return markerIndex;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// CommandListContext class implementation
+
+CommandListContext::CommandListContext() :
+    m_pBuffer(nullptr),
+    m_pCommandList(nullptr),
+    m_BufGpuAddr(0),
+    m_MarkerCount(0)
+{
+    m_Range.MarkerCount = 0;
+    m_Range.NextMarkerIndex = 0;
+    m_Range.EndMarkerIndex = 0;
+}
+
+CommandListContext::~CommandListContext()
+{
+    Release();
+}
+
+HRESULT CommandListContext::Init(Buffer* pBuffer, ID3D12GraphicsCommandList* pCommandList)
+{
+    Release();
+    HRESULT hr = pCommandList->QueryInterface(IID_PPV_ARGS(&m_pCommandList));
+    if(FAILED(hr))
+    {
+        m_pCommandList = nullptr;
+        return hr;
+    }
+    m_pBuffer = pBuffer;
+    m_BufGpuAddr = pBuffer->GetGpuVirtualAddress();
+    m_MarkerCount = pBuffer->GetMarkerCount();
+    // Default range of 1 marker, allocated on first WriteNextMarker, so it is
+    // valid even without BeginMarkerRange. Also drops a range left from a
+    // previous buffer.
+    m_Range.MarkerCount = 1;
+    m_Range.NextMarkerIndex = 0;
+    m_Range.EndMarkerIndex = 0;
+    return S_OK;
+}
+
+void CommandListContext::Release()
+{
+    if(m_pCommandList)
+    {
+        m_pCommandList->Release();
+        m_pCommandList = nullptr;
+    }
+    m_pBuffer = nullptr;
+}
+
+void CommandListContext::WriteMarker(UINT MarkerIndex, UINT Value, D3D12_WRITEBUFFERIMMEDIATE_MODE Mode)
+{
+    assert(MarkerIndex < m_MarkerCount);
+    D3D12_WRITEBUFFERIMMEDIATE_PARAMETER param = { m_BufGpuAddr + MarkerIndex * sizeof(UINT), Value };
+    m_pCommandList->WriteBufferImmediate(1, &param, &Mode);
+}
+
+void CommandListContext::WriteMarkers(UINT MarkerCount, const MARKER* pMarkers)
+{
+    m_pBuffer->WriteMarkers(m_pCommandList, MarkerCount, pMarkers);
+}
+
+void CommandListContext::WriteMarkerRange(UINT FirstMarkerIndex, UINT MarkerCount, const UINT* pValues,
+    D3D12_WRITEBUFFERIMMEDIATE_MODE Mode)
+{
+    m_pBuffer->WriteMarkerRange(m_pCommandList, FirstMarkerIndex, MarkerCount, pValues, Mode);
+}
+
+void CommandListContext::BeginMarkerRange(UINT MarkerCount)
+{
+    m_pBuffer->BeginMarkerRange(MarkerCount, &m_Range);
+}
+
+UINT CommandListContext::WriteNextMarker(UINT Value, D3D12_WRITEBUFFERIMMEDIATE_MODE Mode)
+{
+    if(m_Range.NextMarkerIndex == m_Range.EndMarkerIndex)
+    {
+        // Only when the range is used up - rarely, if it is large enough.
+        m_Range.NextMarkerIndex = m_pBuffer->AllocateMarkers(m_Range.MarkerCount);
+        m_Range.EndMarkerIndex = m_Range.NextMarkerIndex + m_Range.MarkerCount;
+    }
+    const UINT markerIndex = m_Range.NextMarkerIndex++;
+    WriteMarker(markerIndex, Value, Mode);
+    return markerIndex;
+}
+
 } // namespace D3D12AfterCrash
@@ -2,7 +2,7 @@
 D3D12AfterCrash
 
 Author:  Adam Sawicki, http://asawicki.info, adam__REMOVE__@asawicki.info
-Version: 1.0.0, 2018-09-12
+Version: 1.4.0, 2026-10-19
 License: MIT
 
 This is a simple C++ library for Direct3D 12 that simplifies writing
@@ -19,7 +19,17 @@ How to use it:
 4. Create one or more D3D12VkAfterCrash::Buffer objects using method
    CreateBuffer.
 5. While recording your commands to ID3D12GraphicsCommandList, record also
-   marker writes using function WriteMarker.
+   marker writes using function WriteMarker. To write many markers at once, use
+   WriteMarkers or WriteMarkerRange.
+   When recording many command lists in parallel, instead of choosing marker
+   indices yourself, reserve a range of them for each command list using
+   method BeginMarkerRange and write markers using method WriteNextMarker.
+   If you write many markers to the same command list, create
+   a CommandListContext object for it and write markers through it instead -
+   see below.
+   To be able to control how many markers are written, wrap these calls in
+   macro D3D12_AFTER_CRASH_MARKER, which takes a level of detail - see
+   MARKER_LEVEL.
 6. If graphics driver crashes, you receive DXGI_ERROR_DEVICE_REMOVED from
    a D3D12 function like Present. After it happened, inspect values under ppData
    pointer returned by CreateBuffer to see value of markers successfully
@@ -88,8 +98,83 @@ struct BUFFER_DESC
     UINT MarkerCount;
 };
 
+// Marker to be written by Buffer::WriteMarkers.
+struct MARKER
+{
+    UINT MarkerIndex;
+    UINT Value;
+    D3D12_WRITEBUFFERIMMEDIATE_MODE Mode;
+};
+
+/*
+Range of marker slots reserved for one command list, used by method
+Buffer::WriteNextMarker, which takes consecutive slots from it. When it is used
+up, a new one of the same size is allocated automatically, so it doesn't need
+to be large enough for all markers of the command list.
+
+It is not thread-safe - use a separate one for each command list being
+recorded. Members are for internal use.
+*/
+struct MARKER_RANGE
+{
+    UINT MarkerCount;
+    UINT NextMarkerIndex;
+    UINT EndMarkerIndex;
+};
+
+/*
+Level of detail of a marker, passed to macro D3D12_AFTER_CRASH_MARKER. A marker
+is written only if its level is not greater than both:
+
+- D3D12_AFTER_CRASH_MAX_MARKER_LEVEL - compile-time ceiling. Markers above it
+  are compiled out completely - their arguments are not even evaluated. If you
+  define it, do it before every include of this file.
+- MarkerLevelThreshold - runtime threshold. Markers above it cost just one
+  comparison.
+
+This way you can ship detailed markers and turn them on only when needed, e.g.
+on machines that reported crashes.
+*/
+enum MARKER_LEVEL
+{
+    // Used only as a threshold, to disable all markers.
+    MARKER_LEVEL_OFF,
+    // Few markers per frame, e.g. around render passes.
+    MARKER_LEVEL_PASS,
+    // Marker per draw call or dispatch.
+    MARKER_LEVEL_DRAW,
+    // Even more detailed, e.g. around copies and barriers.
+    MARKER_LEVEL_FINE,
+};
+
+#ifndef D3D12_AFTER_CRASH_MAX_MARKER_LEVEL
+    #define D3D12_AFTER_CRASH_MAX_MARKER_LEVEL D3D12AfterCrash::MARKER_LEVEL_FINE
+#endif
+
+/*
+Default: MARKER_LEVEL_FINE. Set it e.g. at startup, when no command lists are
+being recorded, as it is read without synchronization.
+*/
+extern MARKER_LEVEL MarkerLevelThreshold;
+
+inline bool IsMarkerLevelEnabled(MARKER_LEVEL Level)
+{
+    return Level <= D3D12_AFTER_CRASH_MAX_MARKER_LEVEL && Level <= MarkerLevelThreshold;
+}
+
+/*
+Executes Statement, which should write a marker, only if Level, which should
+be a constant, is enabled. Example:
+
+D3D12_AFTER_CRASH_MARKER(D3D12AfterCrash::MARKER_LEVEL_DRAW,
+    context.WriteMarker(0, drawIndex, D3D12_WRITEBUFFERIMMEDIATE_MODE_MARKER_IN));
+*/
+#define D3D12_AFTER_CRASH_MARKER(Level, Statement) \
+    do { if(D3D12AfterCrash::IsMarkerLevelEnabled(Level)) { Statement; } } while(false)
+
 class Device;
 class Buffer;
+class CommandListContext;
 
 HRESULT CreateDevice(const DEVICE_DESC* Desc, Device** ppDevice);
 
@@ -117,6 +202,10 @@ class Buffer
 public:
     virtual ~Buffer() { }
 
+    virtual UINT GetMarkerCount() const = 0;
+    // Address of the marker with index 0.
+    virtual D3D12_GPU_VIRTUAL_ADDRESS GetGpuVirtualAddress() const = 0;
+
     /*
     Records command to a D3D12 command list that will write 32-bit marker to
     specific place in specific buffer.
@@ -145,6 +234,135 @@ public:
         UINT MarkerIndex,
         UINT Value,
         D3D12_WRITEBUFFERIMMEDIATE_MODE Mode) = 0;
+
+    /*
+    Records command that writes MarkerCount 32-bit markers, each to specific
+    place in the buffer with its own mode, like WriteMarker called for each of
+    them. All of them are passed to a single WriteBufferImmediate call, split
+    only to limit size of temporary arrays.
+    */
+    virtual void WriteMarkers(
+        ID3D12GraphicsCommandList2* pCommandList,
+        UINT MarkerCount,
+        const MARKER* pMarkers) = 0;
+    virtual void WriteMarkers(
+        ID3D12GraphicsCommandList* pCommandList,
+        UINT MarkerCount,
+        const MARKER* pMarkers) = 0;
+
+    /*
+    Records command that writes MarkerCount 32-bit values from pValues to
+    consecutive markers starting from FirstMarkerIndex, all with the same mode.
+    */
+    virtual void WriteMarkerRange(
+        ID3D12GraphicsCommandList2* pCommandList,
+        UINT FirstMarkerIndex,
+        UINT MarkerCount,
+        const UINT* pValues,
+        D3D12_WRITEBUFFERIMMEDIATE_MODE Mode) = 0;
+    virtual void WriteMarkerRange(
+        ID3D12GraphicsCommandList* pCommandList,
+        UINT FirstMarkerIndex,
+        UINT MarkerCount,
+        const UINT* pValues,
+        D3D12_WRITEBUFFERIMMEDIATE_MODE Mode) = 0;
+
+    /*
+    Reserves MarkerCount consecutive marker slots and returns index of the
+    first one. It is thread-safe and lock-free - it takes a single atomic
+    compare-and-swap, retried only when another thread allocates at the same
+    time.
+
+    Slots are taken from the buffer in a ring: after its end is reached,
+    allocation starts again from the beginning, so markers of old command lists
+    get overwritten. Create the buffer large enough for markers of all command
+    lists that can be in flight. A range never crosses the end of the buffer.
+    MarkerCount must not be greater than number of markers in the buffer.
+    */
+    virtual UINT AllocateMarkers(UINT MarkerCount) = 0;
+
+    /*
+    Initializes marker range with MarkerCount slots allocated using
+    AllocateMarkers. Call it when you start recording a command list. Larger
+    ranges mean fewer atomic operations on the buffer, shared by all threads.
+    */
+    virtual void BeginMarkerRange(UINT MarkerCount, MARKER_RANGE* pRange) = 0;
+
+    /*
+    Same as WriteMarker, but writes to the next slot from the range, which must
+    have been initialized by this buffer. Returns index of the marker slot used.
+    */
+    virtual UINT WriteNextMarker(
+        ID3D12GraphicsCommandList2* pCommandList,
+        MARKER_RANGE* pRange,
+        UINT Value,
+        D3D12_WRITEBUFFERIMMEDIATE_MODE Mode) = 0;
+    virtual UINT WriteNextMarker(
+        ID3D12GraphicsCommandList* pCommandList,
+        MARKER_RANGE* pRange,
+        UINT Value,
+        D3D12_WRITEBUFFERIMMEDIATE_MODE Mode) = 0;
+};
+
+/*
+Writes markers to one buffer, recorded to one command list.
+
+Methods of Buffer taking ID3D12GraphicsCommandList call QueryInterface and
+Release on it for every marker, and all of them are virtual. This object
+fetches ID3D12GraphicsCommandList2 and address of the buffer once, in Init, so
+writing a single marker is just one WriteBufferImmediate call - still a virtual
+COM call, but without QueryInterface, Release or a virtual call into this
+library.
+
+Test/CommandListContextTest.cpp checks it against a mock command list on any
+platform, using Test/d3d12.h instead of the Windows SDK.
+
+ID3D12GraphicsCommandList object stays the same after Reset, so the context can
+live as long as the command list, e.g. one per thread recording commands. It
+keeps a reference to the command list, but not to the buffer - destroy it
+before the buffer. It is not thread-safe.
+*/
+class CommandListContext
+{
+public:
+    CommandListContext();
+    ~CommandListContext();
+
+    // Fails with E_NOINTERFACE if ID3D12GraphicsCommandList2 is not supported.
+    HRESULT Init(Buffer* pBuffer, ID3D12GraphicsCommandList* pCommandList);
+    // Releases the command list. Called automatically by destructor.
+    void Release();
+
+    Buffer* GetBuffer() const { return m_pBuffer; }
+    ID3D12GraphicsCommandList2* GetCommandList() const { return m_pCommandList; }
+
+    // Same as Buffer::WriteMarker.
+    void WriteMarker(UINT MarkerIndex, UINT Value, D3D12_WRITEBUFFERIMMEDIATE_MODE Mode);
+    // Same as Buffer::WriteMarkers.
+    void WriteMarkers(UINT MarkerCount, const MARKER* pMarkers);
+    // Same as Buffer::WriteMarkerRange.
+    void WriteMarkerRange(UINT FirstMarkerIndex, UINT MarkerCount, const UINT* pValues,
+        D3D12_WRITEBUFFERIMMEDIATE_MODE Mode);
+
+    /*
+    Same as Buffer::BeginMarkerRange and Buffer::WriteNextMarker, using marker
+    range stored inside this object. Call BeginMarkerRange every time the
+    command list is reset. Until it is called, Init leaves a range of 1 marker,
+    so WriteNextMarker still works, but takes an atomic operation on the buffer
+    for every marker.
+    */
+    void BeginMarkerRange(UINT MarkerCount);
+    UINT WriteNextMarker(UINT Value, D3D12_WRITEBUFFERIMMEDIATE_MODE Mode);
+
+private:
+    Buffer* m_pBuffer;
+    ID3D12GraphicsCommandList2* m_pCommandList;
+    D3D12_GPU_VIRTUAL_ADDRESS m_BufGpuAddr;
+    UINT m_MarkerCount;
+    MARKER_RANGE m_Range;
+
+    CommandListContext(const CommandListContext&) = delete;
+    CommandListContext& operator=(const CommandListContext&) = delete;
 };
 
 } // namespace D3D12AfterCrash
@@ -0,0 +1,147 @@
+/*
+D3d12AfterCrashBenchmark.cpp
+
+Author:  Adam Sawicki, http://asawicki.info, adam__REMOVE__@asawicki.info
+Version: 1.0.0, 2026-10-19
+License: MIT
+
+Measures CPU cost of recording markers with D3D12AfterCrash, per marker:
+
+- Buffer::WriteMarker(ID3D12GraphicsCommandList*) - QueryInterface and Release
+  for every marker.
+- Buffer::WriteMarker(ID3D12GraphicsCommandList2*) - virtual call.
+- CommandListContext::WriteMarker - only the WriteBufferImmediate call, which
+  is virtual like any COM method.
+- CommandListContext::WriteNextMarker - with slots taken from a marker range.
+- CommandListContext::WriteMarkerRange - all markers in batches of
+  BATCH_MARKER_COUNT.
+
+Every iteration resets the command list, records MARKERS_PER_LIST markers and
+closes it. Time of the same iteration without markers is measured first and
+subtracted. Command lists are never executed.
+
+Usage:
+    D3d12AfterCrashBenchmark [--csv | --json]
+
+Build, e.g.:
+    cl /O2 /EHsc D3d12AfterCrashBenchmark.cpp D3d12AfterCrash.cpp d3d12.lib
+*/
+#define MICRO_BENCHMARK_IMPLEMENTATION
+#include "../MicroBenchmark/MicroBenchmark.h"
+
+#include "D3d12AfterCrash.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static const UINT MARKERS_PER_LIST = 4096;
+static const UINT BATCH_MARKER_COUNT = 64;
+static const D3D12_WRITEBUFFERIMMEDIATE_MODE MODE = D3D12_WRITEBUFFERIMMEDIATE_MODE_MARKER_IN;
+
+#define CHECK_HR(expr) do { if(FAILED(expr)) { printf("%s failed.\n", #expr); return 1; } } while(false)
+
+int main(int argc, char** argv)
+{
+    const bool writeCsv = argc == 2 && strcmp(argv[1], "--csv") == 0;
+    const bool writeJson = argc == 2 && strcmp(argv[1], "--json") == 0;
+
+    ID3D12Device* device = nullptr;
+    CHECK_HR(D3D12CreateDevice(nullptr, D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&device)));
+    ID3D12CommandAllocator* commandAllocator = nullptr;
+    CHECK_HR(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&commandAllocator)));
+    ID3D12GraphicsCommandList* commandList = nullptr;
+    CHECK_HR(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocator, nullptr,
+        IID_PPV_ARGS(&commandList)));
+    CHECK_HR(commandList->Close());
+    ID3D12GraphicsCommandList2* commandList2 = nullptr;
+    CHECK_HR(commandList->QueryInterface(IID_PPV_ARGS(&commandList2)));
+
+    D3D12AfterCrash::DEVICE_DESC deviceDesc = { device };
+    D3D12AfterCrash::Device* afterCrashDevice = nullptr;
+    CHECK_HR(D3D12AfterCrash::CreateDevice(&deviceDesc, &afterCrashDevice));
+    D3D12AfterCrash::BUFFER_DESC bufferDesc = { MARKERS_PER_LIST };
+    D3D12AfterCrash::Buffer* buffer = nullptr;
+    UINT* bufferData = nullptr;
+    CHECK_HR(afterCrashDevice->CreateBuffer(&bufferDesc, &buffer, &bufferData));
+
+    {
+        D3D12AfterCrash::CommandListContext context;
+        CHECK_HR(context.Init(buffer, commandList));
+
+        std::vector<UINT> values(MARKERS_PER_LIST);
+        for(UINT i = 0; i < MARKERS_PER_LIST; ++i)
+            values[i] = i;
+
+        MicroBenchmark::CONFIG config;
+        config.WarmupSeconds = 0.1;
+        MicroBenchmark::Runner runner(config);
+
+        // Reset and Close are part of every iteration.
+        auto measure = [&](const char* name, auto recordMarkers) -> double
+        {
+            return runner.Run(name, [&]() {
+                commandAllocator->Reset();
+                commandList->Reset(commandAllocator, nullptr);
+                recordMarkers();
+                commandList->Close();
+            }).MeanNs;
+        };
+
+        const double emptyNs = measure("Empty", [&]() { });
+        const char* const names[] = {
+            "Buffer::WriteMarker(CommandList)",
+            "Buffer::WriteMarker(CommandList2)",
+            "Context::WriteMarker",
+            "Context::WriteNextMarker",
+            "Context::WriteMarkerRange",
+        };
+        double nsPerMarker[5];
+        nsPerMarker[0] = measure(names[0], [&]() {
+            for(UINT i = 0; i < MARKERS_PER_LIST; ++i)
+                buffer->WriteMarker(commandList, i, i, MODE);
+        });
+        nsPerMarker[1] = measure(names[1], [&]() {
+            for(UINT i = 0; i < MARKERS_PER_LIST; ++i)
+                buffer->WriteMarker(commandList2, i, i, MODE);
+        });
+        nsPerMarker[2] = measure(names[2], [&]() {
+            for(UINT i = 0; i < MARKERS_PER_LIST; ++i)
+                context.WriteMarker(i, i, MODE);
+        });
+        nsPerMarker[3] = measure(names[3], [&]() {
+            context.BeginMarkerRange(MARKERS_PER_LIST);
+            for(UINT i = 0; i < MARKERS_PER_LIST; ++i)
+                context.WriteNextMarker(i, MODE);
+        });
+        nsPerMarker[4] = measure(names[4], [&]() {
+            for(UINT i = 0; i < MARKERS_PER_LIST; i += BATCH_MARKER_COUNT)
+                context.WriteMarkerRange(i, BATCH_MARKER_COUNT, values.data() + i, MODE);
+        });
+
+        printf("Markers per command list: %u, batch size: %u\n", MARKERS_PER_LIST, BATCH_MARKER_COUNT);
+        printf("Reset and Close of empty command list: %.4g ns\n\n", emptyNs);
+        printf("%-36s %12s\n", "Method", "ns / marker");
+        for(size_t i = 0; i < 5; ++i)
+            printf("%-36s %12.4g\n", names[i], (nsPerMarker[i] - emptyNs) / (double)MARKERS_PER_LIST);
+
+        if(writeCsv)
+        {
+            printf("\n");
+            runner.WriteCsv(stdout);
+        }
+        if(writeJson)
+        {
+            printf("\n");
+            runner.WriteJson(stdout);
+        }
+    }
+
+    delete buffer;
+    delete afterCrashDevice;
+    commandList2->Release();
+    commandList->Release();
+    commandAllocator->Release();
+    device->Release();
+    return 0;
+}
@@ -0,0 +1,332 @@
+/*
+CommandListContextTest.cpp
+
+Author:  Adam Sawicki, http://asawicki.info, adam__REMOVE__@asawicki.info
+Version: 1.0.0, 2026-10-19
+License: MIT
+
+Test of D3D12AfterCrash::CommandListContext against mock D3D12 objects, using
+d3d12.h from this directory instead of the Windows SDK, so it runs on any
+platform. The mock command list records every WriteBufferImmediate parameter
+(address, value, mode) and counts calls to QueryInterface, AddRef and Release.
+Checks that:
+
+- Init queries ID3D12GraphicsCommandList2 once and writing markers doesn't
+  query it again.
+- Markers are written to correct addresses with correct values and modes.
+- Init fails with E_NOINTERFACE if the command list doesn't support
+  ID3D12GraphicsCommandList2.
+- Reference count of the command list is restored after Release.
+- Marker ranges allocated after the end of the buffer start from its
+  beginning, also when the buffer size is not a multiple of range size.
+- WriteNextMarker called without BeginMarkerRange stays inside the buffer.
+
+Returns 0 if all checks passed.
+
+Build and run from directory D3d12AfterCrash, e.g.:
+    g++ -std=c++14 -ITest Test/CommandListContextTest.cpp D3d12AfterCrash.cpp && ./a.out
+*/
+#include "../D3d12AfterCrash.h"
+
+#include <cstdio>
+#include <vector>
+
+static const D3D12_GPU_VIRTUAL_ADDRESS BUFFER_GPU_ADDRESS = 0x10000;
+
+static int g_FailedCount = 0;
+
+#define CHECK(expr) do { if(!(expr)) { printf("%s(%d): Check failed: %s\n", __FILE__, __LINE__, #expr); ++g_FailedCount; } } while(false)
+
+class MockResource : public ID3D12Resource
+{
+public:
+    std::vector<UINT> Data;
+
+    virtual HRESULT QueryInterface(REFIID, void**) { return E_NOINTERFACE; }
+    virtual ULONG AddRef() { return ++m_RefCount; }
+    virtual ULONG Release() { return --m_RefCount; }
+    virtual HRESULT Map(UINT, const D3D12_RANGE*, void** ppData) { *ppData = Data.data(); return S_OK; }
+    virtual void Unmap(UINT, const D3D12_RANGE*) { }
+    virtual D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress() { return BUFFER_GPU_ADDRESS; }
+
+private:
+    ULONG m_RefCount = 1;
+};
+
+class MockDevice : public ID3D12Device
+{
+public:
+    MockResource Resource;
+
+    virtual HRESULT QueryInterface(REFIID, void**) { return E_NOINTERFACE; }
+    virtual ULONG AddRef() { return ++m_RefCount; }
+    virtual ULONG Release() { return --m_RefCount; }
+    virtual HRESULT CreateCommittedResource(
+        const D3D12_HEAP_PROPERTIES*,
+        D3D12_HEAP_FLAGS,
+        const D3D12_RESOURCE_DESC* pDesc,
+        D3D12_RESOURCE_STATES,
+        const D3D12_CLEAR_VALUE*,
+        REFIID riidResource,
+        void** ppvResource)
+    {
+        if(!(riidResource == GetIID((ID3D12Resource**)nullptr)))
+            return E_NOINTERFACE;
+        Resource.Data.assign((size_t)(pDesc->Width / sizeof(UINT)), 0);
+        *ppvResource = &Resource;
+        return S_OK;
+    }
+
+private:
+    ULONG m_RefCount = 1;
+};
+
+class MockCommandList : public ID3D12GraphicsCommandList2
+{
+public:
+    struct WRITE
+    {
+        D3D12_GPU_VIRTUAL_ADDRESS Dest;
+        UINT Value;
+        D3D12_WRITEBUFFERIMMEDIATE_MODE Mode;
+    };
+
+    bool SupportsCommandList2 = true;
+    int QueryInterfaceCount = 0;
+    int WriteBufferImmediateCount = 0;
+    ULONG RefCount = 1;
+    std::vector<WRITE> Writes;
+
+    virtual HRESULT QueryInterface(REFIID riid, void** ppvObject)
+    {
+        ++QueryInterfaceCount;
+        if(riid == GetIID((ID3D12GraphicsCommandList2**)nullptr) && SupportsCommandList2)
+        {
+            *ppvObject = static_cast<ID3D12GraphicsCommandList2*>(this);
+            AddRef();
+            return S_OK;
+        }
+        *ppvObject = nullptr;
+        return E_NOINTERFACE;
+    }
+    virtual ULONG AddRef() { return ++RefCount; }
+    virtual ULONG Release() { return --RefCount; }
+    virtual void WriteBufferImmediate(
+        UINT Count,
+        const D3D12_WRITEBUFFERIMMEDIATE_PARAMETER* pParams,
+        const D3D12_WRITEBUFFERIMMEDIATE_MODE* pModes)
+    {
+        ++WriteBufferImmediateCount;
+        for(UINT i = 0; i < Count; ++i)
+        {
+            WRITE write = { pParams[i].Dest, pParams[i].Value, pModes ? pModes[i] : D3D12_WRITEBUFFERIMMEDIATE_MODE_DEFAULT };
+            Writes.push_back(write);
+        }
+    }
+};
+
+static D3D12_GPU_VIRTUAL_ADDRESS MarkerAddress(UINT markerIndex)
+{
+    return BUFFER_GPU_ADDRESS + markerIndex * sizeof(UINT);
+}
+
+static void TestWriteMarker(D3D12AfterCrash::Buffer* buffer)
+{
+    MockCommandList commandList;
+    {
+        D3D12AfterCrash::CommandListContext context;
+        CHECK(SUCCEEDED(context.Init(buffer, &commandList)));
+        CHECK(commandList.QueryInterfaceCount == 1);
+        CHECK(context.GetCommandList() == &commandList);
+
+        const D3D12_WRITEBUFFERIMMEDIATE_MODE modes[] = {
+            D3D12_WRITEBUFFERIMMEDIATE_MODE_DEFAULT,
+            D3D12_WRITEBUFFERIMMEDIATE_MODE_MARKER_IN,
+            D3D12_WRITEBUFFERIMMEDIATE_MODE_MARKER_OUT,
+        };
+        for(UINT i = 0; i < 100; ++i)
+            context.WriteMarker(i, 1000 + i, modes[i % 3]);
+
+        CHECK(commandList.QueryInterfaceCount == 1);
+        CHECK(commandList.WriteBufferImmediateCount == 100);
+        CHECK(commandList.Writes.size() == 100);
+        for(UINT i = 0; i < 100 && i < commandList.Writes.size(); ++i)
+        {
+            CHECK(commandList.Writes[i].Dest == MarkerAddress(i));
+            CHECK(commandList.Writes[i].Value == 1000 + i);
+            CHECK(commandList.Writes[i].Mode == modes[i % 3]);
+        }
+    }
+    // Context destroyed: reference taken by QueryInterface is released.
+    CHECK(commandList.RefCount == 1);
+}
+
+static void TestWriteNextMarker(D3D12AfterCrash::Buffer* buffer)
+{
+    MockCommandList commandList;
+    D3D12AfterCrash::CommandListContext context;
+    CHECK(SUCCEEDED(context.Init(buffer, &commandList)));
+
+    // Range of 16 used up twice, so 2 more ranges are allocated.
+    context.BeginMarkerRange(16);
+    std::vector<UINT> markerIndices;
+    for(UINT i = 0; i < 40; ++i)
+        markerIndices.push_back(context.WriteNextMarker(i, D3D12_WRITEBUFFERIMMEDIATE_MODE_MARKER_OUT));
+
+    CHECK(commandList.QueryInterfaceCount == 1);
+    CHECK(commandList.Writes.size() == 40);
+    for(UINT i = 0; i < 40 && i < commandList.Writes.size(); ++i)
+    {
+        CHECK(commandList.Writes[i].Dest == MarkerAddress(markerIndices[i]));
+        CHECK(commandList.Writes[i].Value == i);
+        // Consecutive slots within each range.
+        if(i % 16 != 0)
+            CHECK(markerIndices[i] == markerIndices[i - 1] + 1);
+    }
+
+    context.Release();
+    CHECK(commandList.RefCount == 1);
+}
+
+static void TestBatches(D3D12AfterCrash::Buffer* buffer)
+{
+    MockCommandList commandList;
+    D3D12AfterCrash::CommandListContext context;
+    CHECK(SUCCEEDED(context.Init(buffer, &commandList)));
+
+    std::vector<UINT> values(300);
+    for(UINT i = 0; i < 300; ++i)
+        values[i] = 7 * i;
+    context.WriteMarkerRange(500, 300, values.data(), D3D12_WRITEBUFFERIMMEDIATE_MODE_MARKER_IN);
+    // At most MAX_BATCH_MARKER_COUNT parameters per call.
+    CHECK(commandList.WriteBufferImmediateCount == 2);
+    CHECK(commandList.Writes.size() == 300);
+    for(UINT i = 0; i < 300 && i < commandList.Writes.size(); ++i)
+    {
+        CHECK(commandList.Writes[i].Dest == MarkerAddress(500 + i));
+        CHECK(commandList.Writes[i].Value == 7 * i);
+        CHECK(commandList.Writes[i].Mode == D3D12_WRITEBUFFERIMMEDIATE_MODE_MARKER_IN);
+    }
+
+    commandList.Writes.clear();
+    const D3D12AfterCrash::MARKER markers[] = {
+        { 3, 30, D3D12_WRITEBUFFERIMMEDIATE_MODE_DEFAULT },
+        { 9, 90, D3D12_WRITEBUFFERIMMEDIATE_MODE_MARKER_OUT },
+    };
+    context.WriteMarkers(2, markers);
+    CHECK(commandList.Writes.size() == 2);
+    for(size_t i = 0; i < 2 && i < commandList.Writes.size(); ++i)
+    {
+        CHECK(commandList.Writes[i].Dest == MarkerAddress(markers[i].MarkerIndex));
+        CHECK(commandList.Writes[i].Value == markers[i].Value);
+        CHECK(commandList.Writes[i].Mode == markers[i].Mode);
+    }
+
+    // Batched writes reuse the cached interface too.
+    CHECK(commandList.QueryInterfaceCount == 1);
+}
+
+static void TestNoCommandList2(D3D12AfterCrash::Buffer* buffer)
+{
+    MockCommandList commandList;
+    commandList.SupportsCommandList2 = false;
+    D3D12AfterCrash::CommandListContext context;
+    CHECK(context.Init(buffer, &commandList) == E_NOINTERFACE);
+    CHECK(context.GetCommandList() == nullptr);
+    CHECK(commandList.RefCount == 1);
+}
+
+static void TestAllocateMarkersWrap(D3D12AfterCrash::Device* afterCrashDevice)
+{
+    D3D12AfterCrash::BUFFER_DESC bufferDesc = { 10 };
+    D3D12AfterCrash::Buffer* buffer = nullptr;
+    UINT* bufferData = nullptr;
+    CHECK(SUCCEEDED(afterCrashDevice->CreateBuffer(&bufferDesc, &buffer, &bufferData)));
+    if(buffer == nullptr)
+        return;
+
+    // 2 markers at the end are left unused.
+    const UINT expected[] = { 0, 4, 0, 4, 0 };
+    for(UINT i = 0; i < 5; ++i)
+        CHECK(buffer->AllocateMarkers(4) == expected[i]);
+    CHECK(buffer->AllocateMarkers(2) == 4);
+    // Ends exactly at the end of the buffer.
+    CHECK(buffer->AllocateMarkers(4) == 6);
+    CHECK(buffer->AllocateMarkers(1) == 0);
+    // Whole buffer.
+    CHECK(buffer->AllocateMarkers(10) == 0);
+    CHECK(buffer->AllocateMarkers(3) == 0);
+
+    delete buffer;
+}
+
+static void TestWriteNextMarkerWithoutRange(D3D12AfterCrash::Device* afterCrashDevice)
+{
+    D3D12AfterCrash::BUFFER_DESC bufferDesc = { 10 };
+    D3D12AfterCrash::Buffer* buffer = nullptr;
+    UINT* bufferData = nullptr;
+    CHECK(SUCCEEDED(afterCrashDevice->CreateBuffer(&bufferDesc, &buffer, &bufferData)));
+    if(buffer == nullptr)
+        return;
+
+    MockCommandList commandList;
+    D3D12AfterCrash::CommandListContext context;
+    CHECK(SUCCEEDED(context.Init(buffer, &commandList)));
+    // More markers than the buffer has, so allocation wraps around.
+    for(UINT i = 0; i < 25; ++i)
+        CHECK(context.WriteNextMarker(i, D3D12_WRITEBUFFERIMMEDIATE_MODE_DEFAULT) == i % 10);
+    CHECK(commandList.Writes.size() == 25);
+    for(size_t i = 0; i < commandList.Writes.size(); ++i)
+        CHECK(commandList.Writes[i].Dest == MarkerAddress((UINT)i % 10));
+
+    // Init again with a range left from a larger buffer: the range is dropped.
+    D3D12AfterCrash::BUFFER_DESC largeBufferDesc = { 1000 };
+    D3D12AfterCrash::Buffer* largeBuffer = nullptr;
+    CHECK(SUCCEEDED(afterCrashDevice->CreateBuffer(&largeBufferDesc, &largeBuffer, &bufferData)));
+    if(largeBuffer != nullptr)
+    {
+        CHECK(SUCCEEDED(context.Init(largeBuffer, &commandList)));
+        context.BeginMarkerRange(500);
+        context.WriteNextMarker(0, D3D12_WRITEBUFFERIMMEDIATE_MODE_DEFAULT);
+        CHECK(SUCCEEDED(context.Init(buffer, &commandList)));
+        CHECK(context.WriteNextMarker(0, D3D12_WRITEBUFFERIMMEDIATE_MODE_DEFAULT) < 10);
+        context.Release();
+        delete largeBuffer;
+    }
+
+    context.Release();
+    CHECK(commandList.RefCount == 1);
+    delete buffer;
+}
+
+int main()
+{
+    MockDevice device;
+    D3D12AfterCrash::DEVICE_DESC deviceDesc = { &device };
+    D3D12AfterCrash::Device* afterCrashDevice = nullptr;
+    CHECK(SUCCEEDED(D3D12AfterCrash::CreateDevice(&deviceDesc, &afterCrashDevice)));
+    D3D12AfterCrash::BUFFER_DESC bufferDesc = { 1024 };
+    D3D12AfterCrash::Buffer* buffer = nullptr;
+    UINT* bufferData = nullptr;
+    CHECK(SUCCEEDED(afterCrashDevice->CreateBuffer(&bufferDesc, &buffer, &bufferData)));
+    if(g_FailedCount > 0)
+        return 1;
+
+    TestWriteMarker(buffer);
+    TestWriteNextMarker(buffer);
+    TestBatches(buffer);
+    TestNoCommandList2(buffer);
+    TestAllocateMarkersWrap(afterCrashDevice);
+    TestWriteNextMarkerWithoutRange(afterCrashDevice);
+
+    delete buffer;
+    delete afterCrashDevice;
+
+    if(g_FailedCount > 0)
+    {
+        printf("%d check(s) failed.\n", g_FailedCount);
+        return 1;
+    }
+    printf("All checks passed.\n");
+    return 0;
+}
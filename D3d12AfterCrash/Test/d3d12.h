@@ -0,0 +1,146 @@
+/*
+Minimal replacement of <d3d12.h> with only the declarations used by
+D3d12AfterCrash.cpp, so that D3D12AfterCrash can be compiled and tested on any
+platform against mock objects. Interfaces are plain abstract classes and IIDs
+are small numbers. Not usable with real Direct3D 12.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+typedef int32_t HRESULT; // 32-bit like on Windows, where long is 32-bit.
+typedef unsigned int UINT;
+typedef uint32_t ULONG;
+typedef uint16_t UINT16;
+typedef uint64_t UINT64;
+typedef size_t SIZE_T;
+typedef UINT64 D3D12_GPU_VIRTUAL_ADDRESS;
+
+#define S_OK ((HRESULT)0)
+#define E_FAIL ((HRESULT)0x80004005L)
+#define E_NOINTERFACE ((HRESULT)0x80004002L)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+
+struct IID
+{
+    UINT Value;
+};
+inline bool operator==(const IID& lhs, const IID& rhs) { return lhs.Value == rhs.Value; }
+typedef const IID& REFIID;
+
+enum D3D12_HEAP_TYPE
+{
+    D3D12_HEAP_TYPE_DEFAULT = 1,
+    D3D12_HEAP_TYPE_UPLOAD = 2,
+    D3D12_HEAP_TYPE_READBACK = 3,
+    D3D12_HEAP_TYPE_CUSTOM = 4,
+};
+enum D3D12_HEAP_FLAGS { D3D12_HEAP_FLAG_NONE = 0 };
+enum D3D12_RESOURCE_DIMENSION
+{
+    D3D12_RESOURCE_DIMENSION_UNKNOWN = 0,
+    D3D12_RESOURCE_DIMENSION_BUFFER = 1,
+};
+enum D3D12_TEXTURE_LAYOUT
+{
+    D3D12_TEXTURE_LAYOUT_UNKNOWN = 0,
+    D3D12_TEXTURE_LAYOUT_ROW_MAJOR = 1,
+};
+enum D3D12_RESOURCE_FLAGS
+{
+    D3D12_RESOURCE_FLAG_NONE = 0,
+    D3D12_RESOURCE_FLAG_DENY_SHADER_RESOURCE = 0x8,
+};
+enum D3D12_RESOURCE_STATES { D3D12_RESOURCE_STATE_COPY_DEST = 0x400 };
+enum D3D12_WRITEBUFFERIMMEDIATE_MODE
+{
+    D3D12_WRITEBUFFERIMMEDIATE_MODE_DEFAULT = 0,
+    D3D12_WRITEBUFFERIMMEDIATE_MODE_MARKER_IN = 1,
+    D3D12_WRITEBUFFERIMMEDIATE_MODE_MARKER_OUT = 2,
+};
+
+struct D3D12_HEAP_PROPERTIES
+{
+    D3D12_HEAP_TYPE Type;
+    int CPUPageProperty;
+    int MemoryPoolPreference;
+    UINT CreationNodeMask;
+    UINT VisibleNodeMask;
+};
+struct DXGI_SAMPLE_DESC
+{
+    UINT Count;
+    UINT Quality;
+};
+struct D3D12_RESOURCE_DESC
+{
+    D3D12_RESOURCE_DIMENSION Dimension;
+    UINT64 Alignment;
+    UINT64 Width;
+    UINT Height;
+    UINT16 DepthOrArraySize;
+    UINT16 MipLevels;
+    int Format;
+    DXGI_SAMPLE_DESC SampleDesc;
+    D3D12_TEXTURE_LAYOUT Layout;
+    D3D12_RESOURCE_FLAGS Flags;
+};
+struct D3D12_RANGE
+{
+    SIZE_T Begin;
+    SIZE_T End;
+};
+struct D3D12_WRITEBUFFERIMMEDIATE_PARAMETER
+{
+    D3D12_GPU_VIRTUAL_ADDRESS Dest;
+    UINT Value;
+};
+struct D3D12_CLEAR_VALUE;
+
+struct IUnknown
+{
+    virtual HRESULT QueryInterface(REFIID riid, void** ppvObject) = 0;
+    virtual ULONG AddRef() = 0;
+    virtual ULONG Release() = 0;
+};
+
+struct ID3D12Resource : public IUnknown
+{
+    virtual HRESULT Map(UINT Subresource, const D3D12_RANGE* pReadRange, void** ppData) = 0;
+    virtual void Unmap(UINT Subresource, const D3D12_RANGE* pWrittenRange) = 0;
+    virtual D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress() = 0;
+};
+
+struct ID3D12GraphicsCommandList : public IUnknown
+{
+};
+
+struct ID3D12GraphicsCommandList2 : public ID3D12GraphicsCommandList
+{
+    virtual void WriteBufferImmediate(
+        UINT Count,
+        const D3D12_WRITEBUFFERIMMEDIATE_PARAMETER* pParams,
+        const D3D12_WRITEBUFFERIMMEDIATE_MODE* pModes) = 0;
+};
+
+struct ID3D12Device : public IUnknown
+{
+    virtual HRESULT CreateCommittedResource(
+        const D3D12_HEAP_PROPERTIES* pHeapProperties,
+        D3D12_HEAP_FLAGS HeapFlags,
+        const D3D12_RESOURCE_DESC* pDesc,
+        D3D12_RESOURCE_STATES InitialResourceState,
+        const D3D12_CLEAR_VALUE* pOptimizedClearValue,
+        REFIID riidResource,
+        void** ppvResource) = 0;
+};
+
+// Replacement of __uuidof.
+inline REFIID GetIID(ID3D12Resource**) { static const IID iid = { 1 }; return iid; }
+inline REFIID GetIID(ID3D12GraphicsCommandList**) { static const IID iid = { 2 }; return iid; }
+inline REFIID GetIID(ID3D12GraphicsCommandList2**) { static const IID iid = { 3 }; return iid; }
+inline REFIID GetIID(ID3D12Device**) { static const IID iid = { 4 }; return iid; }
+
+#define IID_PPV_ARGS(ppType) GetIID(ppType), reinterpret_cast<void**>(ppType)
@@ -0,0 +1,205 @@
+/*
+DecimalInt.hpp
+
+Author  : Adam Sawicki, http://asawicki.info, adam__REMOVE__@asawicki.info
+Version : 1.0, 2026-10-19
+License : Public Domain
+
+Fast functions for decimal representation of integer numbers:
+
+- CountDigits - number of decimal digits of a 32 or 64-bit unsigned integer,
+  without branches or loops. Bit length of the number, calculated with
+  count-leading-zeros instruction, gives an estimate of the digit count
+  (bitLength * log10(2)) that is either exact or 1 too low. A single comparison
+  with a power of 10 from a table corrects it.
+- IsPowerOf10 - built on the above: x is a power of 10 if it is equal to the
+  smallest number with the same number of digits.
+- ToDecimal - conversion of uint32_t, uint64_t, int32_t, int64_t to decimal
+  text, writing two digits at a time from a 200-byte lookup table. Writes
+  directly to a buffer provided by the caller. Doesn't write terminating null.
+
+IsLog10_v1 from IsLog10.c shows that integer to text conversion and decimal
+magnitude are closely related. This is the fast version of both.
+*/
+#pragma once
+
+#include "IsPowerOf.hpp"
+
+#include <cstdint>
+
+// Maximum number of characters written by ToDecimal.
+static const uint32_t DECIMAL_MAX_LENGTH_U32 = 10; // "4294967295"
+static const uint32_t DECIMAL_MAX_LENGTH_I32 = 11; // "-2147483648"
+static const uint32_t DECIMAL_MAX_LENGTH_U64 = 20; // "18446744073709551615"
+static const uint32_t DECIMAL_MAX_LENGTH_I64 = 20; // "-9223372036854775808"
+
+namespace DecimalIntDetail
+{
+
+static const uint64_t POWERS_OF_10[20] = {
+    1ull,
+    10ull,
+    100ull,
+    1000ull,
+    10000ull,
+    100000ull,
+    1000000ull,
+    10000000ull,
+    100000000ull,
+    1000000000ull,
+    10000000000ull,
+    100000000000ull,
+    1000000000000ull,
+    10000000000000ull,
+    100000000000000ull,
+    1000000000000000ull,
+    10000000000000000ull,
+    100000000000000000ull,
+    1000000000000000000ull,
+    10000000000000000000ull,
+};
+
+static const char DIGIT_PAIRS[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// Writes digits of value ending just before end. Caller knows how many there are.
+template<typename U>
+inline void WriteDigitsBackward(char* end, U value)
+{
+    while(value >= 100)
+    {
+        const uint32_t pair = (uint32_t)(value % 100) * 2;
+        value /= 100;
+        end -= 2;
+        end[0] = DIGIT_PAIRS[pair];
+        end[1] = DIGIT_PAIRS[pair + 1];
+    }
+    if(value >= 10)
+    {
+        const uint32_t pair = (uint32_t)value * 2;
+        end[-2] = DIGIT_PAIRS[pair];
+        end[-1] = DIGIT_PAIRS[pair + 1];
+    }
+    else
+        end[-1] = (char)('0' + value);
+}
+
+} // namespace DecimalIntDetail
+
+/*
+Returns number of decimal digits needed to represent x, from 1 to 10.
+CountDigits(0) == 1.
+*/
+inline uint32_t CountDigits(uint32_t x)
+{
+    // Setting bit 0 doesn't change number of digits, except 0 becomes 1, which
+    // has the right digit count and a nonzero bit length.
+    x |= 1;
+    // 1233 / 4096 is slightly above log10(2).
+    const uint32_t estimate = (IsPowerOfDetail::BitLength32(x) * 1233) >> 12;
+    return estimate + (x >= DecimalIntDetail::POWERS_OF_10[estimate] ? 1 : 0);
+}
+
+/*
+Returns number of decimal digits needed to represent x, from 1 to 20.
+CountDigits(0) == 1.
+*/
+inline uint32_t CountDigits(uint64_t x)
+{
+    x |= 1;
+    const uint32_t estimate = (IsPowerOfDetail::BitLength64(x) * 1233) >> 12;
+    return estimate + (x >= DecimalIntDetail::POWERS_OF_10[estimate] ? 1 : 0);
+}
+
+// Returns true if x is 1, 10, 100, ...
+inline bool IsPowerOf10(uint32_t x)
+{
+    return x == DecimalIntDetail::POWERS_OF_10[CountDigits(x) - 1];
+}
+
+inline bool IsPowerOf10(uint64_t x)
+{
+    return x == DecimalIntDetail::POWERS_OF_10[CountDigits(x) - 1];
+}
+
+// Returns true if x is 1, 10, 100, ... Negative numbers are not powers of 10.
+inline bool IsPowerOf10(int32_t x)
+{
+    // Every negative number cast to uint32_t is above the largest power of 10
+    // that fits in it, so it fails the comparison anyway.
+    return IsPowerOf10((uint32_t)x);
+}
+
+inline bool IsPowerOf10(int64_t x)
+{
+    // Unlike in 32 bits, 10^19 fits in uint64_t, so negative numbers need to
+    // be excluded explicitly.
+    return (x > 0) & IsPowerOf10((uint64_t)x);
+}
+
+/*
+Writes decimal representation of value to dst, without terminating null.
+Returns number of characters written. dst must have space for at least
+DECIMAL_MAX_LENGTH_U32 characters.
+*/
+inline uint32_t ToDecimal(uint32_t value, char* dst)
+{
+    const uint32_t length = CountDigits(value);
+    DecimalIntDetail::WriteDigitsBackward(dst + length, value);
+    return length;
+}
+
+// dst must have space for at least DECIMAL_MAX_LENGTH_U64 characters.
+inline uint32_t ToDecimal(uint64_t value, char* dst)
+{
+    // 64-bit division is slower, so switch to 32 bits as soon as possible.
+    if(value <= UINT32_MAX)
+        return ToDecimal((uint32_t)value, dst);
+    const uint32_t length = CountDigits(value);
+    char* const end = dst + length;
+    // Take 8 lowest digits at a time until the rest fits in 32 bits.
+    char* p = end;
+    while(value > UINT32_MAX)
+    {
+        uint32_t low = (uint32_t)(value % 100000000);
+        value /= 100000000;
+        for(uint32_t i = 0; i < 4; ++i)
+        {
+            const uint32_t pair = (low % 100) * 2;
+            low /= 100;
+            p -= 2;
+            p[0] = DecimalIntDetail::DIGIT_PAIRS[pair];
+            p[1] = DecimalIntDetail::DIGIT_PAIRS[pair + 1];
+        }
+    }
+    DecimalIntDetail::WriteDigitsBackward(p, (uint32_t)value);
+    return length;
+}
+
+// dst must have space for at least DECIMAL_MAX_LENGTH_I32 characters.
+inline uint32_t ToDecimal(int32_t value, char* dst)
+{
+    // Negation done in unsigned arithmetic works also for INT32_MIN.
+    const uint32_t isNegative = value < 0 ? 1 : 0;
+    *dst = '-';
+    const uint32_t magnitude = isNegative ? 0u - (uint32_t)value : (uint32_t)value;
+    return isNegative + ToDecimal(magnitude, dst + isNegative);
+}
+
+// dst must have space for at least DECIMAL_MAX_LENGTH_I64 characters.
+inline uint32_t ToDecimal(int64_t value, char* dst)
+{
+    const uint32_t isNegative = value < 0 ? 1 : 0;
+    *dst = '-';
+    const uint64_t magnitude = isNegative ? 0ull - (uint64_t)value : (uint64_t)value;
+    return isNegative + ToDecimal(magnitude, dst + isNegative);
+}
@@ -0,0 +1,1640 @@
+/*
+FP8.h
+
+Author:  Adam Sawicki, https://asawicki.info, adam__REMOVE__@asawicki.info
+Version: 1.4.0, 2026-10-19
+License: Public Domain
+
+This is a simple, single-header, C++14 library for converting 8-bit
+floating-point (FP8) numbers used in machine learning to and from float32. It
+supports the same four formats as fp8_tables.py, with exactly the same rules for
+zero, infinity and NaN as function write_cell in that script:
+
+- FLOAT8E4M3FN   - 4 exponent bits, bias 7. No infinity. NaN is S.1111.111.
+                   Has +0 and -0.
+- FLOAT8E4M3FNUZ - 4 exponent bits, bias 8. No infinity. NaN is 1.0000.000.
+                   Has only one zero.
+- FLOAT8E5M2     - 5 exponent bits, bias 15. Infinity is S.11111.00, NaN is
+                   S.11111.MM with nonzero MM. Has +0 and -0.
+- FLOAT8E5M2FNUZ - 5 exponent bits, bias 16. No infinity. NaN is 1.00000.00.
+                   Has only one zero.
+
+NaN is decoded to quiet float32 NaN with the same sign bit as the FP8 value.
+
+All formats are instances of template Float<ExpBits, ManBits, Bias, Flags>,
+which calculates at compile time everything that depends on the format:
+special codes, limits like Max, MinNormal, MinSubnormal, MaxExactInteger, and
+decoding tables. It also provides scalar Decode and Encode. Besides the four
+formats above, it is instantiated as 6-bit Float6E3M2, Float6E2M3 and 4-bit
+Float4E2M1 from OCP Microscaling (MX) specification, which have no infinity or
+NaN. Array functions, which take FP8 type as a parameter, have kernels compiled
+separately for each format, with no checks of the format inside loops.
+
+Decoding uses tables of all 256 values of each format, generated at compile
+time. Bulk decoding of arrays uses AVX-512 (table lookup using vpermt2d
+shuffles) or AVX2 (table lookup using vpgatherdd), selected at runtime based on
+CPUID, with a scalar fallback.
+
+Encoding float32 to FP8 rounds to nearest, ties to even. Values too small for
+the smallest subnormal become zero of the same sign, except in UZ types, which
+have only positive zero. Float32 NaN becomes NaN: S.1111.111 in FLOAT8E4M3FN,
+S.11111.10 in FLOAT8E5M2, 1.0000000 in UZ types. Values with magnitude that
+rounds above the largest finite value, as well as infinities, become:
+
+- OVERFLOW_MODE_SATURATE - largest finite value of the same sign.
+- OVERFLOW_MODE_INF_OR_NAN - infinity of the same sign in FLOAT8E5M2, NaN in
+  other types.
+
+Bulk encoding of arrays uses AVX-512 or AVX2 with the same integer algorithm
+as scalar function Encode, so results are bit-exact with it for all 2^32
+float32 inputs.
+
+Stochastic rounding, used in training, rounds to one of the two nearest FP8
+values, with probability proportional to how close the input is to each of
+them, so the rounding error is zero on average. Random bits come from a
+counter-based generator: bits for element i are a hash of the seed and index i,
+with no state carried between elements. Results depend only on the seed and
+the index of each element, so they are the same regardless of how the array is
+split among threads or which instruction set is used.
+
+Block-scaled formats of OCP Microscaling (MX) specification - MXFP8, MXFP6,
+MXFP4 - store blocks of 32 elements in one of the small formats, sharing one
+scale: a power of 2 in E8M0 format. Quantization finds the largest magnitude
+in a block, chooses the scale so it lands near the top of the element format,
+then divides elements by the scale and encodes them. Each step has AVX-512 and
+AVX2 kernels, including packing of 6- and 4-bit elements.
+
+How to use it:
+
+1. In any CPP file where you want to use the library:
+   #include "FP8.h"
+2. In exactly one CPP file, define following macro before that include:
+   #define FP8_IMPLEMENTATION
+3. Call FP8::Decode, FP8::Encode for single values or FP8::DecodeArray,
+   FP8::EncodeArray for arrays. For stochastic rounding, call
+   FP8::EncodeArrayStochastic or FP8::EncodeArrayStochasticParallel.
+   For MX formats, call FP8::MxQuantize, FP8::MxDequantize or their Parallel
+   versions.
+*/
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace FP8
+{
+
+// Values match class FP8Type in fp8_tables.py.
+enum TYPE
+{
+    TYPE_FLOAT8E4M3FN = 1,
+    TYPE_FLOAT8E4M3FNUZ = 2,
+    TYPE_FLOAT8E5M2 = 3,
+    TYPE_FLOAT8E5M2FNUZ = 4,
+};
+
+// Returns name of the type like in fp8_tables.py, e.g. "FLOAT8E4M3FN".
+const char* GetTypeName(TYPE type);
+
+// What to do with values too large to be represented.
+enum OVERFLOW_MODE
+{
+    OVERFLOW_MODE_SATURATE,
+    OVERFLOW_MODE_INF_OR_NAN,
+};
+
+// Instruction sets used by functions processing arrays.
+enum ISA
+{
+    ISA_SCALAR,
+    ISA_AVX2,
+    ISA_AVX512,
+    ISA_COUNT
+};
+
+/*
+Returns the best instruction set supported by current CPU and operating system,
+which is used by functions processing arrays.
+*/
+ISA GetIsa();
+// Returns name of the instruction set, like "AVX2".
+const char* GetIsaName(ISA isa);
+
+namespace Detail
+{
+
+static const uint32_t FLOAT_BITS_SIGN = 0x80000000u;
+static const uint32_t FLOAT_BITS_INF = 0x7F800000u;
+static const uint32_t FLOAT_BITS_NAN = 0x7FC00000u;
+
+// Returns 2^exponent. Usable at compile time.
+constexpr float Pow2(int32_t exponent)
+{
+    float result = 1.f;
+    for(; exponent > 0; --exponent)
+        result *= 2.f;
+    for(; exponent < 0; ++exponent)
+        result *= 0.5f;
+    return result;
+}
+
+} // namespace Detail
+
+////////////////////////////////////////////////////////////////////////////////
+// Generic small floating-point format
+
+/*
+Rules for special values of a format, to be used as parameter Flags of template
+Float. At most one of them can be set. With none of them, all codes are finite
+numbers, like in FP6 and FP4 formats of OCP Microscaling (MX) specification.
+*/
+enum FLOAT_FLAGS
+{
+    // Largest exponent means infinity (zero mantissa) or NaN (other mantissas),
+    // like in IEEE 754.
+    FLOAT_FLAG_IEEE_INF_NAN = 0x1,
+    // Only the code with all exponent and mantissa bits set is NaN. No
+    // infinity.
+    FLOAT_FLAG_NAN_ALL_ONES = 0x2,
+    // Code of negative zero is NaN. No infinity and only one zero.
+    FLOAT_FLAG_NAN_NEGATIVE_ZERO = 0x4,
+};
+
+namespace Detail
+{
+template<typename F> struct DecodeTableInstance;
+template<typename F, bool Stochastic> uint8_t EncodeImpl(float value, OVERFLOW_MODE overflowMode, uint32_t randomBits);
+} // namespace Detail
+
+/*
+Floating-point format with 1 sign bit, ExpBits exponent bits, ManBits mantissa
+bits, exponent bias Bias and special values defined by Flags, with everything
+that depends on them calculated at compile time. All formats have subnormals.
+Codes are stored in lowest bits of uint8_t, with sign in the highest of them.
+*/
+template<uint32_t ExpBits, uint32_t ManBits, int32_t Bias, uint32_t Flags>
+struct Float
+{
+    static_assert(ExpBits >= 2 && ManBits >= 1 && 1 + ExpBits + ManBits <= 8, "Unsupported number of bits.");
+    static_assert((Flags & (Flags - 1)) == 0, "At most one of FLOAT_FLAGS can be set.");
+
+    static constexpr uint32_t ExponentBitCount = ExpBits;
+    static constexpr uint32_t MantissaBitCount = ManBits;
+    static constexpr int32_t ExponentBias = Bias;
+    static constexpr uint32_t BitCount = 1 + ExpBits + ManBits;
+    static constexpr uint32_t CodeCount = 1u << BitCount;
+    static constexpr uint32_t SignBit = 1u << (ExpBits + ManBits);
+    static constexpr uint32_t MantissaMask = (1u << ManBits) - 1;
+    static constexpr uint32_t ExponentMax = (1u << ExpBits) - 1;
+
+    static constexpr bool HasInf = (Flags & FLOAT_FLAG_IEEE_INF_NAN) != 0;
+    static constexpr bool HasNan = Flags != 0;
+    static constexpr bool HasNegativeZero = (Flags & FLOAT_FLAG_NAN_NEGATIVE_ZERO) == 0;
+
+    // Codes below are without sign.
+    // Code of the largest finite value.
+    static constexpr uint32_t MaxCode =
+        HasInf ? (ExponentMax << ManBits) - 1 :
+        (Flags & FLOAT_FLAG_NAN_ALL_ONES) ? SignBit - 2 :
+        SignBit - 1;
+    // Code of NaN produced by encoding, or MaxCode if there is no NaN.
+    static constexpr uint32_t NanCode =
+        HasInf ? (ExponentMax << ManBits) | (1u << (ManBits - 1)) :
+        (Flags & FLOAT_FLAG_NAN_ALL_ONES) ? SignBit - 1 :
+        (Flags & FLOAT_FLAG_NAN_NEGATIVE_ZERO) ? SignBit :
+        MaxCode;
+    // Code produced on overflow in OVERFLOW_MODE_INF_OR_NAN.
+    static constexpr uint32_t OverflowCode = HasInf ? ExponentMax << ManBits : NanCode;
+
+    // Exponent of the largest finite value, without bias - emax in MX specification.
+    static constexpr int32_t MaxExponent = (int32_t)(MaxCode >> ManBits) - Bias;
+
+    // Largest finite value.
+    static constexpr float Max()
+    {
+        return (1.f + (float)(MaxCode & MantissaMask) / (float)(1u << ManBits)) *
+            Detail::Pow2((int32_t)(MaxCode >> ManBits) - Bias);
+    }
+    // Smallest positive normal value.
+    static constexpr float MinNormal() { return Detail::Pow2(1 - Bias); }
+    // Smallest positive subnormal value.
+    static constexpr float MinSubnormal() { return Detail::Pow2(1 - Bias - (int32_t)ManBits); }
+    // Largest integer n such that all integers 0..n can be represented exactly.
+    static constexpr uint32_t MaxExactInteger()
+    {
+        return (float)(2u << ManBits) <= Max() ? 2u << ManBits : (uint32_t)Max();
+    }
+
+    // Returns bits of float32 equal to given code. Follows function write_cell
+    // from fp8_tables.py. NaN becomes quiet NaN with the same sign.
+    static constexpr uint32_t DecodeToFloatBits(uint32_t code)
+    {
+        const uint32_t sign = (code & SignBit) ? Detail::FLOAT_BITS_SIGN : 0;
+        const uint32_t exponent = (code >> ManBits) & ExponentMax;
+        const uint32_t mantissa = code & MantissaMask;
+
+        if(exponent == 0 && mantissa == 0)
+            return (sign && !HasNegativeZero) ? (sign | Detail::FLOAT_BITS_NAN) : sign;
+        if(HasInf && exponent == ExponentMax)
+            return sign | (mantissa == 0 ? Detail::FLOAT_BITS_INF : Detail::FLOAT_BITS_NAN);
+        if((Flags & FLOAT_FLAG_NAN_ALL_ONES) && exponent == ExponentMax && mantissa == MantissaMask)
+            return sign | Detail::FLOAT_BITS_NAN;
+
+        if(exponent != 0)
+        {
+            // Normal: 2^(exponent - bias) * 1.mantissa
+            const uint32_t floatExponent = (uint32_t)((int32_t)exponent - Bias + 127);
+            return sign | (floatExponent << 23) | (mantissa << (23 - ManBits));
+        }
+
+        // Subnormal: 2^(1 - bias) * 0.mantissa, which is normal in float32.
+        uint32_t highestBit = 0;
+        while((mantissa >> (highestBit + 1)) != 0)
+            ++highestBit;
+        const uint32_t floatExponent = (uint32_t)(1 - Bias - (int32_t)ManBits + (int32_t)highestBit + 127);
+        return sign | (floatExponent << 23) | ((mantissa - (1u << highestBit)) << (23 - highestBit));
+    }
+
+    // Returns table of CodeCount float32 values, as bits, indexed by code.
+    static const uint32_t* GetDecodeTable() { return Detail::DecodeTableInstance<Float>::Table.Bits; }
+
+    static float Decode(uint32_t code)
+    {
+        float result;
+        memcpy(&result, &GetDecodeTable()[code], sizeof(float));
+        return result;
+    }
+
+    // See function FP8::Encode.
+    static uint8_t Encode(float value, OVERFLOW_MODE overflowMode = OVERFLOW_MODE_SATURATE)
+    {
+        return Detail::EncodeImpl<Float, false>(value, overflowMode, 0);
+    }
+
+    // See function FP8::EncodeStochastic.
+    static uint8_t EncodeStochastic(float value, uint32_t randomBits, OVERFLOW_MODE overflowMode = OVERFLOW_MODE_SATURATE)
+    {
+        return Detail::EncodeImpl<Float, true>(value, overflowMode, randomBits);
+    }
+};
+
+// Formats of fp8_tables.py.
+typedef Float<4, 3, 7, FLOAT_FLAG_NAN_ALL_ONES> Float8E4M3FN;
+typedef Float<4, 3, 8, FLOAT_FLAG_NAN_NEGATIVE_ZERO> Float8E4M3FNUZ;
+typedef Float<5, 2, 15, FLOAT_FLAG_IEEE_INF_NAN> Float8E5M2;
+typedef Float<5, 2, 16, FLOAT_FLAG_NAN_NEGATIVE_ZERO> Float8E5M2FNUZ;
+// Formats of OCP Microscaling (MX) specification.
+typedef Float<3, 2, 3, 0> Float6E3M2;
+typedef Float<2, 3, 1, 0> Float6E2M3;
+typedef Float<2, 1, 1, 0> Float4E2M1;
+
+static_assert(Float8E4M3FN::Max() == 448.f && Float8E4M3FN::MaxExactInteger() == 16, "");
+static_assert(Float8E4M3FNUZ::Max() == 240.f && Float8E4M3FNUZ::MinSubnormal() == 1.f / 1024.f, "");
+static_assert(Float8E5M2::Max() == 57344.f && Float8E5M2::MinNormal() == 1.f / 16384.f, "");
+static_assert(Float8E5M2FNUZ::Max() == 57344.f && Float8E5M2FNUZ::MaxExactInteger() == 8, "");
+static_assert(Float6E3M2::Max() == 28.f && Float6E3M2::MinSubnormal() == 0.0625f, "");
+static_assert(Float6E2M3::Max() == 7.5f && Float6E2M3::MaxExactInteger() == 7, "");
+static_assert(Float4E2M1::Max() == 6.f && Float4E2M1::MinSubnormal() == 0.5f, "");
+static_assert(Float8E4M3FN::MaxExponent == 8 && Float8E5M2::MaxExponent == 15 && Float6E3M2::MaxExponent == 4 &&
+    Float6E2M3::MaxExponent == 2 && Float4E2M1::MaxExponent == 2, "");
+
+namespace Detail
+{
+
+template<typename F>
+struct DecodeTable
+{
+    uint32_t Bits[F::CodeCount];
+
+    constexpr DecodeTable() : Bits()
+    {
+        for(uint32_t i = 0; i < F::CodeCount; ++i)
+            Bits[i] = F::DecodeToFloatBits(i);
+    }
+};
+
+template<typename F>
+struct DecodeTableInstance
+{
+    static constexpr DecodeTable<F> Table = DecodeTable<F>();
+};
+
+template<typename F>
+constexpr DecodeTable<F> DecodeTableInstance<F>::Table;
+
+// Calls func with a default-constructed object of the Float type used for given
+// type, so code written once as a generic lambda is compiled separately for
+// each of them.
+template<typename Func>
+inline void VisitType(TYPE type, const Func& func)
+{
+    switch(type)
+    {
+    case TYPE_FLOAT8E4M3FN:   func(Float8E4M3FN()); break;
+    case TYPE_FLOAT8E4M3FNUZ: func(Float8E4M3FNUZ()); break;
+    case TYPE_FLOAT8E5M2:     func(Float8E5M2()); break;
+    case TYPE_FLOAT8E5M2FNUZ: func(Float8E5M2FNUZ()); break;
+    default:                  break;
+    }
+}
+
+// Finalizer of MurmurHash3. Every bit of the result depends on every bit of x.
+inline uint32_t Hash32(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35u;
+    x ^= x >> 16;
+    return x;
+}
+
+static const uint32_t RANDOM_INDEX_MULTIPLIER = 0x9E3779B9u;
+
+// Part of the random generator constant for 2^32 consecutive indices.
+inline uint32_t GetRandomKey(uint64_t seed, uint32_t indexHigh)
+{
+    return Hash32(Hash32((uint32_t)(seed >> 32) + indexHigh * RANDOM_INDEX_MULTIPLIER) ^ (uint32_t)seed);
+}
+
+inline uint32_t GetRandomBits(uint32_t key, uint32_t indexLow)
+{
+    return Hash32(indexLow * RANDOM_INDEX_MULTIPLIER + key);
+}
+
+/*
+Common implementation of Encode and EncodeStochastic for format F. Works on
+bits of float32 as integers. Mantissa bits that don't fit in F are rounded away
+by adding a value below one step of F and truncating:
+
+- To nearest, ties to even: half of the step minus one, plus the lowest bit that
+  remains after the shift.
+- Stochastic: random number uniformly distributed in 0..step-1, so the
+  probability of rounding up is equal to the fraction of the step.
+
+Carry from mantissa goes to exponent. Infinity becomes a large code, which is
+then treated as overflow.
+*/
+template<typename F, bool Stochastic>
+inline uint8_t EncodeImpl(float value, OVERFLOW_MODE overflowMode, uint32_t randomBits)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(float));
+    const uint32_t signCode = (bits >> (32 - F::BitCount)) & F::SignBit;
+    const uint32_t absBits = bits & ~FLOAT_BITS_SIGN;
+
+    if(absBits > FLOAT_BITS_INF)
+        return (uint8_t)(F::NanCode | signCode);
+
+    const uint32_t exponent = absBits >> 23;
+    const uint32_t minNormalExponent = (uint32_t)(1 - F::ExponentBias + 127);
+    uint32_t code;
+    if(exponent >= minNormalExponent)
+    {
+        const uint32_t shift = 23 - F::MantissaBitCount;
+        const uint32_t addend = Stochastic ?
+            randomBits >> (32 - shift) :
+            (1u << (shift - 1)) - 1 + ((absBits >> shift) & 1);
+        code = ((absBits + addend) >> shift) - ((uint32_t)(127 - F::ExponentBias) << F::MantissaBitCount);
+    }
+    else
+    {
+        // Subnormal in F. Code is the value in units of the smallest
+        // subnormal. Float32 subnormals are always too small and become 0.
+        const uint32_t shift = minNormalExponent + 23 - F::MantissaBitCount - exponent;
+        const uint32_t mantissa = (absBits & 0x7FFFFF) | 0x800000;
+        if(shift > 31)
+            code = 0;
+        else
+        {
+            const uint32_t addend = Stochastic ?
+                randomBits >> (32 - shift) :
+                (1u << (shift - 1)) - 1 + ((mantissa >> shift) & 1);
+            code = (mantissa + addend) >> shift;
+        }
+    }
+
+    if(code > F::MaxCode)
+        code = overflowMode == OVERFLOW_MODE_SATURATE ? F::MaxCode : F::OverflowCode;
+    if(!F::HasNegativeZero && code == 0)
+        return 0;
+    return (uint8_t)(code | signCode);
+}
+
+/*
+Calls func(begIndex, endIndex) for consecutive ranges of chunkSize elements
+covering 0..count, on up to threadCount threads (0 = number of CPU cores),
+including the calling one. Ranges are assigned to threads dynamically, so func
+must not depend on which thread processes which range.
+*/
+template<typename Func>
+void ParallelFor(size_t count, size_t chunkSize, uint32_t threadCount, const Func& func)
+{
+    if(threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+    threadCount = (uint32_t)std::min<size_t>(threadCount, chunkCount);
+
+    std::atomic<size_t> nextChunk(0);
+    auto threadFunc = [&]()
+    {
+        for(;;)
+        {
+            const size_t chunkIndex = nextChunk++;
+            if(chunkIndex >= chunkCount)
+                break;
+            const size_t begIndex = chunkIndex * chunkSize;
+            func(begIndex, std::min(begIndex + chunkSize, count));
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(uint32_t i = 1; i < threadCount; ++i)
+        threads.emplace_back(threadFunc);
+    threadFunc();
+    for(std::thread& thread : threads)
+        thread.join();
+}
+
+} // namespace Detail
+
+/*
+Returns table of 256 float32 values, as bits, for all values of given type,
+indexed by the FP8 byte.
+*/
+inline const uint32_t* GetDecodeTable(TYPE type)
+{
+    const uint32_t* result = nullptr;
+    Detail::VisitType(type, [&](auto format) { result = decltype(format)::GetDecodeTable(); });
+    return result;
+}
+
+// Converts single FP8 value to float32.
+inline float Decode(TYPE type, uint8_t value)
+{
+    float result;
+    memcpy(&result, &GetDecodeTable(type)[value], sizeof(float));
+    return result;
+}
+
+/*
+Converts single float32 value to FP8, rounding to nearest, ties to even.
+This is the reference implementation for EncodeArray.
+*/
+inline uint8_t Encode(TYPE type, float value, OVERFLOW_MODE overflowMode = OVERFLOW_MODE_SATURATE)
+{
+    uint8_t result = 0;
+    Detail::VisitType(type, [&](auto format) { result = decltype(format)::Encode(value, overflowMode); });
+    return result;
+}
+
+/*
+Converts single float32 value to FP8 with stochastic rounding, using
+randomBits as the source of randomness. They should be uniformly distributed.
+Values rounding up above the largest finite value are treated according to
+overflowMode, like in Encode. Values smaller than 2^-8 of the smallest
+subnormal always become zero.
+*/
+inline uint8_t EncodeStochastic(TYPE type, float value, uint32_t randomBits,
+    OVERFLOW_MODE overflowMode = OVERFLOW_MODE_SATURATE)
+{
+    uint8_t result = 0;
+    Detail::VisitType(type, [&](auto format) { result = decltype(format)::EncodeStochastic(value, randomBits, overflowMode); });
+    return result;
+}
+
+/*
+Returns random bits used by EncodeArrayStochastic for element with given index:
+element i is converted using EncodeStochastic(type, src[i],
+GetRandomBits(seed, firstIndex + i)).
+*/
+inline uint32_t GetRandomBits(uint64_t seed, uint64_t index)
+{
+    return Detail::GetRandomBits(Detail::GetRandomKey(seed, (uint32_t)(index >> 32)), (uint32_t)index);
+}
+
+/*
+Converts count FP8 values from src to float32 values in dst.
+src and dst don't need any special alignment.
+*/
+void DecodeArray(TYPE type, const uint8_t* src, size_t count, float* dst);
+
+/*
+Same as DecodeArray, but uses specific instruction set. Useful for testing and
+benchmarking. Instruction set must be supported by current CPU - at most the
+one returned by GetIsa.
+*/
+void DecodeArrayIsa(ISA isa, TYPE type, const uint8_t* src, size_t count, float* dst);
+
+/*
+Converts count float32 values from src to FP8 values in dst. Results are the
+same as from function Encode. src and dst don't need any special alignment.
+*/
+void EncodeArray(TYPE type, const float* src, size_t count, uint8_t* dst,
+    OVERFLOW_MODE overflowMode = OVERFLOW_MODE_SATURATE);
+
+// Same as EncodeArray, but uses specific instruction set.
+void EncodeArrayIsa(ISA isa, TYPE type, const float* src, size_t count, uint8_t* dst,
+    OVERFLOW_MODE overflowMode = OVERFLOW_MODE_SATURATE);
+
+/*
+Converts count float32 values from src to FP8 values in dst with stochastic
+rounding. Elements are numbered starting from firstIndex, so a large array can
+be converted in parts, giving the same results as converting it at once.
+*/
+void EncodeArrayStochastic(TYPE type, const float* src, size_t count, uint8_t* dst,
+    uint64_t seed, uint64_t firstIndex = 0, OVERFLOW_MODE overflowMode = OVERFLOW_MODE_SATURATE);
+
+// Same as EncodeArrayStochastic, but uses specific instruction set.
+void EncodeArrayStochasticIsa(ISA isa, TYPE type, const float* src, size_t count, uint8_t* dst,
+    uint64_t seed, uint64_t firstIndex = 0, OVERFLOW_MODE overflowMode = OVERFLOW_MODE_SATURATE);
+
+/*
+Same as EncodeArrayStochastic with firstIndex = 0, but splits the array into
+chunks processed by threadCount threads, including the calling one.
+threadCount = 0 means number of CPU cores. Results are the same for any number
+of threads.
+*/
+void EncodeArrayStochasticParallel(TYPE type, const float* src, size_t count, uint8_t* dst,
+    uint64_t seed, uint32_t threadCount = 0, OVERFLOW_MODE overflowMode = OVERFLOW_MODE_SATURATE);
+
+////////////////////////////////////////////////////////////////////////////////
+// Microscaling (MX)
+
+// Number of elements sharing one scale.
+static const size_t MX_BLOCK_SIZE = 32;
+
+// Element formats of MX types, named like in OCP Microscaling (MX) specification.
+enum MX_TYPE
+{
+    MX_TYPE_MXFP8_E4M3, // Float8E4M3FN
+    MX_TYPE_MXFP8_E5M2, // Float8E5M2
+    MX_TYPE_MXFP6_E3M2, // Float6E3M2
+    MX_TYPE_MXFP6_E2M3, // Float6E2M3
+    MX_TYPE_MXFP4_E2M1, // Float4E2M1
+    MX_TYPE_COUNT
+};
+
+// Returns name of the type, e.g. "MXFP8_E4M3".
+const char* GetMxTypeName(MX_TYPE type);
+
+/*
+Returns number of bytes taken by elements of one block: 32 for MXFP8, 24 for
+MXFP6, 16 for MXFP4. Elements are packed with no padding, starting from lowest
+bits: every 4 MXFP6 elements take 3 bytes, as a 24-bit little-endian number,
+every 2 MXFP4 elements take one byte, first of them in lower 4 bits.
+*/
+inline size_t GetMxBlockByteCount(MX_TYPE type)
+{
+    return type <= MX_TYPE_MXFP8_E5M2 ? 32 : type <= MX_TYPE_MXFP6_E2M3 ? 24 : 16;
+}
+
+// Returns number of blocks needed for count elements.
+inline size_t GetMxBlockCount(size_t count) { return (count + MX_BLOCK_SIZE - 1) / MX_BLOCK_SIZE; }
+
+/*
+Converts scale in E8M0 format to float32: 2^(scale - 127), or NaN for 0xFF.
+Scale 0, equal to 2^-127, is a float32 subnormal.
+*/
+inline float DecodeMxScale(uint8_t scale)
+{
+    const uint32_t bits = scale == 0xFF ? Detail::FLOAT_BITS_NAN : scale == 0 ? 0x00400000u : (uint32_t)scale << 23;
+    float result;
+    memcpy(&result, &bits, sizeof(float));
+    return result;
+}
+
+/*
+Quantizes count float32 values from src to MX format. Writes
+GetMxBlockCount(count) scales to dstScales and the same number of blocks of
+GetMxBlockByteCount(type) bytes to dstElements. If count is not a multiple of
+MX_BLOCK_SIZE, the last block is padded with zeros.
+
+Scale of a block is 2^(floor(log2(maxAbs)) - MaxExponent of the element
+format), clamped to 2^-127..2^127, as in the specification. Elements are
+divided by it and encoded rounding to nearest, ties to even, saturating to the
+largest finite value. A block containing infinity or NaN gets scale 0xFF
+(NaN), so all its elements decode to NaN.
+*/
+void MxQuantize(MX_TYPE type, const float* src, size_t count, uint8_t* dstScales, uint8_t* dstElements);
+
+// Same as MxQuantize, but uses specific instruction set.
+void MxQuantizeIsa(ISA isa, MX_TYPE type, const float* src, size_t count, uint8_t* dstScales, uint8_t* dstElements);
+
+/*
+Same as MxQuantize, but splits the array into chunks processed by threadCount
+threads, including the calling one. threadCount = 0 means number of CPU cores.
+*/
+void MxQuantizeParallel(MX_TYPE type, const float* src, size_t count, uint8_t* dstScales, uint8_t* dstElements,
+    uint32_t threadCount = 0);
+
+// Converts count elements in MX format to float32 values in dst.
+void MxDequantize(MX_TYPE type, const uint8_t* srcScales, const uint8_t* srcElements, size_t count, float* dst);
+
+// Same as MxDequantize, but uses specific instruction set.
+void MxDequantizeIsa(ISA isa, MX_TYPE type, const uint8_t* srcScales, const uint8_t* srcElements, size_t count,
+    float* dst);
+
+// Same as MxDequantize, but uses threadCount threads, like MxQuantizeParallel.
+void MxDequantizeParallel(MX_TYPE type, const uint8_t* srcScales, const uint8_t* srcElements, size_t count,
+    float* dst, uint32_t threadCount = 0);
+
+} // namespace FP8
+
+// For Visual Studio IntelliSense.
+#ifdef __INTELLISENSE__
+#define FP8_IMPLEMENTATION
+#endif
+
+#ifdef FP8_IMPLEMENTATION
+#undef FP8_IMPLEMENTATION
+
+#include <cassert>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    #define FP8_X86 1
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+#else
+    #define FP8_X86 0
+#endif
+
+// GCC and Clang need functions using intrinsics from instruction sets not
+// enabled on command line to be marked with target attribute. MSVC doesn't.
+#if defined(__GNUC__) || defined(__clang__)
+    #define FP8_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define FP8_TARGET(isa)
+#endif
+
+namespace FP8
+{
+
+const char* GetTypeName(TYPE type)
+{
+    switch(type)
+    {
+    case TYPE_FLOAT8E4M3FN:   return "FLOAT8E4M3FN";
+    case TYPE_FLOAT8E4M3FNUZ: return "FLOAT8E4M3FNUZ";
+    case TYPE_FLOAT8E5M2:     return "FLOAT8E5M2";
+    case TYPE_FLOAT8E5M2FNUZ: return "FLOAT8E5M2FNUZ";
+    default:                  return "";
+    }
+}
+
+const char* GetIsaName(ISA isa)
+{
+    switch(isa)
+    {
+    case ISA_SCALAR: return "Scalar";
+    case ISA_AVX2:   return "AVX2";
+    case ISA_AVX512: return "AVX-512";
+    default:         return "";
+    }
+}
+
+const char* GetMxTypeName(MX_TYPE type)
+{
+    switch(type)
+    {
+    case MX_TYPE_MXFP8_E4M3: return "MXFP8_E4M3";
+    case MX_TYPE_MXFP8_E5M2: return "MXFP8_E5M2";
+    case MX_TYPE_MXFP6_E3M2: return "MXFP6_E3M2";
+    case MX_TYPE_MXFP6_E2M3: return "MXFP6_E2M3";
+    case MX_TYPE_MXFP4_E2M1: return "MXFP4_E2M1";
+    default: return "";
+    }
+}
+
+namespace Detail
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// Scalar
+
+/*
+All kernels are templates compiled separately for each format F, so they don't
+check for the format at runtime.
+*/
+template<typename F>
+static void DecodeArray_Scalar(const uint8_t* src, size_t count, float* dst)
+{
+    const uint32_t* const table = F::GetDecodeTable();
+    for(size_t i = 0; i < count; ++i)
+        memcpy(&dst[i], &table[src[i]], sizeof(float));
+}
+
+/*
+Encoding kernels are also templates for both rounding modes. In stochastic
+rounding, element i uses random bits GetRandomBits(randomKey, firstIndexLow + i),
+which caller ensures doesn't wrap around 2^32.
+*/
+template<typename F, bool Stochastic>
+static void EncodeArray_Scalar(const float* src, size_t count, uint8_t* dst, OVERFLOW_MODE overflowMode,
+    uint32_t randomKey, uint32_t firstIndexLow)
+{
+    for(size_t i = 0; i < count; ++i)
+    {
+        const uint32_t randomBits = Stochastic ? GetRandomBits(randomKey, firstIndexLow + (uint32_t)i) : 0;
+        dst[i] = EncodeImpl<F, Stochastic>(src[i], overflowMode, randomBits);
+    }
+}
+
+/*
+Kernels of MX functions process whole blocks. Codes of elements are packed and
+unpacked separately, one block at a time, so functions below are shared by all
+instruction sets.
+*/
+template<typename F>
+static void PackMxBlock(const uint8_t* codes, uint8_t* dst)
+{
+    if(F::BitCount == 8)
+        memcpy(dst, codes, MX_BLOCK_SIZE);
+    else if(F::BitCount == 6)
+    {
+        for(size_t i = 0; i < MX_BLOCK_SIZE; i += 4, dst += 3)
+        {
+            const uint32_t bits = codes[i] | (codes[i + 1] << 6) | (codes[i + 2] << 12) | (codes[i + 3] << 18);
+            dst[0] = (uint8_t)bits;
+            dst[1] = (uint8_t)(bits >> 8);
+            dst[2] = (uint8_t)(bits >> 16);
+        }
+    }
+    else
+    {
+        for(size_t i = 0; i < MX_BLOCK_SIZE; i += 2)
+            dst[i / 2] = (uint8_t)(codes[i] | (codes[i + 1] << 4));
+    }
+}
+
+template<typename F>
+static void UnpackMxBlock(const uint8_t* src, uint8_t* codes)
+{
+    if(F::BitCount == 8)
+        memcpy(codes, src, MX_BLOCK_SIZE);
+    else if(F::BitCount == 6)
+    {
+        for(size_t i = 0; i < MX_BLOCK_SIZE; i += 4, src += 3)
+        {
+            const uint32_t bits = src[0] | (src[1] << 8) | (src[2] << 16);
+            for(size_t j = 0; j < 4; ++j)
+                codes[i + j] = (uint8_t)((bits >> (j * 6)) & 0x3F);
+        }
+    }
+    else
+    {
+        for(size_t i = 0; i < MX_BLOCK_SIZE; i += 2)
+        {
+            codes[i] = src[i / 2] & 0x0F;
+            codes[i + 1] = src[i / 2] >> 4;
+        }
+    }
+}
+
+// Returns scale in E8M0 format for a block with largest magnitude given as
+// float32 bits.
+template<typename F>
+static uint8_t GetMxScale(uint32_t maxAbsBits)
+{
+    if(maxAbsBits >= FLOAT_BITS_INF)
+        return 0xFF;
+    // Float32 subnormals and zero give exponent -127, which is clamped anyway.
+    const int32_t exponent = (int32_t)(maxAbsBits >> 23) - 127 - F::MaxExponent;
+    return (uint8_t)(std::min(std::max(exponent, -127), 127) + 127);
+}
+
+/*
+Returns 1 / scale, which elements are multiplied by before encoding. It is
+exact, as scales never exceed 2^(127 - MaxExponent). For scale 0xFF, returns 1,
+as elements don't matter then.
+*/
+static float GetMxInverseScale(uint8_t scale)
+{
+    const uint32_t bits = scale == 0xFF ? 0x3F800000u : (uint32_t)(254 - scale) << 23;
+    float result;
+    memcpy(&result, &bits, sizeof(float));
+    return result;
+}
+
+template<typename F>
+static void MxQuantize_Scalar(const float* src, size_t blockCount, uint8_t* dstScales, uint8_t* dstElements)
+{
+    const size_t blockByteCount = MX_BLOCK_SIZE * F::BitCount / 8;
+    uint8_t codes[MX_BLOCK_SIZE];
+    for(size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex)
+    {
+        const float* const blockSrc = src + blockIndex * MX_BLOCK_SIZE;
+        uint32_t maxAbsBits = 0;
+        for(size_t i = 0; i < MX_BLOCK_SIZE; ++i)
+        {
+            uint32_t bits;
+            memcpy(&bits, &blockSrc[i], sizeof(float));
+            maxAbsBits = std::max(maxAbsBits, bits & ~FLOAT_BITS_SIGN);
+        }
+        const uint8_t scale = GetMxScale<F>(maxAbsBits);
+        const float inverseScale = GetMxInverseScale(scale);
+        for(size_t i = 0; i < MX_BLOCK_SIZE; ++i)
+            codes[i] = EncodeImpl<F, false>(blockSrc[i] * inverseScale, OVERFLOW_MODE_SATURATE, 0);
+        dstScales[blockIndex] = scale;
+        PackMxBlock<F>(codes, dstElements + blockIndex * blockByteCount);
+    }
+}
+
+template<typename F>
+static void MxDequantize_Scalar(const uint8_t* srcScales, const uint8_t* srcElements, size_t blockCount, float* dst)
+{
+    const size_t blockByteCount = MX_BLOCK_SIZE * F::BitCount / 8;
+    uint8_t codes[MX_BLOCK_SIZE];
+    for(size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex)
+    {
+        float* const blockDst = dst + blockIndex * MX_BLOCK_SIZE;
+        // Sign of NaN multiplied by NaN is not well defined, so NaN scale is
+        // handled separately.
+        if(srcScales[blockIndex] == 0xFF)
+        {
+            std::fill(blockDst, blockDst + MX_BLOCK_SIZE, DecodeMxScale(0xFF));
+            continue;
+        }
+        UnpackMxBlock<F>(srcElements + blockIndex * blockByteCount, codes);
+        const float scale = DecodeMxScale(srcScales[blockIndex]);
+        for(size_t i = 0; i < MX_BLOCK_SIZE; ++i)
+            blockDst[i] = F::Decode(codes[i]) * scale;
+    }
+}
+
+#if FP8_X86
+
+////////////////////////////////////////////////////////////////////////////////
+// SSE
+
+/*
+Packs 32 codes, one per byte, 0..15 in lo and 16..31 in hi, into elements of
+an MX block, like PackMxBlock.
+*/
+template<typename F>
+FP8_TARGET("ssse3")
+static inline void PackMxBlock_Sse(__m128i lo, __m128i hi, uint8_t* dst)
+{
+    if(F::BitCount == 8)
+    {
+        _mm_storeu_si128((__m128i*)dst, lo);
+        _mm_storeu_si128((__m128i*)(dst + 16), hi);
+    }
+    else if(F::BitCount == 6)
+    {
+        // Join 4 codes in every 32-bit lane into 24 bits, then drop the
+        // highest byte of each lane, giving 12 bytes.
+        const __m128i compact = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+        __m128i packed[2] = { lo, hi };
+        for(uint32_t i = 0; i < 2; ++i)
+        {
+            const __m128i x = packed[i];
+            __m128i bits = _mm_and_si128(x, _mm_set1_epi32(0x3F));
+            bits = _mm_or_si128(bits, _mm_and_si128(_mm_srli_epi32(x, 2), _mm_set1_epi32(0xFC0)));
+            bits = _mm_or_si128(bits, _mm_and_si128(_mm_srli_epi32(x, 4), _mm_set1_epi32(0x3F000)));
+            bits = _mm_or_si128(bits, _mm_and_si128(_mm_srli_epi32(x, 6), _mm_set1_epi32(0xFC0000)));
+            packed[i] = _mm_shuffle_epi8(bits, compact);
+        }
+        // Bytes 0..15 are 12 bytes of lo and first 4 bytes of hi.
+        _mm_storeu_si128((__m128i*)dst, _mm_or_si128(packed[0], _mm_slli_si128(packed[1], 12)));
+        _mm_storel_epi64((__m128i*)(dst + 16), _mm_srli_si128(packed[1], 4));
+    }
+    else
+    {
+        // Join 2 codes in every 16-bit lane into 8 bits.
+        const __m128i lowNibble = _mm_set1_epi16(0x0F);
+        const __m128i highNibble = _mm_set1_epi16(0xF0);
+        const __m128i packedLo = _mm_or_si128(_mm_and_si128(lo, lowNibble), _mm_and_si128(_mm_srli_epi16(lo, 4), highNibble));
+        const __m128i packedHi = _mm_or_si128(_mm_and_si128(hi, lowNibble), _mm_and_si128(_mm_srli_epi16(hi, 4), highNibble));
+        _mm_storeu_si128((__m128i*)dst, _mm_packus_epi16(packedLo, packedHi));
+    }
+}
+
+// Inverse of PackMxBlock_Sse.
+template<typename F>
+FP8_TARGET("ssse3")
+static inline void UnpackMxBlock_Sse(const uint8_t* src, __m128i& lo, __m128i& hi)
+{
+    if(F::BitCount == 8)
+    {
+        lo = _mm_loadu_si128((const __m128i*)src);
+        hi = _mm_loadu_si128((const __m128i*)(src + 16));
+    }
+    else if(F::BitCount == 6)
+    {
+        // Spread every 3 bytes to a 32-bit lane, then move 4 codes in it to
+        // separate bytes.
+        const __m128i spread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m128i bytes0 = _mm_loadu_si128((const __m128i*)src);
+        const __m128i bytes1 = _mm_loadl_epi64((const __m128i*)(src + 16));
+        __m128i unpacked[2] = {
+            _mm_shuffle_epi8(bytes0, spread),
+            _mm_shuffle_epi8(_mm_alignr_epi8(bytes1, bytes0, 12), spread) };
+        for(uint32_t i = 0; i < 2; ++i)
+        {
+            const __m128i x = unpacked[i];
+            __m128i codes = _mm_and_si128(x, _mm_set1_epi32(0x3F));
+            codes = _mm_or_si128(codes, _mm_and_si128(_mm_slli_epi32(x, 2), _mm_set1_epi32(0x3F00)));
+            codes = _mm_or_si128(codes, _mm_and_si128(_mm_slli_epi32(x, 4), _mm_set1_epi32(0x3F0000)));
+            codes = _mm_or_si128(codes, _mm_and_si128(_mm_slli_epi32(x, 6), _mm_set1_epi32(0x3F000000)));
+            unpacked[i] = codes;
+        }
+        lo = unpacked[0];
+        hi = unpacked[1];
+    }
+    else
+    {
+        const __m128i lowNibble = _mm_set1_epi8(0x0F);
+        const __m128i bytes = _mm_loadu_si128((const __m128i*)src);
+        const __m128i even = _mm_and_si128(bytes, lowNibble);
+        const __m128i odd = _mm_and_si128(_mm_srli_epi16(bytes, 4), lowNibble);
+        lo = _mm_unpacklo_epi8(even, odd);
+        hi = _mm_unpackhi_epi8(even, odd);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// AVX2
+
+template<typename F>
+FP8_TARGET("avx2")
+static void DecodeArray_Avx2(const uint8_t* src, size_t count, float* dst)
+{
+    const int* const table = (const int*)F::GetDecodeTable();
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8)
+    {
+        const __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + i)));
+        const __m256i bits = _mm256_i32gather_epi32(table, index, 4);
+        _mm256_storeu_si256((__m256i*)(dst + i), bits);
+    }
+    DecodeArray_Scalar<F>(src + i, count - i, dst + i);
+}
+
+FP8_TARGET("avx2")
+static __m256i Hash32_Avx2(__m256i x)
+{
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32((int)0x85EBCA6Bu));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 13));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32((int)0xC2B2AE35u));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    return x;
+}
+
+/*
+Same algorithm as function EncodeImpl, on 8 values at once, without branches.
+Returns codes in 32-bit lanes.
+*/
+template<typename F, bool Stochastic>
+FP8_TARGET("avx2")
+static inline __m256i EncodeCodes_Avx2(__m256i bits, __m256i randomBits, __m256i overflowCode)
+{
+    const int normalShift = 23 - (int)F::MantissaBitCount;
+    const int minNormalExponent = 1 - F::ExponentBias + 127;
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i exponentOffset = _mm256_set1_epi32((127 - F::ExponentBias) << F::MantissaBitCount);
+    const __m256i subnormalShiftBase = _mm256_set1_epi32(minNormalExponent + normalShift);
+
+    const __m256i absBits = _mm256_and_si256(bits, _mm256_set1_epi32(0x7FFFFFFF));
+    __m256i signCode = _mm256_and_si256(_mm256_srli_epi32(bits, 32 - F::BitCount), _mm256_set1_epi32((int)F::SignBit));
+    const __m256i exponent = _mm256_srli_epi32(absBits, 23);
+    const __m256i mantissa = _mm256_or_si256(
+        _mm256_and_si256(absBits, _mm256_set1_epi32(0x7FFFFF)), _mm256_set1_epi32(0x800000));
+
+    __m256i normalCode, subnormalCode;
+    if(Stochastic)
+    {
+        const __m256i normalAddend = _mm256_srli_epi32(randomBits, 32 - normalShift);
+        normalCode = _mm256_sub_epi32(
+            _mm256_srli_epi32(_mm256_add_epi32(absBits, normalAddend), normalShift), exponentOffset);
+
+        // Shift by 32 or more gives 0, both for the random bits and the
+        // result, as it should.
+        const __m256i shift = _mm256_sub_epi32(subnormalShiftBase, exponent);
+        const __m256i subnormalAddend = _mm256_srlv_epi32(randomBits, _mm256_sub_epi32(_mm256_set1_epi32(32), shift));
+        subnormalCode = _mm256_srlv_epi32(_mm256_add_epi32(mantissa, subnormalAddend), shift);
+    }
+    else
+    {
+        const __m256i normalLsb = _mm256_and_si256(_mm256_srli_epi32(absBits, normalShift), one);
+        const __m256i normalRoundBias = _mm256_set1_epi32((1 << (normalShift - 1)) - 1);
+        const __m256i normalRounded = _mm256_add_epi32(_mm256_add_epi32(absBits, normalRoundBias), normalLsb);
+        normalCode = _mm256_sub_epi32(_mm256_srli_epi32(normalRounded, normalShift), exponentOffset);
+
+        const __m256i shift = _mm256_min_epu32(_mm256_sub_epi32(subnormalShiftBase, exponent), _mm256_set1_epi32(31));
+        const __m256i subnormalRoundBias = _mm256_sub_epi32(_mm256_sllv_epi32(one, _mm256_sub_epi32(shift, one)), one);
+        const __m256i subnormalLsb = _mm256_and_si256(_mm256_srlv_epi32(mantissa, shift), one);
+        subnormalCode = _mm256_srlv_epi32(
+            _mm256_add_epi32(_mm256_add_epi32(mantissa, subnormalRoundBias), subnormalLsb), shift);
+    }
+
+    const __m256i isNormal = _mm256_cmpgt_epi32(exponent, _mm256_set1_epi32(minNormalExponent - 1));
+    __m256i code = _mm256_blendv_epi8(subnormalCode, normalCode, isNormal);
+    code = _mm256_blendv_epi8(code, overflowCode, _mm256_cmpgt_epi32(code, _mm256_set1_epi32((int)F::MaxCode)));
+    code = _mm256_blendv_epi8(code, _mm256_set1_epi32((int)F::NanCode),
+        _mm256_cmpgt_epi32(absBits, _mm256_set1_epi32((int)FLOAT_BITS_INF)));
+    if(!F::HasNegativeZero)
+        signCode = _mm256_andnot_si256(_mm256_cmpeq_epi32(code, _mm256_setzero_si256()), signCode);
+    return _mm256_or_si256(code, signCode);
+}
+
+// Packs 8 codes from 32-bit lanes to 8 bytes.
+FP8_TARGET("avx2")
+static inline __m128i PackCodes_Avx2(__m256i code)
+{
+    // All codes are 0..255, so unsigned saturation leaves them unchanged.
+    // Packing works within 128-bit lanes.
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i bytes = _mm256_packus_epi32(code, zero);
+    bytes = _mm256_packus_epi16(bytes, zero);
+    bytes = _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+    return _mm256_castsi256_si128(bytes);
+}
+
+template<typename F, bool Stochastic>
+FP8_TARGET("avx2")
+static void EncodeArray_Avx2(const float* src, size_t count, uint8_t* dst, OVERFLOW_MODE overflowMode,
+    uint32_t randomKey, uint32_t firstIndexLow)
+{
+    const __m256i overflowCode = _mm256_set1_epi32(
+        (int)(overflowMode == OVERFLOW_MODE_SATURATE ? F::MaxCode : F::OverflowCode));
+    const __m256i randomKeyVec = _mm256_set1_epi32((int)randomKey);
+    const __m256i indexMultiplier = _mm256_set1_epi32((int)RANDOM_INDEX_MULTIPLIER);
+    __m256i index = _mm256_add_epi32(_mm256_set1_epi32((int)firstIndexLow), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    __m256i randomBits = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8)
+    {
+        if(Stochastic)
+        {
+            randomBits = Hash32_Avx2(_mm256_add_epi32(_mm256_mullo_epi32(index, indexMultiplier), randomKeyVec));
+            index = _mm256_add_epi32(index, _mm256_set1_epi32(8));
+        }
+        const __m256i bits = _mm256_loadu_si256((const __m256i*)(src + i));
+        const __m256i code = EncodeCodes_Avx2<F, Stochastic>(bits, randomBits, overflowCode);
+        _mm_storel_epi64((__m128i*)(dst + i), PackCodes_Avx2(code));
+    }
+    EncodeArray_Scalar<F, Stochastic>(src + i, count - i, dst + i, overflowMode, randomKey, firstIndexLow + (uint32_t)i);
+}
+
+template<typename F>
+FP8_TARGET("avx2")
+static void MxQuantize_Avx2(const float* src, size_t blockCount, uint8_t* dstScales, uint8_t* dstElements)
+{
+    const size_t blockByteCount = MX_BLOCK_SIZE * F::BitCount / 8;
+    const __m256i absMask = _mm256_set1_epi32(0x7FFFFFFF);
+    const __m256i maxCode = _mm256_set1_epi32((int)F::MaxCode);
+    const __m256i zero = _mm256_setzero_si256();
+    for(size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex)
+    {
+        const float* const blockSrc = src + blockIndex * MX_BLOCK_SIZE;
+        __m256 v[4];
+        __m256i maxAbsBits = zero;
+        for(uint32_t i = 0; i < 4; ++i)
+        {
+            v[i] = _mm256_loadu_ps(blockSrc + i * 8);
+            maxAbsBits = _mm256_max_epu32(maxAbsBits, _mm256_and_si256(_mm256_castps_si256(v[i]), absMask));
+        }
+        __m128i max4 = _mm_max_epu32(_mm256_castsi256_si128(maxAbsBits), _mm256_extracti128_si256(maxAbsBits, 1));
+        max4 = _mm_max_epu32(max4, _mm_shuffle_epi32(max4, _MM_SHUFFLE(1, 0, 3, 2)));
+        max4 = _mm_max_epu32(max4, _mm_shuffle_epi32(max4, _MM_SHUFFLE(2, 3, 0, 1)));
+
+        const uint8_t scale = GetMxScale<F>((uint32_t)_mm_cvtsi128_si32(max4));
+        const __m256 inverseScale = _mm256_set1_ps(GetMxInverseScale(scale));
+        __m256i codes[4];
+        for(uint32_t i = 0; i < 4; ++i)
+        {
+            codes[i] = EncodeCodes_Avx2<F, false>(
+                _mm256_castps_si256(_mm256_mul_ps(v[i], inverseScale)), zero, maxCode);
+        }
+        // Packing works within 128-bit lanes. Reorder 4-byte groups back.
+        __m256i bytes = _mm256_packus_epi16(_mm256_packus_epi32(codes[0], codes[1]), _mm256_packus_epi32(codes[2], codes[3]));
+        bytes = _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+
+        dstScales[blockIndex] = scale;
+        PackMxBlock_Sse<F>(_mm256_castsi256_si128(bytes), _mm256_extracti128_si256(bytes, 1),
+            dstElements + blockIndex * blockByteCount);
+    }
+}
+
+template<typename F>
+FP8_TARGET("avx2")
+static void MxDequantize_Avx2(const uint8_t* srcScales, const uint8_t* srcElements, size_t blockCount, float* dst)
+{
+    const size_t blockByteCount = MX_BLOCK_SIZE * F::BitCount / 8;
+    const int* const table = (const int*)F::GetDecodeTable();
+    for(size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex)
+    {
+        float* const blockDst = dst + blockIndex * MX_BLOCK_SIZE;
+        if(srcScales[blockIndex] == 0xFF)
+        {
+            std::fill(blockDst, blockDst + MX_BLOCK_SIZE, DecodeMxScale(0xFF));
+            continue;
+        }
+        __m128i codes[2];
+        UnpackMxBlock_Sse<F>(srcElements + blockIndex * blockByteCount, codes[0], codes[1]);
+        const __m256 scale = _mm256_set1_ps(DecodeMxScale(srcScales[blockIndex]));
+        for(uint32_t i = 0; i < 4; ++i)
+        {
+            const __m128i part = (i & 1) ? _mm_srli_si128(codes[i / 2], 8) : codes[i / 2];
+            const __m256i bits = _mm256_i32gather_epi32(table, _mm256_cvtepu8_epi32(part), 4);
+            _mm256_storeu_ps(blockDst + i * 8, _mm256_mul_ps(_mm256_castsi256_ps(bits), scale));
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// AVX-512
+
+/*
+Table of format F is kept in registers, 16 entries in each. Tables of 8-bit
+formats take 8 registers with magnitudes of the 128 positive values.
+*/
+template<typename F>
+FP8_TARGET("avx512f")
+static inline void LoadDecodeTable_Avx512(__m512i* t)
+{
+    const uint32_t* const table = F::GetDecodeTable();
+    const uint32_t registerCount = F::CodeCount >= 256 ? 8 : F::CodeCount / 16;
+    for(uint32_t i = 0; i < registerCount; ++i)
+        t[i] = _mm512_loadu_si512((const void*)(table + i * 16));
+}
+
+/*
+Returns float32 bits for 16 codes in 32-bit lanes, using table loaded by
+LoadDecodeTable_Avx512. For 8-bit formats, each vpermt2d looks up 16 values in
+32 table entries, so 4 of them cover all 128 magnitudes, and bits 5 and 6 of
+the index select the right result. Sign is copied from bit 7. This is correct
+for all values, except negative zero in UZ types, which is NaN.
+*/
+template<typename F>
+FP8_TARGET("avx512f")
+static inline __m512i DecodeCodes_Avx512(__m512i index, const __m512i* t)
+{
+    static_assert(F::CodeCount == 16 || F::CodeCount == 64 || F::CodeCount == 256, "Unsupported number of codes.");
+    if(F::CodeCount == 16)
+        return _mm512_permutexvar_epi32(index, t[0]);
+    const __mmask16 m5 = _mm512_test_epi32_mask(index, _mm512_set1_epi32(0x20));
+    const __m512i r0 = _mm512_permutex2var_epi32(t[0], index, t[1]);
+    const __m512i r1 = _mm512_permutex2var_epi32(t[2], index, t[3]);
+    const __m512i r01 = _mm512_mask_blend_epi32(m5, r0, r1);
+    if(F::CodeCount == 64)
+        return r01;
+
+    const __m512i bit7 = _mm512_set1_epi32((int)F::SignBit);
+    const __m512i r2 = _mm512_permutex2var_epi32(t[4], index, t[5]);
+    const __m512i r3 = _mm512_permutex2var_epi32(t[6], index, t[7]);
+    const __mmask16 m6 = _mm512_test_epi32_mask(index, _mm512_set1_epi32(0x40));
+    const __m512i r23 = _mm512_mask_blend_epi32(m5, r2, r3);
+    __m512i bits = _mm512_mask_blend_epi32(m6, r01, r23);
+    // Move bit 7 to bit 31.
+    bits = _mm512_or_si512(bits, _mm512_slli_epi32(_mm512_and_si512(index, bit7), 24));
+    if(!F::HasNegativeZero)
+    {
+        bits = _mm512_mask_mov_epi32(bits, _mm512_cmpeq_epi32_mask(index, bit7),
+            _mm512_set1_epi32((int)(FLOAT_BITS_SIGN | FLOAT_BITS_NAN)));
+    }
+    return bits;
+}
+
+template<typename F>
+FP8_TARGET("avx512f")
+static void DecodeArray_Avx512(const uint8_t* src, size_t count, float* dst)
+{
+    __m512i t[8];
+    LoadDecodeTable_Avx512<F>(t);
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16)
+    {
+        const __m512i index = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i*)(src + i)));
+        _mm512_storeu_si512((void*)(dst + i), DecodeCodes_Avx512<F>(index, t));
+    }
+    DecodeArray_Scalar<F>(src + i, count - i, dst + i);
+}
+
+FP8_TARGET("avx512f")
+static __m512i Hash32_Avx512(__m512i x)
+{
+    x = _mm512_xor_si512(x, _mm512_srli_epi32(x, 16));
+    x = _mm512_mullo_epi32(x, _mm512_set1_epi32((int)0x85EBCA6Bu));
+    x = _mm512_xor_si512(x, _mm512_srli_epi32(x, 13));
+    x = _mm512_mullo_epi32(x, _mm512_set1_epi32((int)0xC2B2AE35u));
+    x = _mm512_xor_si512(x, _mm512_srli_epi32(x, 16));
+    return x;
+}
+
+// Same algorithm as function EncodeImpl, on 16 values at once, without
+// branches. Returns codes in 32-bit lanes.
+template<typename F, bool Stochastic>
+FP8_TARGET("avx512f")
+static inline __m512i EncodeCodes_Avx512(__m512i bits, __m512i randomBits, __m512i overflowCode)
+{
+    const int normalShift = 23 - (int)F::MantissaBitCount;
+    const int minNormalExponent = 1 - F::ExponentBias + 127;
+    const __m512i one = _mm512_set1_epi32(1);
+    const __m512i exponentOffset = _mm512_set1_epi32((127 - F::ExponentBias) << F::MantissaBitCount);
+    const __m512i subnormalShiftBase = _mm512_set1_epi32(minNormalExponent + normalShift);
+
+    const __m512i absBits = _mm512_and_si512(bits, _mm512_set1_epi32(0x7FFFFFFF));
+    const __m512i signCode = _mm512_and_si512(_mm512_srli_epi32(bits, 32 - F::BitCount), _mm512_set1_epi32((int)F::SignBit));
+    const __m512i exponent = _mm512_srli_epi32(absBits, 23);
+    const __m512i mantissa = _mm512_or_si512(
+        _mm512_and_si512(absBits, _mm512_set1_epi32(0x7FFFFF)), _mm512_set1_epi32(0x800000));
+
+    __m512i normalCode, subnormalCode;
+    if(Stochastic)
+    {
+        const __m512i normalAddend = _mm512_srli_epi32(randomBits, 32 - normalShift);
+        normalCode = _mm512_sub_epi32(
+            _mm512_srli_epi32(_mm512_add_epi32(absBits, normalAddend), normalShift), exponentOffset);
+
+        const __m512i shift = _mm512_sub_epi32(subnormalShiftBase, exponent);
+        const __m512i subnormalAddend = _mm512_srlv_epi32(randomBits, _mm512_sub_epi32(_mm512_set1_epi32(32), shift));
+        subnormalCode = _mm512_srlv_epi32(_mm512_add_epi32(mantissa, subnormalAddend), shift);
+    }
+    else
+    {
+        const __m512i normalLsb = _mm512_and_si512(_mm512_srli_epi32(absBits, normalShift), one);
+        const __m512i normalRoundBias = _mm512_set1_epi32((1 << (normalShift - 1)) - 1);
+        const __m512i normalRounded = _mm512_add_epi32(_mm512_add_epi32(absBits, normalRoundBias), normalLsb);
+        normalCode = _mm512_sub_epi32(_mm512_srli_epi32(normalRounded, normalShift), exponentOffset);
+
+        const __m512i shift = _mm512_min_epu32(_mm512_sub_epi32(subnormalShiftBase, exponent), _mm512_set1_epi32(31));
+        const __m512i subnormalRoundBias = _mm512_sub_epi32(_mm512_sllv_epi32(one, _mm512_sub_epi32(shift, one)), one);
+        const __m512i subnormalLsb = _mm512_and_si512(_mm512_srlv_epi32(mantissa, shift), one);
+        subnormalCode = _mm512_srlv_epi32(
+            _mm512_add_epi32(_mm512_add_epi32(mantissa, subnormalRoundBias), subnormalLsb), shift);
+    }
+
+    const __mmask16 isNormal = _mm512_cmpge_epu32_mask(exponent, _mm512_set1_epi32(minNormalExponent));
+    __m512i code = _mm512_mask_blend_epi32(isNormal, subnormalCode, normalCode);
+    code = _mm512_mask_mov_epi32(code, _mm512_cmpgt_epi32_mask(code, _mm512_set1_epi32((int)F::MaxCode)), overflowCode);
+    code = _mm512_mask_mov_epi32(code, _mm512_cmpgt_epi32_mask(absBits, _mm512_set1_epi32((int)FLOAT_BITS_INF)),
+        _mm512_set1_epi32((int)F::NanCode));
+    if(!F::HasNegativeZero)
+        return _mm512_or_si512(code, _mm512_maskz_mov_epi32(_mm512_test_epi32_mask(code, code), signCode));
+    return _mm512_or_si512(code, signCode);
+}
+
+template<typename F, bool Stochastic>
+FP8_TARGET("avx512f")
+static void EncodeArray_Avx512(const float* src, size_t count, uint8_t* dst, OVERFLOW_MODE overflowMode,
+    uint32_t randomKey, uint32_t firstIndexLow)
+{
+    const __m512i overflowCode = _mm512_set1_epi32(
+        (int)(overflowMode == OVERFLOW_MODE_SATURATE ? F::MaxCode : F::OverflowCode));
+    const __m512i randomKeyVec = _mm512_set1_epi32((int)randomKey);
+    const __m512i indexMultiplier = _mm512_set1_epi32((int)RANDOM_INDEX_MULTIPLIER);
+    __m512i index = _mm512_add_epi32(_mm512_set1_epi32((int)firstIndexLow),
+        _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    __m512i randomBits = _mm512_setzero_si512();
+
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16)
+    {
+        if(Stochastic)
+        {
+            randomBits = Hash32_Avx512(_mm512_add_epi32(_mm512_mullo_epi32(index, indexMultiplier), randomKeyVec));
+            index = _mm512_add_epi32(index, _mm512_set1_epi32(16));
+        }
+        const __m512i bits = _mm512_loadu_si512((const void*)(src + i));
+        const __m512i code = EncodeCodes_Avx512<F, Stochastic>(bits, randomBits, overflowCode);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm512_cvtepi32_epi8(code));
+    }
+    EncodeArray_Scalar<F, Stochastic>(src + i, count - i, dst + i, overflowMode, randomKey, firstIndexLow + (uint32_t)i);
+}
+
+template<typename F>
+FP8_TARGET("avx512f")
+static void MxQuantize_Avx512(const float* src, size_t blockCount, uint8_t* dstScales, uint8_t* dstElements)
+{
+    const size_t blockByteCount = MX_BLOCK_SIZE * F::BitCount / 8;
+    const __m512i absMask = _mm512_set1_epi32(0x7FFFFFFF);
+    const __m512i maxCode = _mm512_set1_epi32((int)F::MaxCode);
+    const __m512i zero = _mm512_setzero_si512();
+    for(size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex)
+    {
+        const float* const blockSrc = src + blockIndex * MX_BLOCK_SIZE;
+        const __m512 v0 = _mm512_loadu_ps(blockSrc);
+        const __m512 v1 = _mm512_loadu_ps(blockSrc + 16);
+        const __m512i maxAbsBits = _mm512_max_epu32(
+            _mm512_and_si512(_mm512_castps_si512(v0), absMask), _mm512_and_si512(_mm512_castps_si512(v1), absMask));
+
+        const uint8_t scale = GetMxScale<F>(_mm512_reduce_max_epu32(maxAbsBits));
+        const __m512 inverseScale = _mm512_set1_ps(GetMxInverseScale(scale));
+        const __m512i codes0 = EncodeCodes_Avx512<F, false>(_mm512_castps_si512(_mm512_mul_ps(v0, inverseScale)), zero, maxCode);
+        const __m512i codes1 = EncodeCodes_Avx512<F, false>(_mm512_castps_si512(_mm512_mul_ps(v1, inverseScale)), zero, maxCode);
+
+        dstScales[blockIndex] = scale;
+        PackMxBlock_Sse<F>(_mm512_cvtepi32_epi8(codes0), _mm512_cvtepi32_epi8(codes1),
+            dstElements + blockIndex * blockByteCount);
+    }
+}
+
+template<typename F>
+FP8_TARGET("avx512f")
+static void MxDequantize_Avx512(const uint8_t* srcScales, const uint8_t* srcElements, size_t blockCount, float* dst)
+{
+    const size_t blockByteCount = MX_BLOCK_SIZE * F::BitCount / 8;
+    __m512i t[8];
+    LoadDecodeTable_Avx512<F>(t);
+    for(size_t blockIndex = 0; blockIndex < blockCount; ++blockIndex)
+    {
+        float* const blockDst = dst + blockIndex * MX_BLOCK_SIZE;
+        if(srcScales[blockIndex] == 0xFF)
+        {
+            std::fill(blockDst, blockDst + MX_BLOCK_SIZE, DecodeMxScale(0xFF));
+            continue;
+        }
+        __m128i codes0, codes1;
+        UnpackMxBlock_Sse<F>(srcElements + blockIndex * blockByteCount, codes0, codes1);
+        const __m512 scale = _mm512_set1_ps(DecodeMxScale(srcScales[blockIndex]));
+        const __m512i bits0 = DecodeCodes_Avx512<F>(_mm512_cvtepu8_epi32(codes0), t);
+        const __m512i bits1 = DecodeCodes_Avx512<F>(_mm512_cvtepu8_epi32(codes1), t);
+        _mm512_storeu_ps(blockDst, _mm512_mul_ps(_mm512_castsi512_ps(bits0), scale));
+        _mm512_storeu_ps(blockDst + 16, _mm512_mul_ps(_mm512_castsi512_ps(bits1), scale));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// CPU detection
+
+static ISA DetectIsa()
+{
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 0);
+    const int maxLeaf = regs[0];
+    __cpuid(regs, 1);
+    const bool hasOsxsave = (regs[2] & (1 << 27)) != 0;
+    const bool hasAvx = (regs[2] & (1 << 28)) != 0;
+    const bool hasFma = (regs[2] & (1 << 12)) != 0;
+    if(!hasOsxsave || !hasAvx || !hasFma || maxLeaf < 7)
+        return ISA_SCALAR;
+    // Check that the OS saves YMM and ZMM registers.
+    const unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(regs, 7, 0);
+    const bool hasAvx2 = (regs[1] & (1 << 5)) != 0;
+    const bool hasAvx512F = (regs[1] & (1 << 16)) != 0;
+    const bool hasAvx512BW = (regs[1] & (1 << 30)) != 0;
+    const bool hasAvx512VL = (regs[1] & (1u << 31)) != 0;
+    if(hasAvx2 && hasAvx512F && hasAvx512BW && hasAvx512VL && (xcr0 & 0xE6) == 0xE6)
+        return ISA_AVX512;
+    if(hasAvx2 && (xcr0 & 0x6) == 0x6)
+        return ISA_AVX2;
+    return ISA_SCALAR;
+#else
+    __builtin_cpu_init();
+    // FMA always comes with AVX2 in practice, but is checked to be safe, as
+    // kernels of FP8Gemm.h use it.
+    if(!__builtin_cpu_supports("avx2") || !__builtin_cpu_supports("fma"))
+        return ISA_SCALAR;
+    if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl"))
+        return ISA_AVX512;
+    return ISA_AVX2;
+#endif
+}
+
+#else // #if FP8_X86
+
+static ISA DetectIsa()
+{
+    return ISA_SCALAR;
+}
+
+#endif // #if FP8_X86
+
+} // namespace Detail
+
+ISA GetIsa()
+{
+    // Race between threads is harmless - all of them calculate the same value.
+    static volatile int s_Isa = -1;
+    if(s_Isa < 0)
+        s_Isa = (int)Detail::DetectIsa();
+    return (ISA)s_Isa;
+}
+
+void DecodeArrayIsa(ISA isa, TYPE type, const uint8_t* src, size_t count, float* dst)
+{
+    assert(isa <= GetIsa());
+    Detail::VisitType(type, [&](auto format)
+    {
+        typedef decltype(format) F;
+        switch(isa)
+        {
+#if FP8_X86
+        case ISA_AVX2:   Detail::DecodeArray_Avx2<F>(src, count, dst); break;
+        case ISA_AVX512: Detail::DecodeArray_Avx512<F>(src, count, dst); break;
+#endif
+        default:         Detail::DecodeArray_Scalar<F>(src, count, dst);
+        }
+    });
+}
+
+void DecodeArray(TYPE type, const uint8_t* src, size_t count, float* dst)
+{
+    DecodeArrayIsa(GetIsa(), type, src, count, dst);
+}
+
+namespace Detail
+{
+
+template<bool Stochastic>
+static void EncodeArrayIsaImpl(ISA isa, TYPE type, const float* src, size_t count, uint8_t* dst, OVERFLOW_MODE overflowMode,
+    uint32_t randomKey, uint32_t firstIndexLow)
+{
+    assert(isa <= GetIsa());
+    VisitType(type, [&](auto format)
+    {
+        typedef decltype(format) F;
+        switch(isa)
+        {
+#if FP8_X86
+        case ISA_AVX2:   EncodeArray_Avx2<F, Stochastic>(src, count, dst, overflowMode, randomKey, firstIndexLow); break;
+        case ISA_AVX512: EncodeArray_Avx512<F, Stochastic>(src, count, dst, overflowMode, randomKey, firstIndexLow); break;
+#endif
+        default:         EncodeArray_Scalar<F, Stochastic>(src, count, dst, overflowMode, randomKey, firstIndexLow);
+        }
+    });
+}
+
+} // namespace Detail
+
+void EncodeArrayIsa(ISA isa, TYPE type, const float* src, size_t count, uint8_t* dst, OVERFLOW_MODE overflowMode)
+{
+    Detail::EncodeArrayIsaImpl<false>(isa, type, src, count, dst, overflowMode, 0, 0);
+}
+
+void EncodeArray(TYPE type, const float* src, size_t count, uint8_t* dst, OVERFLOW_MODE overflowMode)
+{
+    EncodeArrayIsa(GetIsa(), type, src, count, dst, overflowMode);
+}
+
+void EncodeArrayStochasticIsa(ISA isa, TYPE type, const float* src, size_t count, uint8_t* dst,
+    uint64_t seed, uint64_t firstIndex, OVERFLOW_MODE overflowMode)
+{
+    // Kernels use 32-bit indices, so split at multiples of 2^32.
+    while(count > 0)
+    {
+        const uint32_t firstIndexLow = (uint32_t)firstIndex;
+        const size_t partCount = (size_t)std::min<uint64_t>(count, (1ull << 32) - firstIndexLow);
+        const uint32_t randomKey = Detail::GetRandomKey(seed, (uint32_t)(firstIndex >> 32));
+        Detail::EncodeArrayIsaImpl<true>(isa, type, src, partCount, dst, overflowMode, randomKey, firstIndexLow);
+        src += partCount;
+        dst += partCount;
+        count -= partCount;
+        firstIndex += partCount;
+    }
+}
+
+void EncodeArrayStochastic(TYPE type, const float* src, size_t count, uint8_t* dst,
+    uint64_t seed, uint64_t firstIndex, OVERFLOW_MODE overflowMode)
+{
+    EncodeArrayStochasticIsa(GetIsa(), type, src, count, dst, seed, firstIndex, overflowMode);
+}
+
+void EncodeArrayStochasticParallel(TYPE type, const float* src, size_t count, uint8_t* dst,
+    uint64_t seed, uint32_t threadCount, OVERFLOW_MODE overflowMode)
+{
+    // 256 KB of input - large enough to make the cost of taking a chunk
+    // negligible, small enough to balance work among threads.
+    const size_t chunkSize = 65536;
+    const ISA isa = GetIsa();
+    Detail::ParallelFor(count, chunkSize, threadCount, [=](size_t begIndex, size_t endIndex)
+    {
+        EncodeArrayStochasticIsa(isa, type, src + begIndex, endIndex - begIndex, dst + begIndex,
+            seed, begIndex, overflowMode);
+    });
+}
+
+namespace Detail
+{
+
+// Like VisitType, for element formats of MX types.
+template<typename Func>
+static void VisitMxType(MX_TYPE type, const Func& func)
+{
+    switch(type)
+    {
+    case MX_TYPE_MXFP8_E4M3: func(Float8E4M3FN()); break;
+    case MX_TYPE_MXFP8_E5M2: func(Float8E5M2()); break;
+    case MX_TYPE_MXFP6_E3M2: func(Float6E3M2()); break;
+    case MX_TYPE_MXFP6_E2M3: func(Float6E2M3()); break;
+    case MX_TYPE_MXFP4_E2M1: func(Float4E2M1()); break;
+    default: assert(0);
+    }
+}
+
+// 2048 blocks = 256 KB of float32 - same as chunks of EncodeArrayStochasticParallel.
+static const size_t MX_PARALLEL_CHUNK_BLOCK_COUNT = 2048;
+
+} // namespace Detail
+
+void MxQuantizeIsa(ISA isa, MX_TYPE type, const float* src, size_t count, uint8_t* dstScales, uint8_t* dstElements)
+{
+    assert(isa <= GetIsa());
+    Detail::VisitMxType(type, [&](auto format)
+    {
+        typedef decltype(format) F;
+        const size_t blockCount = count / MX_BLOCK_SIZE;
+        switch(isa)
+        {
+#if FP8_X86
+        case ISA_AVX2:   Detail::MxQuantize_Avx2<F>(src, blockCount, dstScales, dstElements); break;
+        case ISA_AVX512: Detail::MxQuantize_Avx512<F>(src, blockCount, dstScales, dstElements); break;
+#endif
+        default:         Detail::MxQuantize_Scalar<F>(src, blockCount, dstScales, dstElements);
+        }
+
+        const size_t remainingCount = count % MX_BLOCK_SIZE;
+        if(remainingCount > 0)
+        {
+            float lastBlock[MX_BLOCK_SIZE] = {};
+            memcpy(lastBlock, src + blockCount * MX_BLOCK_SIZE, remainingCount * sizeof(float));
+            Detail::MxQuantize_Scalar<F>(lastBlock, 1, dstScales + blockCount,
+                dstElements + blockCount * GetMxBlockByteCount(type));
+        }
+    });
+}
+
+void MxQuantize(MX_TYPE type, const float* src, size_t count, uint8_t* dstScales, uint8_t* dstElements)
+{
+    MxQuantizeIsa(GetIsa(), type, src, count, dstScales, dstElements);
+}
+
+void MxQuantizeParallel(MX_TYPE type, const float* src, size_t count, uint8_t* dstScales, uint8_t* dstElements,
+    uint32_t threadCount)
+{
+    const ISA isa = GetIsa();
+    const size_t blockByteCount = GetMxBlockByteCount(type);
+    Detail::ParallelFor(GetMxBlockCount(count), Detail::MX_PARALLEL_CHUNK_BLOCK_COUNT, threadCount,
+        [=](size_t begBlock, size_t endBlock)
+    {
+        const size_t begIndex = begBlock * MX_BLOCK_SIZE;
+        const size_t endIndex = std::min(endBlock * MX_BLOCK_SIZE, count);
+        MxQuantizeIsa(isa, type, src + begIndex, endIndex - begIndex, dstScales + begBlock,
+            dstElements + begBlock * blockByteCount);
+    });
+}
+
+void MxDequantizeIsa(ISA isa, MX_TYPE type, const uint8_t* srcScales, const uint8_t* srcElements, size_t count,
+    float* dst)
+{
+    assert(isa <= GetIsa());
+    Detail::VisitMxType(type, [&](auto format)
+    {
+        typedef decltype(format) F;
+        const size_t blockCount = count / MX_BLOCK_SIZE;
+        switch(isa)
+        {
+#if FP8_X86
+        case ISA_AVX2:   Detail::MxDequantize_Avx2<F>(srcScales, srcElements, blockCount, dst); break;
+        case ISA_AVX512: Detail::MxDequantize_Avx512<F>(srcScales, srcElements, blockCount, dst); break;
+#endif
+        default:         Detail::MxDequantize_Scalar<F>(srcScales, srcElements, blockCount, dst);
+        }
+
+        const size_t remainingCount = count % MX_BLOCK_SIZE;
+        if(remainingCount > 0)
+        {
+            float lastBlock[MX_BLOCK_SIZE];
+            Detail::MxDequantize_Scalar<F>(srcScales + blockCount,
+                srcElements + blockCount * GetMxBlockByteCount(type), 1, lastBlock);
+            memcpy(dst + blockCount * MX_BLOCK_SIZE, lastBlock, remainingCount * sizeof(float));
+        }
+    });
+}
+
+void MxDequantize(MX_TYPE type, const uint8_t* srcScales, const uint8_t* srcElements, size_t count, float* dst)
+{
+    MxDequantizeIsa(GetIsa(), type, srcScales, srcElements, count, dst);
+}
+
+void MxDequantizeParallel(MX_TYPE type, const uint8_t* srcScales, const uint8_t* srcElements, size_t count,
+    float* dst, uint32_t threadCount)
+{
+    const ISA isa = GetIsa();
+    const size_t blockByteCount = GetMxBlockByteCount(type);
+    Detail::ParallelFor(GetMxBlockCount(count), Detail::MX_PARALLEL_CHUNK_BLOCK_COUNT, threadCount,
+        [=](size_t begBlock, size_t endBlock)
+    {
+        const size_t begIndex = begBlock * MX_BLOCK_SIZE;
+        const size_t endIndex = std::min(endBlock * MX_BLOCK_SIZE, count);
+        MxDequantizeIsa(isa, type, srcScales + begBlock, srcElements + begBlock * blockByteCount,
+            endIndex - begIndex, dst + begIndex);
+    });
+}
+
+} // namespace FP8
+
+#endif // #ifdef FP8_IMPLEMENTATION
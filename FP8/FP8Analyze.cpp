@@ -0,0 +1,292 @@
+/*
+FP8Analyze.cpp
+
+Author:  Adam Sawicki, https://asawicki.info, adam__REMOVE__@asawicki.info
+Version: 1.0.0, 2026-10-19
+License: Public Domain
+
+Measures how well real data is represented in each of the four FP8 formats of
+fp8_tables.py, to help choose one of them, e.g. per layer of a model.
+fp8_tables.py shows only the limits of the formats. This tool encodes all
+values of given files to each format and back, the same way as FP8::EncodeArray
+with OVERFLOW_MODE_SATURATE, and reports:
+
+- Overflow  - finite values that round to magnitude above the largest finite
+              value, so they are saturated to it. Values slightly above it
+              that round down to it are not counted.
+- Underflow - nonzero values that became zero.
+- Subnormal - values encoded as nonzero subnormals, which have less precision.
+- RMS and maximum relative error over all finite nonzero values, including
+  the ones that overflowed or underflowed.
+- Histogram of exponents of the encoded values: how many of them fall into
+  each binade [2^e, 2^(e+1)) of the format.
+
+NaN and infinity in the input are counted, but excluded from other statistics.
+
+Files are raw arrays of little-endian float32 numbers, like saved with
+numpy.ndarray.tofile. They are opened with memory mapping, so they can be
+larger than RAM, and processed in chunks distributed among all CPU cores.
+
+Usage:
+    FP8Analyze [--auto-scale] [--threads N] [--histogram] file...
+
+--auto-scale - before encoding to each format, multiply values by a scale that
+               maps the largest magnitude in the file to the largest finite
+               value of the format, like per-tensor scaling in training.
+               Scale is limited to FLT_MAX, so it stays finite when the
+               largest magnitude is very small.
+--threads N  - number of threads. Default: number of CPU cores.
+--histogram  - print histograms of exponents.
+
+Build, e.g.:
+    g++ -O2 -pthread FP8Analyze.cpp
+*/
+#define FP8_IMPLEMENTATION
+#define FP8_TENSOR_IMPLEMENTATION
+#include "FP8Tensor.h"
+
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+// 256 KB of float32 - fits in L2 cache together with encoded and decoded values.
+static const size_t CHUNK_SIZE = 65536;
+static const uint32_t TYPE_COUNT = 4;
+// Enough for exponents of all formats, which have at most 5 bits.
+static const uint32_t MAX_EXPONENT_CODES = 32;
+
+struct STATISTICS
+{
+    uint64_t NonFiniteCount = 0;
+    uint64_t ZeroCount = 0;
+    uint64_t OverflowCount = 0;
+    uint64_t UnderflowCount = 0;
+    uint64_t SubnormalCount = 0;
+    double SumSquaredRelativeError = 0.0;
+    double MaxRelativeError = 0.0;
+    // Indexed by exponent bits of the code. Exponent 0 means subnormals.
+    uint64_t ExponentHistogram[MAX_EXPONENT_CODES] = {};
+
+    void Add(const STATISTICS& s)
+    {
+        NonFiniteCount += s.NonFiniteCount;
+        ZeroCount += s.ZeroCount;
+        OverflowCount += s.OverflowCount;
+        UnderflowCount += s.UnderflowCount;
+        SubnormalCount += s.SubnormalCount;
+        SumSquaredRelativeError += s.SumSquaredRelativeError;
+        MaxRelativeError = std::max(MaxRelativeError, s.MaxRelativeError);
+        for(uint32_t i = 0; i < MAX_EXPONENT_CODES; ++i)
+            ExponentHistogram[i] += s.ExponentHistogram[i];
+    }
+};
+
+// Calculates statistics of count values from src multiplied by scale, using
+// buffers of CHUNK_SIZE elements.
+template<typename F>
+static void AnalyzeChunk(FP8::TYPE type, const float* src, size_t count, float scale,
+    float* scaled, uint8_t* encoded, float* decoded, STATISTICS& stats)
+{
+    if(scale != 1.f)
+    {
+        for(size_t i = 0; i < count; ++i)
+            scaled[i] = src[i] * scale;
+        src = scaled;
+    }
+    FP8::EncodeArray(type, src, count, encoded);
+    FP8::DecodeArray(type, encoded, count, decoded);
+
+    // Halfway between the largest finite value and the next one it would have
+    // with more exponent bits. Values up to it round down to the largest finite
+    // value, except the tie itself, which rounds up if its code is odd.
+    const float overflowBoundary = F::Max() + FP8::Detail::Pow2(F::MaxExponent - (int32_t)F::MantissaBitCount - 1);
+    const bool overflowAtBoundary = (F::MaxCode & 1) != 0;
+    for(size_t i = 0; i < count; ++i)
+    {
+        const float value = src[i];
+        const float absValue = std::fabs(value);
+        if(!(absValue <= FLT_MAX))
+        {
+            ++stats.NonFiniteCount;
+            continue;
+        }
+        if(value == 0.f)
+        {
+            ++stats.ZeroCount;
+            continue;
+        }
+
+        const uint32_t magnitudeCode = encoded[i] & (F::SignBit - 1);
+        const uint32_t exponentCode = magnitudeCode >> F::MantissaBitCount;
+        if(absValue > overflowBoundary || (absValue == overflowBoundary && overflowAtBoundary))
+            ++stats.OverflowCount;
+        if(magnitudeCode == 0)
+            ++stats.UnderflowCount;
+        else
+        {
+            if(exponentCode == 0)
+                ++stats.SubnormalCount;
+            ++stats.ExponentHistogram[exponentCode];
+        }
+
+        const double relativeError = std::fabs((double)decoded[i] - (double)value) / (double)absValue;
+        stats.SumSquaredRelativeError += relativeError * relativeError;
+        stats.MaxRelativeError = std::max(stats.MaxRelativeError, relativeError);
+    }
+}
+
+struct INPUT_INFO
+{
+    float MaxAbs = 0.f;
+    uint64_t ZeroCount = 0;
+    uint64_t NonFiniteCount = 0;
+};
+
+static INPUT_INFO ScanInput(const float* data, size_t count, uint32_t threadCount)
+{
+    std::mutex mutex;
+    INPUT_INFO result;
+    FP8::Detail::ParallelFor(count, CHUNK_SIZE, threadCount, [&](size_t begIndex, size_t endIndex)
+    {
+        INPUT_INFO info;
+        for(size_t i = begIndex; i < endIndex; ++i)
+        {
+            const float absValue = std::fabs(data[i]);
+            // Comparison is false for NaN.
+            if(absValue <= FLT_MAX)
+                info.MaxAbs = std::max(info.MaxAbs, absValue);
+            else
+                ++info.NonFiniteCount;
+            if(absValue == 0.f)
+                ++info.ZeroCount;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        result.MaxAbs = std::max(result.MaxAbs, info.MaxAbs);
+        result.ZeroCount += info.ZeroCount;
+        result.NonFiniteCount += info.NonFiniteCount;
+    });
+    return result;
+}
+
+static void PrintHistogram(const STATISTICS& stats, uint32_t exponentCodeCount, int32_t bias, uint64_t totalCount)
+{
+    for(uint32_t e = 0; e < exponentCodeCount; ++e)
+    {
+        if(stats.ExponentHistogram[e] == 0)
+            continue;
+        // Subnormals have the same exponent as the smallest normals.
+        const int32_t exponent = (e == 0 ? 1 : (int32_t)e) - bias;
+        printf("    %s2^%-4d %14llu %7.3f%%\n", e == 0 ? "sub " : "    ", exponent,
+            (unsigned long long)stats.ExponentHistogram[e], 100.0 * (double)stats.ExponentHistogram[e] / (double)totalCount);
+    }
+}
+
+static bool AnalyzeFile(const char* path, bool autoScale, bool printHistogram, uint32_t threadCount)
+{
+    FP8::MappedFile file;
+    if(!file.Open(path))
+    {
+        printf("%s: cannot open file.\n", path);
+        return false;
+    }
+    if(file.GetSize() % sizeof(float) != 0)
+    {
+        printf("%s: size is not a multiple of 4 bytes.\n", path);
+        return false;
+    }
+    const float* const data = (const float*)file.GetData();
+    const size_t count = (size_t)(file.GetSize() / sizeof(float));
+    const INPUT_INFO input = ScanInput(data, count, threadCount);
+    const float maxAbs = input.MaxAbs;
+    printf("%s: %zu values, max abs %g, zeros: %llu, NaN or infinity: %llu\n", path, count, maxAbs,
+        (unsigned long long)input.ZeroCount, (unsigned long long)input.NonFiniteCount);
+    printf("%-16s %11s %9s %9s %9s %12s %12s\n", "Type", "Scale", "Overflow", "Underflow", "Subnormal",
+        "RMS rel err", "Max rel err");
+
+    for(uint32_t typeIndex = 0; typeIndex < TYPE_COUNT; ++typeIndex)
+    {
+        const FP8::TYPE type = (FP8::TYPE)(FP8::TYPE_FLOAT8E4M3FN + typeIndex);
+        FP8::Detail::VisitType(type, [&](auto format)
+        {
+            typedef decltype(format) F;
+            // Division overflows to infinity if maxAbs is subnormal.
+            const float scale = autoScale && maxAbs > 0.f ? std::min(F::Max() / maxAbs, FLT_MAX) : 1.f;
+
+            // One call per thread, taking chunks one by one, so buffers are
+            // allocated and statistics merged once per thread, not per chunk.
+            const size_t chunkCount = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+            const uint32_t workerCount = (uint32_t)std::min<size_t>(
+                threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency()), chunkCount);
+            STATISTICS total;
+            std::mutex mutex;
+            std::atomic<size_t> nextChunk(0);
+            FP8::Detail::ParallelFor(workerCount, 1, workerCount, [&](size_t, size_t)
+            {
+                std::vector<float> scaled(scale != 1.f ? CHUNK_SIZE : 0);
+                std::vector<uint8_t> encoded(CHUNK_SIZE);
+                std::vector<float> decoded(CHUNK_SIZE);
+                STATISTICS stats;
+                for(;;)
+                {
+                    const size_t chunkIndex = nextChunk++;
+                    if(chunkIndex >= chunkCount)
+                        break;
+                    const size_t begIndex = chunkIndex * CHUNK_SIZE;
+                    AnalyzeChunk<F>(type, data + begIndex, std::min(CHUNK_SIZE, count - begIndex), scale,
+                        scaled.data(), encoded.data(), decoded.data(), stats);
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                total.Add(stats);
+            });
+
+            const uint64_t finiteNonzeroCount = count - total.NonFiniteCount - total.ZeroCount;
+            const double percent = finiteNonzeroCount ? 100.0 / (double)finiteNonzeroCount : 0.0;
+            printf("%-16s %11.4g %8.3f%% %8.3f%% %8.3f%% %12.4g %12.4g\n", FP8::GetTypeName(type), scale,
+                (double)total.OverflowCount * percent, (double)total.UnderflowCount * percent,
+                (double)total.SubnormalCount * percent,
+                finiteNonzeroCount ? std::sqrt(total.SumSquaredRelativeError / (double)finiteNonzeroCount) : 0.0,
+                total.MaxRelativeError);
+            if(printHistogram)
+                PrintHistogram(total, F::ExponentMax + 1, F::ExponentBias, finiteNonzeroCount);
+        });
+    }
+    printf("Percentages are of finite nonzero values.\n\n");
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    bool autoScale = false;
+    bool printHistogram = false;
+    uint32_t threadCount = 0;
+    int firstFile = 1;
+    for(; firstFile < argc && argv[firstFile][0] == '-'; ++firstFile)
+    {
+        if(strcmp(argv[firstFile], "--auto-scale") == 0)
+            autoScale = true;
+        else if(strcmp(argv[firstFile], "--histogram") == 0)
+            printHistogram = true;
+        else if(strcmp(argv[firstFile], "--threads") == 0 && firstFile + 1 < argc)
+            threadCount = (uint32_t)atoi(argv[++firstFile]);
+        else
+        {
+            printf("Unknown option: %s\n", argv[firstFile]);
+            return 2;
+        }
+    }
+    if(firstFile == argc)
+    {
+        printf("Usage: FP8Analyze [--auto-scale] [--threads N] [--histogram] file...\n");
+        return 2;
+    }
+
+    bool success = true;
+    for(int i = firstFile; i < argc; ++i)
+        success = AnalyzeFile(argv[i], autoScale, printHistogram, threadCount) && success;
+    return success ? 0 : 1;
+}
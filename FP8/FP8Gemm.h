@@ -0,0 +1,553 @@
+/*
+FP8Gemm.h
+
+Author:  Adam Sawicki, https://asawicki.info, adam__REMOVE__@asawicki.info
+Version: 1.0.0, 2026-10-19
+License: Public Domain
+
+Matrix multiplication and batched dot products on CPU, where one or both
+operands are FP8 numbers of any type supported by FP8.h, or float32. Results
+are accumulated and returned in float32.
+
+Operands are never dequantized as a whole. Gemm works on cache-sized blocks:
+for each panel of B (KC x NC) and block of A (MC x KC), it decodes only that
+part to float32, in a layout convenient for the inner kernel, into a buffer
+that stays in L2 cache, then runs inner kernel multiplying 6 rows of A by 16
+(AVX2) or 32 (AVX-512) columns of B using FMA instructions, with all the
+results kept in registers. This way, FP8 data is read from memory only once
+per block, taking 1/4 of the memory bandwidth of float32.
+
+Work is distributed among threads as tasks, each being a group of rows of C
+within one NC-wide column block. A task decodes a panel of B once and reuses
+it for all its blocks of A, so A is decoded once per column block of C and B
+once per group of rows. Groups are as large as possible while still giving
+each thread a few tasks - with one thread, B is decoded only once.
+
+DotBatch calculates dot products of many pairs of vectors, decoding them in
+small pieces that stay in L1 cache.
+
+Instruction set is selected at runtime, like in FP8.h.
+
+How to use it:
+
+1. In any CPP file where you want to use the library:
+   #include "FP8Gemm.h"
+2. In exactly one CPP file, define following macros before that include:
+   #define FP8_IMPLEMENTATION
+   #define FP8_GEMM_IMPLEMENTATION
+3. Describe operands using FP8::MATRIX and call FP8::Gemm or FP8::DotBatch.
+*/
+#pragma once
+
+#include "FP8.h"
+
+namespace FP8
+{
+
+// Describes operand of matrix multiplication stored in memory.
+struct MATRIX
+{
+    // Pointer to element (0, 0). Elements are uint8_t of type Type, or float
+    // if IsFloat32.
+    const void* Data = nullptr;
+    TYPE Type = TYPE_FLOAT8E4M3FN;
+    bool IsFloat32 = false;
+    // Distance between beginnings of consecutive rows (or columns, if
+    // Transposed), in elements.
+    size_t Stride = 0;
+    // If false, element (i, j) is Data[i * Stride + j].
+    // If true, element (i, j) is Data[j * Stride + i].
+    bool Transposed = false;
+};
+
+inline MATRIX MakeMatrix(const uint8_t* data, TYPE type, size_t stride, bool transposed = false)
+{
+    MATRIX m;
+    m.Data = data;
+    m.Type = type;
+    m.Stride = stride;
+    m.Transposed = transposed;
+    return m;
+}
+
+inline MATRIX MakeMatrix(const float* data, size_t stride, bool transposed = false)
+{
+    MATRIX m;
+    m.Data = data;
+    m.IsFloat32 = true;
+    m.Stride = stride;
+    m.Transposed = transposed;
+    return m;
+}
+
+/*
+Calculates C = A * B, or C += A * B if accumulate is true.
+A is m x k, B is k x n, C is m x n float32 matrix with rows cStride elements
+apart. Work is distributed among threadCount threads, including the calling
+one. threadCount = 0 means number of CPU cores.
+Result may differ from the one calculated in double precision by rounding
+errors of float32, depending on the order of additions.
+*/
+void Gemm(size_t m, size_t n, size_t k, const MATRIX& a, const MATRIX& b,
+    float* c, size_t cStride, bool accumulate = false, uint32_t threadCount = 0);
+
+/*
+Same as Gemm, but uses specific instruction set. Instruction set must be
+supported by current CPU - at most the one returned by GetIsa.
+*/
+void GemmIsa(ISA isa, size_t m, size_t n, size_t k, const MATRIX& a, const MATRIX& b,
+    float* c, size_t cStride, bool accumulate = false, uint32_t threadCount = 0);
+
+/*
+Calculates dst[i] = dot(row i of a, row i of b) for i = 0..count-1, where rows
+have length elements. Transposed matrices are not supported here.
+*/
+void DotBatch(size_t count, size_t length, const MATRIX& a, const MATRIX& b,
+    float* dst, uint32_t threadCount = 0);
+
+// Same as DotBatch, but uses specific instruction set.
+void DotBatchIsa(ISA isa, size_t count, size_t length, const MATRIX& a, const MATRIX& b,
+    float* dst, uint32_t threadCount = 0);
+
+} // namespace FP8
+
+// For Visual Studio IntelliSense.
+#ifdef __INTELLISENSE__
+#define FP8_GEMM_IMPLEMENTATION
+#endif
+
+#ifdef FP8_GEMM_IMPLEMENTATION
+#undef FP8_GEMM_IMPLEMENTATION
+
+#include <cassert>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    #define FP8_GEMM_X86 1
+    #include <immintrin.h>
+#else
+    #define FP8_GEMM_X86 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define FP8_GEMM_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define FP8_GEMM_TARGET(isa)
+#endif
+
+namespace FP8
+{
+namespace GemmDetail
+{
+
+/*
+Block sizes. A block of MC x KC floats takes 96 KB and a panel of KC x NC
+floats 256 KB, so both fit in L2 cache of most modern CPUs.
+MC must be a multiple of MR, NC a multiple of every NR.
+*/
+static const size_t MR = 6;
+static const size_t MC = 96;
+static const size_t KC = 256;
+static const size_t NC = 256;
+// Largest NR of all kernels.
+static const size_t MAX_NR = 32;
+// Length of pieces of vectors decoded at once in DotBatch.
+static const size_t DOT_PIECE_LENGTH = 256;
+
+static size_t GetNr(ISA isa)
+{
+    return isa == ISA_AVX512 ? 32 : 16;
+}
+
+// Converts count consecutive elements of m starting from given offset to
+// float32.
+static void DecodeRun(ISA isa, const MATRIX& m, size_t offset, size_t count, float* dst)
+{
+    if(m.IsFloat32)
+        memcpy(dst, (const float*)m.Data + offset, count * sizeof(float));
+    else
+        DecodeArrayIsa(isa, m.Type, (const uint8_t*)m.Data + offset, count, dst);
+}
+
+/*
+Decodes part of operand m to float32 in packed layout: panels of width w
+elements along panel dimension, each storing depthCount steps of w consecutive
+elements. Panel dimension is rows of A or columns of B. Depth dimension is k.
+Panels are padded with zeros to full width.
+For A (isB = false), element at panel index p and depth d is A(p, d).
+For B (isB = true), it is B(d, p).
+*/
+static void Pack(ISA isa, const MATRIX& m, bool isB,
+    size_t panelBeg, size_t panelCount, size_t depthBeg, size_t depthCount, size_t w,
+    float* dst, float* tmp)
+{
+    const size_t paddedPanelCount = (panelCount + w - 1) / w * w;
+    // Elements along panel dimension are consecutive in memory if A is
+    // transposed or B is not.
+    if(isB != m.Transposed)
+    {
+        for(size_t d = 0; d < depthCount; ++d)
+        {
+            const size_t offset = (depthBeg + d) * m.Stride + panelBeg;
+            for(size_t p = 0; p < paddedPanelCount; p += w)
+            {
+                float* const panelDst = dst + p * depthCount + d * w;
+                const size_t runLength = std::min(w, panelCount > p ? panelCount - p : 0);
+                DecodeRun(isa, m, offset + p, runLength, panelDst);
+                for(size_t i = runLength; i < w; ++i)
+                    panelDst[i] = 0.f;
+            }
+        }
+    }
+    else
+    {
+        for(size_t p = 0; p < paddedPanelCount; ++p)
+        {
+            float* const panelDst = dst + (p / w) * w * depthCount + p % w;
+            if(p < panelCount)
+            {
+                DecodeRun(isa, m, (panelBeg + p) * m.Stride + depthBeg, depthCount, tmp);
+                for(size_t d = 0; d < depthCount; ++d)
+                    panelDst[d * w] = tmp[d];
+            }
+            else
+            {
+                for(size_t d = 0; d < depthCount; ++d)
+                    panelDst[d * w] = 0.f;
+            }
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Inner kernels
+
+/*
+Inner kernels calculate MR x NR block of C from packed panels of A (depth x MR)
+and B (depth x NR), overwriting it or adding to it.
+*/
+typedef void (*MicroKernel)(size_t depth, const float* ap, const float* bp, float* c, size_t cStride, bool accumulate);
+
+static void MicroKernel_Scalar(size_t depth, const float* ap, const float* bp, float* c, size_t cStride, bool accumulate)
+{
+    const size_t NR = 16;
+    float acc[MR][NR] = {};
+    for(size_t d = 0; d < depth; ++d)
+    {
+        for(size_t i = 0; i < MR; ++i)
+        {
+            const float a = ap[d * MR + i];
+            for(size_t j = 0; j < NR; ++j)
+                acc[i][j] += a * bp[d * NR + j];
+        }
+    }
+    for(size_t i = 0; i < MR; ++i)
+    {
+        for(size_t j = 0; j < NR; ++j)
+            c[i * cStride + j] = accumulate ? c[i * cStride + j] + acc[i][j] : acc[i][j];
+    }
+}
+
+#if FP8_GEMM_X86
+
+// 12 accumulators of 8 floats: 6 rows x 16 columns.
+FP8_GEMM_TARGET("avx2,fma")
+static void MicroKernel_Avx2(size_t depth, const float* ap, const float* bp, float* c, size_t cStride, bool accumulate)
+{
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+    __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+    __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+    __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+    __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+    __m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+    for(size_t d = 0; d < depth; ++d, ap += MR, bp += 16)
+    {
+        const __m256 b0 = _mm256_loadu_ps(bp);
+        const __m256 b1 = _mm256_loadu_ps(bp + 8);
+        __m256 a = _mm256_broadcast_ss(ap + 0);
+        c00 = _mm256_fmadd_ps(a, b0, c00); c01 = _mm256_fmadd_ps(a, b1, c01);
+        a = _mm256_broadcast_ss(ap + 1);
+        c10 = _mm256_fmadd_ps(a, b0, c10); c11 = _mm256_fmadd_ps(a, b1, c11);
+        a = _mm256_broadcast_ss(ap + 2);
+        c20 = _mm256_fmadd_ps(a, b0, c20); c21 = _mm256_fmadd_ps(a, b1, c21);
+        a = _mm256_broadcast_ss(ap + 3);
+        c30 = _mm256_fmadd_ps(a, b0, c30); c31 = _mm256_fmadd_ps(a, b1, c31);
+        a = _mm256_broadcast_ss(ap + 4);
+        c40 = _mm256_fmadd_ps(a, b0, c40); c41 = _mm256_fmadd_ps(a, b1, c41);
+        a = _mm256_broadcast_ss(ap + 5);
+        c50 = _mm256_fmadd_ps(a, b0, c50); c51 = _mm256_fmadd_ps(a, b1, c51);
+    }
+    const __m256 rows[MR][2] = {
+        { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 }, { c40, c41 }, { c50, c51 } };
+    for(size_t i = 0; i < MR; ++i)
+    {
+        float* const row = c + i * cStride;
+        __m256 r0 = rows[i][0], r1 = rows[i][1];
+        if(accumulate)
+        {
+            r0 = _mm256_add_ps(r0, _mm256_loadu_ps(row));
+            r1 = _mm256_add_ps(r1, _mm256_loadu_ps(row + 8));
+        }
+        _mm256_storeu_ps(row, r0);
+        _mm256_storeu_ps(row + 8, r1);
+    }
+}
+
+// 12 accumulators of 16 floats: 6 rows x 32 columns.
+FP8_GEMM_TARGET("avx512f")
+static void MicroKernel_Avx512(size_t depth, const float* ap, const float* bp, float* c, size_t cStride, bool accumulate)
+{
+    __m512 c00 = _mm512_setzero_ps(), c01 = _mm512_setzero_ps();
+    __m512 c10 = _mm512_setzero_ps(), c11 = _mm512_setzero_ps();
+    __m512 c20 = _mm512_setzero_ps(), c21 = _mm512_setzero_ps();
+    __m512 c30 = _mm512_setzero_ps(), c31 = _mm512_setzero_ps();
+    __m512 c40 = _mm512_setzero_ps(), c41 = _mm512_setzero_ps();
+    __m512 c50 = _mm512_setzero_ps(), c51 = _mm512_setzero_ps();
+    for(size_t d = 0; d < depth; ++d, ap += MR, bp += 32)
+    {
+        const __m512 b0 = _mm512_loadu_ps(bp);
+        const __m512 b1 = _mm512_loadu_ps(bp + 16);
+        __m512 a = _mm512_set1_ps(ap[0]);
+        c00 = _mm512_fmadd_ps(a, b0, c00); c01 = _mm512_fmadd_ps(a, b1, c01);
+        a = _mm512_set1_ps(ap[1]);
+        c10 = _mm512_fmadd_ps(a, b0, c10); c11 = _mm512_fmadd_ps(a, b1, c11);
+        a = _mm512_set1_ps(ap[2]);
+        c20 = _mm512_fmadd_ps(a, b0, c20); c21 = _mm512_fmadd_ps(a, b1, c21);
+        a = _mm512_set1_ps(ap[3]);
+        c30 = _mm512_fmadd_ps(a, b0, c30); c31 = _mm512_fmadd_ps(a, b1, c31);
+        a = _mm512_set1_ps(ap[4]);
+        c40 = _mm512_fmadd_ps(a, b0, c40); c41 = _mm512_fmadd_ps(a, b1, c41);
+        a = _mm512_set1_ps(ap[5]);
+        c50 = _mm512_fmadd_ps(a, b0, c50); c51 = _mm512_fmadd_ps(a, b1, c51);
+    }
+    const __m512 rows[MR][2] = {
+        { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 }, { c40, c41 }, { c50, c51 } };
+    for(size_t i = 0; i < MR; ++i)
+    {
+        float* const row = c + i * cStride;
+        __m512 r0 = rows[i][0], r1 = rows[i][1];
+        if(accumulate)
+        {
+            r0 = _mm512_add_ps(r0, _mm512_loadu_ps(row));
+            r1 = _mm512_add_ps(r1, _mm512_loadu_ps(row + 16));
+        }
+        _mm512_storeu_ps(row, r0);
+        _mm512_storeu_ps(row + 16, r1);
+    }
+}
+
+#endif // #if FP8_GEMM_X86
+
+static MicroKernel GetMicroKernel(ISA isa)
+{
+    switch(isa)
+    {
+#if FP8_GEMM_X86
+    case ISA_AVX2:   return MicroKernel_Avx2;
+    case ISA_AVX512: return MicroKernel_Avx512;
+#endif
+    default:         return MicroKernel_Scalar;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Dot product of float32 vectors
+
+typedef float (*DotKernel)(const float* a, const float* b, size_t length);
+
+static float Dot_Scalar(const float* a, const float* b, size_t length)
+{
+    float sum = 0.f;
+    for(size_t i = 0; i < length; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+#if FP8_GEMM_X86
+
+FP8_GEMM_TARGET("avx2,fma")
+static float Dot_Avx2(const float* a, const float* b, size_t length)
+{
+    // Two accumulators hide latency of FMA.
+    __m256 sum0 = _mm256_setzero_ps(), sum1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for(; i + 16 <= length; i += 16)
+    {
+        sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum0);
+        sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), sum1);
+    }
+    const __m256 sum = _mm256_add_ps(sum0, sum1);
+    __m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+    sum4 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+    sum4 = _mm_add_ss(sum4, _mm_movehdup_ps(sum4));
+    return _mm_cvtss_f32(sum4) + Dot_Scalar(a + i, b + i, length - i);
+}
+
+FP8_GEMM_TARGET("avx512f")
+static float Dot_Avx512(const float* a, const float* b, size_t length)
+{
+    __m512 sum0 = _mm512_setzero_ps(), sum1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for(; i + 32 <= length; i += 32)
+    {
+        sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), sum0);
+        sum1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), sum1);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1)) + Dot_Scalar(a + i, b + i, length - i);
+}
+
+#endif // #if FP8_GEMM_X86
+
+static DotKernel GetDotKernel(ISA isa)
+{
+    switch(isa)
+    {
+#if FP8_GEMM_X86
+    case ISA_AVX2:   return Dot_Avx2;
+    case ISA_AVX512: return Dot_Avx512;
+#endif
+    default:         return Dot_Scalar;
+    }
+}
+
+} // namespace GemmDetail
+
+void GemmIsa(ISA isa, size_t m, size_t n, size_t k, const MATRIX& a, const MATRIX& b,
+    float* c, size_t cStride, bool accumulate, uint32_t threadCount)
+{
+    using namespace GemmDetail;
+    assert(isa <= GetIsa());
+    if(m == 0 || n == 0)
+        return;
+    if(k == 0)
+    {
+        if(!accumulate)
+        {
+            for(size_t i = 0; i < m; ++i)
+                memset(c + i * cStride, 0, n * sizeof(float));
+        }
+        return;
+    }
+
+    const size_t nr = GetNr(isa);
+    const MicroKernel microKernel = GetMicroKernel(isa);
+    const size_t mBlockCount = (m + MC - 1) / MC;
+    const size_t nBlockCount = (n + NC - 1) / NC;
+    if(threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    // Each task is a group of MC x NC blocks of C in one column block,
+    // calculated over whole k. About 4 tasks per thread balance the load.
+    const size_t desiredGroupCount = std::min(mBlockCount,
+        std::max<size_t>(1, (threadCount * 4 + nBlockCount - 1) / nBlockCount));
+    const size_t groupBlockCount = (mBlockCount + desiredGroupCount - 1) / desiredGroupCount;
+    const size_t groupCount = (mBlockCount + groupBlockCount - 1) / groupBlockCount;
+    const size_t taskCount = groupCount * nBlockCount;
+
+    // One call per thread, taking tasks one by one, so buffers are allocated
+    // once per thread, not per task.
+    const uint32_t workerCount = (uint32_t)std::min<size_t>(threadCount, taskCount);
+    std::atomic<size_t> nextTask(0);
+    Detail::ParallelFor(workerCount, 1, workerCount, [&](size_t, size_t)
+    {
+        std::vector<float> aPacked(MC * KC);
+        std::vector<float> bPacked(KC * NC);
+        std::vector<float> tmp(std::max(KC, NC));
+        float edge[MR * MAX_NR];
+
+        for(;;)
+        {
+            const size_t task = nextTask++;
+            if(task >= taskCount)
+                break;
+            const size_t groupBeg = task / nBlockCount * groupBlockCount * MC;
+            const size_t groupEnd = std::min(m, groupBeg + groupBlockCount * MC);
+            const size_t nBeg = task % nBlockCount * NC;
+            const size_t nCount = std::min(NC, n - nBeg);
+
+            for(size_t kBeg = 0; kBeg < k; kBeg += KC)
+            {
+                const size_t kCount = std::min(KC, k - kBeg);
+                const bool accumulateBlock = accumulate || kBeg > 0;
+                Pack(isa, b, true, nBeg, nCount, kBeg, kCount, nr, bPacked.data(), tmp.data());
+
+                for(size_t mBeg = groupBeg; mBeg < groupEnd; mBeg += MC)
+                {
+                    const size_t mCount = std::min(MC, groupEnd - mBeg);
+                    Pack(isa, a, false, mBeg, mCount, kBeg, kCount, MR, aPacked.data(), tmp.data());
+
+                    for(size_t j = 0; j < nCount; j += nr)
+                    {
+                        const float* const bp = bPacked.data() + j * kCount;
+                        const size_t jCount = std::min(nr, nCount - j);
+                        for(size_t i = 0; i < mCount; i += MR)
+                        {
+                            const float* const ap = aPacked.data() + i * kCount;
+                            const size_t iCount = std::min(MR, mCount - i);
+                            float* const cBlock = c + (mBeg + i) * cStride + nBeg + j;
+                            if(iCount == MR && jCount == nr)
+                            {
+                                microKernel(kCount, ap, bp, cBlock, cStride, accumulateBlock);
+                                continue;
+                            }
+                            // Partial block on the edge of C goes through a
+                            // temporary buffer.
+                            microKernel(kCount, ap, bp, edge, nr, false);
+                            for(size_t ii = 0; ii < iCount; ++ii)
+                            {
+                                for(size_t jj = 0; jj < jCount; ++jj)
+                                {
+                                    float& dst = cBlock[ii * cStride + jj];
+                                    dst = accumulateBlock ? dst + edge[ii * nr + jj] : edge[ii * nr + jj];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    });
+}
+
+void Gemm(size_t m, size_t n, size_t k, const MATRIX& a, const MATRIX& b,
+    float* c, size_t cStride, bool accumulate, uint32_t threadCount)
+{
+    GemmIsa(GetIsa(), m, n, k, a, b, c, cStride, accumulate, threadCount);
+}
+
+void DotBatchIsa(ISA isa, size_t count, size_t length, const MATRIX& a, const MATRIX& b,
+    float* dst, uint32_t threadCount)
+{
+    using namespace GemmDetail;
+    assert(isa <= GetIsa());
+    assert(!a.Transposed && !b.Transposed);
+    const DotKernel dotKernel = GetDotKernel(isa);
+    // Enough rows in a chunk to make the cost of taking it negligible.
+    const size_t chunkSize = std::max<size_t>(1, 65536 / std::max<size_t>(length, 1));
+    Detail::ParallelFor(count, chunkSize, threadCount, [&](size_t begIndex, size_t endIndex)
+    {
+        float aPiece[DOT_PIECE_LENGTH];
+        float bPiece[DOT_PIECE_LENGTH];
+        for(size_t i = begIndex; i < endIndex; ++i)
+        {
+            float sum = 0.f;
+            for(size_t pieceBeg = 0; pieceBeg < length; pieceBeg += DOT_PIECE_LENGTH)
+            {
+                const size_t pieceLength = std::min(DOT_PIECE_LENGTH, length - pieceBeg);
+                DecodeRun(isa, a, i * a.Stride + pieceBeg, pieceLength, aPiece);
+                DecodeRun(isa, b, i * b.Stride + pieceBeg, pieceLength, bPiece);
+                sum += dotKernel(aPiece, bPiece, pieceLength);
+            }
+            dst[i] = sum;
+        }
+    });
+}
+
+void DotBatch(size_t count, size_t length, const MATRIX& a, const MATRIX& b,
+    float* dst, uint32_t threadCount)
+{
+    DotBatchIsa(GetIsa(), count, length, a, b, dst, threadCount);
+}
+
+} // namespace FP8
+
+#endif // #ifdef FP8_GEMM_IMPLEMENTATION
@@ -0,0 +1,641 @@
+/*
+FP8Tensor.h
+
+Author:  Adam Sawicki, https://asawicki.info, adam__REMOVE__@asawicki.info
+Version: 1.0.0, 2026-10-19
+License: Public Domain
+
+Simple file format for tensors of FP8 numbers, loaded with memory mapping
+(mmap on Linux, file mapping on Windows) without copying or converting
+anything, so opening a file of any size takes constant time and memory. Pages
+are read from disk by the operating system only when touched.
+
+File layout, all numbers little-endian:
+
+- TENSOR_FILE_HEADER - 128 bytes: magic "FP8T", version, FP8 type with the
+  same values as class FP8Type in fp8_tables.py, shape of up to 8 dimensions,
+  and offsets of the following parts.
+- Scales - one float32 per block of ScaleBlockSize consecutive elements, or
+  none if ScaleBlockSize is 0. Element i has value
+  Decode(Type, payload[i]) * scales[i / ScaleBlockSize].
+- Payload - FP8 elements in row-major order (last dimension is contiguous),
+  starting at an offset aligned to TENSOR_PAYLOAD_ALIGNMENT.
+
+TensorView presents the tensor as a 2D matrix of float32 - all dimensions but
+the last are rows, the last one is columns - and dequantizes it lazily, in
+tiles, only where it is accessed. A bounded number of most recently used tiles
+is kept in memory. When the limit is reached, buffer of the least recently
+used tile is reused for the new one, so memory usage stays constant.
+
+How to use it:
+
+1. In any CPP file where you want to use the library:
+   #include "FP8Tensor.h"
+2. In exactly one CPP file, define following macros before that include:
+   #define FP8_IMPLEMENTATION
+   #define FP8_TENSOR_IMPLEMENTATION
+3. Create a file using FP8::WriteTensorFile or FP8::QuantizeTensorFile.
+   Open it with FP8::TensorFile and read it through FP8::TensorView.
+*/
+#pragma once
+
+#include "FP8.h"
+
+#include <list>
+#include <unordered_map>
+
+namespace FP8
+{
+
+// "FP8T" read as little-endian uint32_t.
+static const uint32_t TENSOR_FILE_MAGIC = 0x54385046u;
+static const uint32_t TENSOR_FILE_VERSION = 1;
+static const uint32_t TENSOR_MAX_DIMENSIONS = 8;
+// Payload is aligned to page size, so it can be mapped separately and
+// vector loads from it don't cross page boundaries unnecessarily.
+static const uint64_t TENSOR_PAYLOAD_ALIGNMENT = 4096;
+
+struct TENSOR_FILE_HEADER
+{
+    uint32_t Magic; // TENSOR_FILE_MAGIC
+    uint32_t Version; // TENSOR_FILE_VERSION
+    uint32_t Type; // FP8::TYPE, same values as class FP8Type in fp8_tables.py.
+    uint32_t DimensionCount; // 1..TENSOR_MAX_DIMENSIONS
+    // Sizes of dimensions, from the outermost. Unused ones are 0.
+    uint64_t Shape[TENSOR_MAX_DIMENSIONS];
+    // Number of consecutive elements sharing one scale, or 0 if there are no scales.
+    uint64_t ScaleBlockSize;
+    // Offset of scales from the beginning of the file, in bytes.
+    uint64_t ScaleOffset;
+    uint64_t ScaleCount;
+    // Offset of payload from the beginning of the file, in bytes.
+    uint64_t PayloadOffset;
+    // Size of payload in bytes, equal to number of elements.
+    uint64_t PayloadSize;
+    uint64_t Reserved;
+};
+static_assert(sizeof(TENSOR_FILE_HEADER) == 128, "");
+
+/*
+Writes tensor file from FP8 data already encoded. data has the number of
+elements given by shape. If scaleBlockSize is not 0, scales has one value for
+every scaleBlockSize elements, with the last block possibly shorter.
+Returns false if the file couldn't be written.
+*/
+bool WriteTensorFile(const char* path, TYPE type, const uint64_t* shape, uint32_t dimensionCount,
+    const uint8_t* data, const float* scales, uint64_t scaleBlockSize);
+
+/*
+Quantizes float32 data to FP8 and writes it as tensor file. Scale of every
+block of scaleBlockSize elements is its largest magnitude divided by the
+largest finite value of the type, so the whole range of the format is used.
+Blocks of zeros, infinities or NaN get scale 1. With scaleBlockSize = 0, data
+is encoded as is, saturating values out of range. Encoding is done in parts,
+using threadCount threads (0 = number of CPU cores), so the whole FP8 payload
+is never kept in memory.
+Returns false if the file couldn't be written.
+*/
+bool QuantizeTensorFile(const char* path, TYPE type, const uint64_t* shape, uint32_t dimensionCount,
+    const float* data, uint64_t scaleBlockSize, uint32_t threadCount = 0);
+
+// Read-only memory mapping of a whole file.
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    // Returns false if the file couldn't be opened or is empty.
+    bool Open(const char* path);
+    void Close();
+    bool IsOpened() const { return m_Data != nullptr; }
+
+    const uint8_t* GetData() const { return m_Data; }
+    uint64_t GetSize() const { return m_Size; }
+
+private:
+    const uint8_t* m_Data;
+    uint64_t m_Size;
+#ifdef _WIN32
+    void* m_FileHandle;
+    void* m_MappingHandle;
+#endif
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+};
+
+// Tensor file opened using memory mapping.
+class TensorFile
+{
+public:
+    TensorFile() { }
+
+    /*
+    Returns false if the file couldn't be opened or it is not a valid tensor
+    file: wrong magic or version, unknown type, or header describing data
+    that doesn't fit in the file.
+    */
+    bool Open(const char* path);
+    void Close();
+    bool IsOpened() const { return m_File.IsOpened(); }
+
+    const TENSOR_FILE_HEADER& GetHeader() const { return *(const TENSOR_FILE_HEADER*)m_File.GetData(); }
+    TYPE GetType() const { return (TYPE)GetHeader().Type; }
+    uint32_t GetDimensionCount() const { return GetHeader().DimensionCount; }
+    uint64_t GetShape(uint32_t dimension) const { return GetHeader().Shape[dimension]; }
+    uint64_t GetElementCount() const { return GetHeader().PayloadSize; }
+    // FP8 elements, pointing directly to the mapped file.
+    const uint8_t* GetData() const { return m_File.GetData() + GetHeader().PayloadOffset; }
+    uint64_t GetScaleBlockSize() const { return GetHeader().ScaleBlockSize; }
+    // Returns null if the file has no scales.
+    const float* GetScales() const
+    {
+        return GetHeader().ScaleBlockSize ? (const float*)(m_File.GetData() + GetHeader().ScaleOffset) : nullptr;
+    }
+    // Returns scale of given element, 1 if the file has no scales.
+    float GetScale(uint64_t elementIndex) const
+    {
+        return GetHeader().ScaleBlockSize ? GetScales()[elementIndex / GetHeader().ScaleBlockSize] : 1.f;
+    }
+
+    // Converts count elements starting from elementIndex to float32, applying scales.
+    void Dequantize(uint64_t elementIndex, size_t count, float* dst) const;
+
+private:
+    MappedFile m_File;
+};
+
+/*
+View of a tensor file as a 2D matrix of float32 values, dequantized lazily in
+tiles of tileRowCount x tileColumnCount elements. Up to maxTileCount of the most
+recently used tiles are kept in memory.
+
+It is not thread-safe. Use a separate view in each thread - many views can
+share one TensorFile.
+*/
+class TensorView
+{
+public:
+    TensorView(const TensorFile& file, size_t maxTileCount = 256, uint32_t tileRowCount = 64,
+        uint32_t tileColumnCount = 256);
+
+    // Product of all dimensions except the last.
+    uint64_t GetRowCount() const { return m_RowCount; }
+    // Last dimension.
+    uint64_t GetColumnCount() const { return m_ColumnCount; }
+    uint32_t GetTileRowCount() const { return m_TileRowCount; }
+    uint32_t GetTileColumnCount() const { return m_TileColumnCount; }
+
+    /*
+    Returns tile (tileRowIndex, tileColumnIndex): tileRowCount rows of
+    tileColumnCount float32 values, starting from element
+    (tileRowIndex * tileRowCount, tileColumnIndex * tileColumnCount). In tiles
+    at the edges, elements outside of the matrix are undefined. Pointer stays
+    valid until the tile is evicted, which may happen on any following call to
+    GetTile, Get or Read.
+    */
+    const float* GetTile(uint64_t tileRowIndex, uint64_t tileColumnIndex);
+    float Get(uint64_t row, uint64_t column);
+    // Copies rowCount x columnCount elements starting from (row, column) to dst,
+    // with rows dstStride elements apart.
+    void Read(uint64_t row, uint64_t column, uint64_t rowCount, uint64_t columnCount, float* dst, size_t dstStride);
+
+    // Statistics of GetTile calls.
+    uint64_t GetTileHitCount() const { return m_TileHitCount; }
+    uint64_t GetTileMissCount() const { return m_TileMissCount; }
+
+private:
+    struct TILE
+    {
+        uint64_t Key;
+        std::vector<float> Data;
+    };
+    typedef std::list<TILE> TileList;
+
+    const TensorFile& m_File;
+    const size_t m_MaxTileCount;
+    const uint32_t m_TileRowCount;
+    const uint32_t m_TileColumnCount;
+    uint64_t m_RowCount;
+    uint64_t m_ColumnCount;
+    uint64_t m_TilesPerRow;
+    // Most recently used first.
+    TileList m_Tiles;
+    std::unordered_map<uint64_t, TileList::iterator> m_TileMap;
+    uint64_t m_TileHitCount = 0;
+    uint64_t m_TileMissCount = 0;
+
+    void LoadTile(uint64_t tileRowIndex, uint64_t tileColumnIndex, float* dst) const;
+};
+
+} // namespace FP8
+
+// For Visual Studio IntelliSense.
+#ifdef __INTELLISENSE__
+#define FP8_TENSOR_IMPLEMENTATION
+#endif
+
+#ifdef FP8_TENSOR_IMPLEMENTATION
+#undef FP8_TENSOR_IMPLEMENTATION
+
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace FP8
+{
+
+namespace Detail
+{
+
+// Returns false if the product overflows uint64_t.
+static bool GetTensorElementCount(const uint64_t* shape, uint32_t dimensionCount, uint64_t& outCount)
+{
+    outCount = 1;
+    for(uint32_t i = 0; i < dimensionCount; ++i)
+    {
+        if(shape[i] != 0 && outCount > UINT64_MAX / shape[i])
+            return false;
+        outCount *= shape[i];
+    }
+    return true;
+}
+
+static TENSOR_FILE_HEADER MakeTensorFileHeader(TYPE type, const uint64_t* shape, uint32_t dimensionCount,
+    uint64_t elementCount, uint64_t scaleBlockSize)
+{
+    TENSOR_FILE_HEADER header = {};
+    header.Magic = TENSOR_FILE_MAGIC;
+    header.Version = TENSOR_FILE_VERSION;
+    header.Type = (uint32_t)type;
+    header.DimensionCount = dimensionCount;
+    for(uint32_t i = 0; i < dimensionCount; ++i)
+        header.Shape[i] = shape[i];
+    header.ScaleBlockSize = scaleBlockSize;
+    header.ScaleOffset = sizeof(TENSOR_FILE_HEADER);
+    header.ScaleCount = scaleBlockSize ? (elementCount + scaleBlockSize - 1) / scaleBlockSize : 0;
+    const uint64_t scaleEnd = header.ScaleOffset + header.ScaleCount * sizeof(float);
+    header.PayloadOffset = (scaleEnd + TENSOR_PAYLOAD_ALIGNMENT - 1) / TENSOR_PAYLOAD_ALIGNMENT * TENSOR_PAYLOAD_ALIGNMENT;
+    header.PayloadSize = elementCount;
+    return header;
+}
+
+// Writes header, scales and padding up to the payload.
+static bool WriteTensorFileBeginning(FILE* file, const TENSOR_FILE_HEADER& header, const float* scales)
+{
+    if(fwrite(&header, sizeof(header), 1, file) != 1)
+        return false;
+    if(header.ScaleCount > 0 && fwrite(scales, sizeof(float), (size_t)header.ScaleCount, file) != header.ScaleCount)
+        return false;
+    const size_t paddingSize = (size_t)(header.PayloadOffset - header.ScaleOffset - header.ScaleCount * sizeof(float));
+    const std::vector<uint8_t> padding(paddingSize);
+    return paddingSize == 0 || fwrite(padding.data(), 1, paddingSize, file) == paddingSize;
+}
+
+} // namespace Detail
+
+bool WriteTensorFile(const char* path, TYPE type, const uint64_t* shape, uint32_t dimensionCount,
+    const uint8_t* data, const float* scales, uint64_t scaleBlockSize)
+{
+    assert(dimensionCount >= 1 && dimensionCount <= TENSOR_MAX_DIMENSIONS);
+    assert(scaleBlockSize == 0 || scales != nullptr);
+    uint64_t elementCount;
+    if(!Detail::GetTensorElementCount(shape, dimensionCount, elementCount))
+        return false;
+    const TENSOR_FILE_HEADER header = Detail::MakeTensorFileHeader(type, shape, dimensionCount, elementCount, scaleBlockSize);
+
+    FILE* file = fopen(path, "wb");
+    if(!file)
+        return false;
+    bool success = Detail::WriteTensorFileBeginning(file, header, scales) &&
+        fwrite(data, 1, (size_t)elementCount, file) == elementCount;
+    success = fclose(file) == 0 && success;
+    return success;
+}
+
+bool QuantizeTensorFile(const char* path, TYPE type, const uint64_t* shape, uint32_t dimensionCount,
+    const float* data, uint64_t scaleBlockSize, uint32_t threadCount)
+{
+    assert(dimensionCount >= 1 && dimensionCount <= TENSOR_MAX_DIMENSIONS);
+    uint64_t elementCount;
+    if(!Detail::GetTensorElementCount(shape, dimensionCount, elementCount))
+        return false;
+    const TENSOR_FILE_HEADER header = Detail::MakeTensorFileHeader(type, shape, dimensionCount, elementCount, scaleBlockSize);
+
+    float maxValue = 0.f;
+    Detail::VisitType(type, [&](auto format) { maxValue = decltype(format)::Max(); });
+
+    std::vector<float> scales((size_t)header.ScaleCount);
+    Detail::ParallelFor(scales.size(), 1024, threadCount, [&](size_t begIndex, size_t endIndex)
+    {
+        for(size_t scaleIndex = begIndex; scaleIndex < endIndex; ++scaleIndex)
+        {
+            const uint64_t begElement = scaleIndex * scaleBlockSize;
+            const uint64_t endElement = std::min(begElement + scaleBlockSize, elementCount);
+            float maxAbs = 0.f;
+            for(uint64_t i = begElement; i < endElement; ++i)
+                maxAbs = std::max(maxAbs, std::abs(data[i]));
+            // Comparison is false for NaN. Scale of a block of subnormals would
+            // underflow to 0 or lose precision, so it is clamped to FLT_MIN.
+            scales[scaleIndex] = maxAbs > 0.f && maxAbs <= FLT_MAX ? std::max(maxAbs / maxValue, FLT_MIN) : 1.f;
+        }
+    });
+
+    FILE* file = fopen(path, "wb");
+    if(!file)
+        return false;
+    bool success = Detail::WriteTensorFileBeginning(file, header, scales.data());
+
+    // 16 MB of float32 in each part, encoded by all threads, then written.
+    const size_t partSize = (size_t)1 << 22;
+    const size_t chunkSize = 65536;
+    std::vector<float> scaled(partSize);
+    std::vector<uint8_t> encoded(partSize);
+    for(uint64_t partBeg = 0; success && partBeg < elementCount; partBeg += partSize)
+    {
+        const size_t partCount = (size_t)std::min<uint64_t>(partSize, elementCount - partBeg);
+        Detail::ParallelFor(partCount, chunkSize, threadCount, [&](size_t begIndex, size_t endIndex)
+        {
+            const float* src = data + partBeg + begIndex;
+            if(scaleBlockSize > 0)
+            {
+                for(size_t i = begIndex; i < endIndex; ++i)
+                    scaled[i] = data[partBeg + i] / scales[(size_t)((partBeg + i) / scaleBlockSize)];
+                src = scaled.data() + begIndex;
+            }
+            EncodeArray(type, src, endIndex - begIndex, encoded.data() + begIndex);
+        });
+        success = fwrite(encoded.data(), 1, partCount, file) == partCount;
+    }
+
+    success = fclose(file) == 0 && success;
+    return success;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// MappedFile
+
+MappedFile::MappedFile() :
+    m_Data(nullptr),
+    m_Size(0)
+#ifdef _WIN32
+    , m_FileHandle(INVALID_HANDLE_VALUE),
+    m_MappingHandle(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const char* path)
+{
+    Close();
+    m_FileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(m_FileHandle == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    if(GetFileSizeEx(m_FileHandle, &size) && size.QuadPart > 0)
+    {
+        m_MappingHandle = CreateFileMappingA(m_FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(m_MappingHandle)
+        {
+            m_Data = (const uint8_t*)MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0);
+            m_Size = (uint64_t)size.QuadPart;
+        }
+    }
+    if(!m_Data)
+        Close();
+    return m_Data != nullptr;
+}
+
+void MappedFile::Close()
+{
+    if(m_Data)
+        UnmapViewOfFile(m_Data);
+    if(m_MappingHandle)
+        CloseHandle(m_MappingHandle);
+    if(m_FileHandle != INVALID_HANDLE_VALUE)
+        CloseHandle(m_FileHandle);
+    m_Data = nullptr;
+    m_Size = 0;
+    m_MappingHandle = nullptr;
+    m_FileHandle = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool MappedFile::Open(const char* path)
+{
+    Close();
+    const int fd = open(path, O_RDONLY);
+    if(fd < 0)
+        return false;
+    struct stat st;
+    if(fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        void* const data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if(data != MAP_FAILED)
+        {
+            m_Data = (const uint8_t*)data;
+            m_Size = (uint64_t)st.st_size;
+        }
+    }
+    // Mapping stays valid after closing the file descriptor.
+    close(fd);
+    return m_Data != nullptr;
+}
+
+void MappedFile::Close()
+{
+    if(m_Data)
+        munmap((void*)m_Data, (size_t)m_Size);
+    m_Data = nullptr;
+    m_Size = 0;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// TensorFile
+
+bool TensorFile::Open(const char* path)
+{
+    if(!m_File.Open(path))
+        return false;
+
+    const uint64_t fileSize = m_File.GetSize();
+    bool valid = fileSize >= sizeof(TENSOR_FILE_HEADER);
+    if(valid)
+    {
+        const TENSOR_FILE_HEADER& h = GetHeader();
+        uint64_t elementCount = 0;
+        valid = h.Magic == TENSOR_FILE_MAGIC &&
+            h.Version == TENSOR_FILE_VERSION &&
+            h.Type >= TYPE_FLOAT8E4M3FN && h.Type <= TYPE_FLOAT8E5M2FNUZ &&
+            h.DimensionCount >= 1 && h.DimensionCount <= TENSOR_MAX_DIMENSIONS &&
+            Detail::GetTensorElementCount(h.Shape, h.DimensionCount, elementCount) &&
+            h.PayloadSize == elementCount &&
+            h.PayloadOffset <= fileSize && h.PayloadSize <= fileSize - h.PayloadOffset;
+        if(valid && h.ScaleBlockSize > 0)
+        {
+            valid = h.ScaleCount == (elementCount + h.ScaleBlockSize - 1) / h.ScaleBlockSize &&
+                h.ScaleOffset % sizeof(float) == 0 &&
+                h.ScaleOffset <= fileSize && h.ScaleCount <= (fileSize - h.ScaleOffset) / sizeof(float);
+        }
+    }
+
+    if(!valid)
+        m_File.Close();
+    return valid;
+}
+
+void TensorFile::Close()
+{
+    m_File.Close();
+}
+
+void TensorFile::Dequantize(uint64_t elementIndex, size_t count, float* dst) const
+{
+    assert(elementIndex + count <= GetElementCount());
+    const uint64_t scaleBlockSize = GetScaleBlockSize();
+    if(scaleBlockSize == 0)
+    {
+        DecodeArray(GetType(), GetData() + elementIndex, count, dst);
+        return;
+    }
+    // Split at boundaries of scale blocks.
+    const float* const scales = GetScales();
+    while(count > 0)
+    {
+        const uint64_t scaleIndex = elementIndex / scaleBlockSize;
+        const size_t partCount = (size_t)std::min<uint64_t>(count, (scaleIndex + 1) * scaleBlockSize - elementIndex);
+        DecodeArray(GetType(), GetData() + elementIndex, partCount, dst);
+        const float scale = scales[scaleIndex];
+        for(size_t i = 0; i < partCount; ++i)
+            dst[i] *= scale;
+        elementIndex += partCount;
+        dst += partCount;
+        count -= partCount;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// TensorView
+
+TensorView::TensorView(const TensorFile& file, size_t maxTileCount, uint32_t tileRowCount, uint32_t tileColumnCount) :
+    m_File(file),
+    m_MaxTileCount(std::max<size_t>(maxTileCount, 1)),
+    m_TileRowCount(tileRowCount),
+    m_TileColumnCount(tileColumnCount)
+{
+    assert(file.IsOpened() && tileRowCount > 0 && tileColumnCount > 0);
+    const uint32_t dimensionCount = file.GetDimensionCount();
+    m_ColumnCount = file.GetShape(dimensionCount - 1);
+    m_RowCount = m_ColumnCount ? file.GetElementCount() / m_ColumnCount : 0;
+    m_TilesPerRow = (m_ColumnCount + tileColumnCount - 1) / tileColumnCount;
+}
+
+void TensorView::LoadTile(uint64_t tileRowIndex, uint64_t tileColumnIndex, float* dst) const
+{
+    const uint64_t begRow = tileRowIndex * m_TileRowCount;
+    const uint64_t begColumn = tileColumnIndex * m_TileColumnCount;
+    const uint64_t rowCount = std::min<uint64_t>(m_TileRowCount, m_RowCount - begRow);
+    const size_t columnCount = (size_t)std::min<uint64_t>(m_TileColumnCount, m_ColumnCount - begColumn);
+    for(uint64_t r = 0; r < rowCount; ++r)
+        m_File.Dequantize((begRow + r) * m_ColumnCount + begColumn, columnCount, dst + r * m_TileColumnCount);
+}
+
+const float* TensorView::GetTile(uint64_t tileRowIndex, uint64_t tileColumnIndex)
+{
+    assert(tileRowIndex * m_TileRowCount < m_RowCount && tileColumnIndex < m_TilesPerRow);
+    const uint64_t key = tileRowIndex * m_TilesPerRow + tileColumnIndex;
+
+    // Most recently used tile is checked first, as it is the most common case.
+    if(!m_Tiles.empty() && m_Tiles.front().Key == key)
+    {
+        ++m_TileHitCount;
+        return m_Tiles.front().Data.data();
+    }
+    auto it = m_TileMap.find(key);
+    if(it != m_TileMap.end())
+    {
+        ++m_TileHitCount;
+        m_Tiles.splice(m_Tiles.begin(), m_Tiles, it->second);
+        return m_Tiles.front().Data.data();
+    }
+
+    ++m_TileMissCount;
+    if(m_Tiles.size() < m_MaxTileCount)
+    {
+        m_Tiles.push_front(TILE());
+        m_Tiles.front().Data.resize((size_t)m_TileRowCount * m_TileColumnCount);
+    }
+    else
+    {
+        // Reuse buffer of the least recently used tile.
+        m_TileMap.erase(m_Tiles.back().Key);
+        m_Tiles.splice(m_Tiles.begin(), m_Tiles, std::prev(m_Tiles.end()));
+    }
+    TILE& tile = m_Tiles.front();
+    tile.Key = key;
+    m_TileMap[key] = m_Tiles.begin();
+    LoadTile(tileRowIndex, tileColumnIndex, tile.Data.data());
+    return tile.Data.data();
+}
+
+float TensorView::Get(uint64_t row, uint64_t column)
+{
+    assert(row < m_RowCount && column < m_ColumnCount);
+    const float* const tile = GetTile(row / m_TileRowCount, column / m_TileColumnCount);
+    return tile[(row % m_TileRowCount) * m_TileColumnCount + column % m_TileColumnCount];
+}
+
+void TensorView::Read(uint64_t row, uint64_t column, uint64_t rowCount, uint64_t columnCount, float* dst, size_t dstStride)
+{
+    assert(row + rowCount <= m_RowCount && column + columnCount <= m_ColumnCount);
+    if(rowCount == 0 || columnCount == 0)
+        return;
+    // Tile by tile, so each one is needed only once, even if the cache is small.
+    const uint64_t endRow = row + rowCount;
+    const uint64_t endColumn = column + columnCount;
+    for(uint64_t tileRow = row / m_TileRowCount; tileRow <= (endRow - 1) / m_TileRowCount; ++tileRow)
+    {
+        const uint64_t begR = std::max(row, tileRow * m_TileRowCount);
+        const uint64_t endR = std::min(endRow, (tileRow + 1) * m_TileRowCount);
+        for(uint64_t tileColumn = column / m_TileColumnCount; tileColumn <= (endColumn - 1) / m_TileColumnCount; ++tileColumn)
+        {
+            const uint64_t begC = std::max(column, tileColumn * m_TileColumnCount);
+            const uint64_t endC = std::min(endColumn, (tileColumn + 1) * m_TileColumnCount);
+            const float* const tile = GetTile(tileRow, tileColumn);
+            for(uint64_t r = begR; r < endR; ++r)
+            {
+                memcpy(dst + (r - row) * dstStride + (begC - column),
+                    tile + (r - tileRow * m_TileRowCount) * m_TileColumnCount + (begC - tileColumn * m_TileColumnCount),
+                    (size_t)(endC - begC) * sizeof(float));
+            }
+        }
+    }
+}
+
+} // namespace FP8
+
+#endif // #ifdef FP8_TENSOR_IMPLEMENTATION
@@ -0,0 +1,519 @@
+/*
+FP8Verify.cpp
+
+Author:  Adam Sawicki, https://asawicki.info, adam__REMOVE__@asawicki.info
+Version: 1.0.0, 2026-10-19
+License: Public Domain
+
+Checks of edge cases of the FP8 library that are easy to break and hard to
+notice on typical data. Each case prints PASSED or FAILED with the first wrong
+value. Returns 0 if all passed.
+
+EncodeArrayExhaustive compares EncodeArray of every supported instruction set
+with Encode on all 2^32 float32 values, for every type and overflow mode. It
+uses all CPU cores and takes a few minutes.
+
+Stochastic rounding is checked statistically: in every gap between two
+consecutive positive FP8 values, the frequency of rounding up must match the
+position of the input within the gap. Random inputs are also checked to give
+the same results for any number of threads and any instruction set.
+
+Usage:
+    FP8Verify
+
+It writes a temporary file FP8Verify.tmp in current directory.
+
+Build, e.g.:
+    g++ -O2 -pthread FP8Verify.cpp
+*/
+#define FP8_IMPLEMENTATION
+#define FP8_TENSOR_IMPLEMENTATION
+#include "FP8Tensor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static const char* const TEMP_FILE_PATH = "FP8Verify.tmp";
+
+static const FP8::TYPE TYPES[] = {
+    FP8::TYPE_FLOAT8E4M3FN,
+    FP8::TYPE_FLOAT8E4M3FNUZ,
+    FP8::TYPE_FLOAT8E5M2,
+    FP8::TYPE_FLOAT8E5M2FNUZ,
+};
+static const size_t TYPE_COUNT = sizeof(TYPES) / sizeof(TYPES[0]);
+
+static const FP8::OVERFLOW_MODE OVERFLOW_MODES[] = {
+    FP8::OVERFLOW_MODE_SATURATE,
+    FP8::OVERFLOW_MODE_INF_OR_NAN,
+};
+static const size_t OVERFLOW_MODE_COUNT = sizeof(OVERFLOW_MODES) / sizeof(OVERFLOW_MODES[0]);
+
+static const char* GetOverflowModeName(FP8::OVERFLOW_MODE overflowMode)
+{
+    return overflowMode == FP8::OVERFLOW_MODE_SATURATE ? "SATURATE" : "INF_OR_NAN";
+}
+
+static float BitsToFloat(uint32_t bits)
+{
+    float result;
+    memcpy(&result, &bits, sizeof(float));
+    return result;
+}
+
+/*
+Calls func(begIndex, endIndex) for chunks of 0..count on all CPU cores, like
+FP8::Detail::ParallelFor, but with one call of makeWorker per thread, which
+returns func with buffers of that thread.
+*/
+template<typename MakeWorker>
+static void ParallelForWorkers(size_t count, size_t chunkSize, const MakeWorker& makeWorker)
+{
+    const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+    const uint32_t workerCount = (uint32_t)std::min<size_t>(
+        std::max(1u, std::thread::hardware_concurrency()), chunkCount);
+    std::atomic<size_t> nextChunk(0);
+    FP8::Detail::ParallelFor(workerCount, 1, workerCount, [&](size_t, size_t)
+    {
+        auto func = makeWorker();
+        for(;;)
+        {
+            const size_t chunkIndex = nextChunk++;
+            if(chunkIndex >= chunkCount)
+                break;
+            const size_t begIndex = chunkIndex * chunkSize;
+            func(begIndex, std::min(begIndex + chunkSize, count));
+        }
+    });
+}
+
+/*
+EncodeArray of every instruction set supported by the CPU against Encode, which
+is the reference, on all 2^32 float32 values including NaNs, infinities, zeros
+and subnormals, for every type and overflow mode.
+*/
+static bool VerifyEncodeArrayExhaustive()
+{
+    const size_t chunkSize = 65536;
+    const uint32_t isaCount = (uint32_t)FP8::GetIsa() + 1;
+    // Smallest wrong input for each ISA, type and overflow mode, shifted left by
+    // 8 bits, with the wrong code in the low 8 bits. UINT64_MAX if none.
+    std::vector<uint64_t> firstWrong(isaCount * TYPE_COUNT * OVERFLOW_MODE_COUNT, UINT64_MAX);
+    std::mutex mutex;
+    ParallelForWorkers((size_t)1 << 32, chunkSize, [&]()
+    {
+        return [&, src = std::vector<float>(chunkSize), expected = std::vector<uint8_t>(chunkSize),
+            actual = std::vector<uint8_t>(chunkSize)](size_t begIndex, size_t endIndex) mutable
+        {
+            const size_t count = endIndex - begIndex;
+            for(size_t i = 0; i < count; ++i)
+                src[i] = BitsToFloat((uint32_t)(begIndex + i));
+            for(size_t typeIndex = 0; typeIndex < TYPE_COUNT; ++typeIndex)
+            {
+                for(size_t modeIndex = 0; modeIndex < OVERFLOW_MODE_COUNT; ++modeIndex)
+                {
+                    const FP8::TYPE type = TYPES[typeIndex];
+                    const FP8::OVERFLOW_MODE overflowMode = OVERFLOW_MODES[modeIndex];
+                    for(size_t i = 0; i < count; ++i)
+                        expected[i] = FP8::Encode(type, src[i], overflowMode);
+                    for(uint32_t isa = 0; isa < isaCount; ++isa)
+                    {
+                        FP8::EncodeArrayIsa((FP8::ISA)isa, type, src.data(), count, actual.data(), overflowMode);
+                        if(memcmp(actual.data(), expected.data(), count) == 0)
+                            continue;
+                        size_t i = 0;
+                        while(actual[i] == expected[i])
+                            ++i;
+                        std::lock_guard<std::mutex> lock(mutex);
+                        uint64_t& wrong = firstWrong[(isa * TYPE_COUNT + typeIndex) * OVERFLOW_MODE_COUNT + modeIndex];
+                        wrong = std::min<uint64_t>(wrong, (uint64_t)(begIndex + i) << 8 | actual[i]);
+                    }
+                }
+            }
+        };
+    });
+
+    bool passed = true;
+    for(uint32_t isa = 0; isa < isaCount; ++isa)
+    {
+        for(size_t typeIndex = 0; typeIndex < TYPE_COUNT; ++typeIndex)
+        {
+            for(size_t modeIndex = 0; modeIndex < OVERFLOW_MODE_COUNT; ++modeIndex)
+            {
+                const uint64_t wrong = firstWrong[(isa * TYPE_COUNT + typeIndex) * OVERFLOW_MODE_COUNT + modeIndex];
+                if(wrong == UINT64_MAX)
+                    continue;
+                const FP8::TYPE type = TYPES[typeIndex];
+                const FP8::OVERFLOW_MODE overflowMode = OVERFLOW_MODES[modeIndex];
+                const uint32_t bits = (uint32_t)(wrong >> 8);
+                const float value = BitsToFloat(bits);
+                printf("  %s %s %s: 0x%08X (%g) gives 0x%02X, expected 0x%02X.\n",
+                    FP8::GetIsaName((FP8::ISA)isa), FP8::GetTypeName(type), GetOverflowModeName(overflowMode),
+                    bits, value, (uint32_t)(wrong & 0xFF), FP8::Encode(type, value, overflowMode));
+                passed = false;
+            }
+        }
+    }
+    return passed;
+}
+
+/*
+Zeros and subnormals of each type. UZ types have no negative zero - code 0x80
+is their only NaN - so negative values that round to zero must give 0x00.
+Subnormal ties round to even, also to the smallest normal value. Arrays are
+longer than a vector, so SIMD kernels are used, not only their scalar tails.
+*/
+static bool VerifyEncodeZeroSubnormal()
+{
+    struct ENCODE_CASE
+    {
+        FP8::TYPE Type;
+        float Value;
+        uint8_t Expected;
+    };
+    const float denormMin = std::numeric_limits<float>::denorm_min();
+    const ENCODE_CASE cases[] = {
+        // FLOAT8E4M3FN: smallest subnormal 2^-9.
+        { FP8::TYPE_FLOAT8E4M3FN,    0.f,                      0x00 },
+        { FP8::TYPE_FLOAT8E4M3FN,    -0.f,                     0x80 },
+        { FP8::TYPE_FLOAT8E4M3FN,    -denormMin,               0x80 },
+        { FP8::TYPE_FLOAT8E4M3FN,    std::ldexp(1.f, -9),      0x01 },
+        { FP8::TYPE_FLOAT8E4M3FN,    -std::ldexp(1.f, -9),     0x81 },
+        { FP8::TYPE_FLOAT8E4M3FN,    std::ldexp(1.f, -10),     0x00 }, // Tie to even 0.
+        { FP8::TYPE_FLOAT8E4M3FN,    -std::ldexp(1.f, -10),    0x80 },
+        { FP8::TYPE_FLOAT8E4M3FN,    std::ldexp(3.f, -10),     0x02 }, // Tie to even 2.
+        { FP8::TYPE_FLOAT8E4M3FN,    std::ldexp(7.f, -9),      0x07 }, // Largest subnormal.
+        { FP8::TYPE_FLOAT8E4M3FN,    std::ldexp(15.f, -10),    0x08 }, // Tie to smallest normal.
+        // FLOAT8E4M3FNUZ: smallest subnormal 2^-10.
+        { FP8::TYPE_FLOAT8E4M3FNUZ,  0.f,                      0x00 },
+        { FP8::TYPE_FLOAT8E4M3FNUZ,  -0.f,                     0x00 },
+        { FP8::TYPE_FLOAT8E4M3FNUZ,  -denormMin,               0x00 },
+        { FP8::TYPE_FLOAT8E4M3FNUZ,  std::ldexp(1.f, -10),     0x01 },
+        { FP8::TYPE_FLOAT8E4M3FNUZ,  -std::ldexp(1.f, -10),    0x81 },
+        { FP8::TYPE_FLOAT8E4M3FNUZ,  -std::ldexp(1.f, -11),    0x00 }, // Tie to even 0.
+        { FP8::TYPE_FLOAT8E4M3FNUZ,  -std::ldexp(1.5f, -12),   0x00 },
+        { FP8::TYPE_FLOAT8E4M3FNUZ,  -std::ldexp(3.f, -11),    0x82 }, // Tie to even 2.
+        { FP8::TYPE_FLOAT8E4M3FNUZ,  -std::ldexp(7.f, -10),    0x87 }, // Largest subnormal.
+        { FP8::TYPE_FLOAT8E4M3FNUZ,  -std::ldexp(15.f, -11),   0x88 }, // Tie to smallest normal.
+        // FLOAT8E5M2: smallest subnormal 2^-16.
+        { FP8::TYPE_FLOAT8E5M2,      0.f,                      0x00 },
+        { FP8::TYPE_FLOAT8E5M2,      -0.f,                     0x80 },
+        { FP8::TYPE_FLOAT8E5M2,      -denormMin,               0x80 },
+        { FP8::TYPE_FLOAT8E5M2,      std::ldexp(1.f, -16),     0x01 },
+        { FP8::TYPE_FLOAT8E5M2,      -std::ldexp(1.f, -17),    0x80 }, // Tie to even 0.
+        { FP8::TYPE_FLOAT8E5M2,      -std::ldexp(3.f, -17),    0x82 }, // Tie to even 2.
+        { FP8::TYPE_FLOAT8E5M2,      std::ldexp(3.f, -16),     0x03 }, // Largest subnormal.
+        { FP8::TYPE_FLOAT8E5M2,      std::ldexp(7.f, -17),     0x04 }, // Tie to smallest normal.
+        // FLOAT8E5M2FNUZ: smallest subnormal 2^-17.
+        { FP8::TYPE_FLOAT8E5M2FNUZ,  0.f,                      0x00 },
+        { FP8::TYPE_FLOAT8E5M2FNUZ,  -0.f,                     0x00 },
+        { FP8::TYPE_FLOAT8E5M2FNUZ,  -denormMin,               0x00 },
+        { FP8::TYPE_FLOAT8E5M2FNUZ,  std::ldexp(1.f, -17),     0x01 },
+        { FP8::TYPE_FLOAT8E5M2FNUZ,  -std::ldexp(1.f, -17),    0x81 },
+        { FP8::TYPE_FLOAT8E5M2FNUZ,  -std::ldexp(1.f, -18),    0x00 }, // Tie to even 0.
+        { FP8::TYPE_FLOAT8E5M2FNUZ,  -std::ldexp(3.f, -18),    0x82 }, // Tie to even 2.
+        { FP8::TYPE_FLOAT8E5M2FNUZ,  -std::ldexp(3.f, -17),    0x83 }, // Largest subnormal.
+        { FP8::TYPE_FLOAT8E5M2FNUZ,  -std::ldexp(7.f, -18),    0x84 }, // Tie to smallest normal.
+    };
+
+    const size_t arraySize = 67;
+    std::vector<float> src(arraySize);
+    std::vector<uint8_t> dst(arraySize);
+    bool passed = true;
+    for(const ENCODE_CASE& c : cases)
+    {
+        std::fill(src.begin(), src.end(), c.Value);
+        for(FP8::OVERFLOW_MODE overflowMode : OVERFLOW_MODES)
+        {
+            const uint8_t actual = FP8::Encode(c.Type, c.Value, overflowMode);
+            if(actual != c.Expected)
+            {
+                printf("  Encode %s %s: %g gives 0x%02X, expected 0x%02X.\n", FP8::GetTypeName(c.Type),
+                    GetOverflowModeName(overflowMode), c.Value, actual, c.Expected);
+                passed = false;
+            }
+            for(uint32_t isa = 0; isa <= (uint32_t)FP8::GetIsa(); ++isa)
+            {
+                FP8::EncodeArrayIsa((FP8::ISA)isa, c.Type, src.data(), arraySize, dst.data(), overflowMode);
+                for(size_t i = 0; i < arraySize; ++i)
+                {
+                    if(dst[i] != c.Expected)
+                    {
+                        printf("  %s %s %s: %g gives 0x%02X at index %zu, expected 0x%02X.\n",
+                            FP8::GetIsaName((FP8::ISA)isa), FP8::GetTypeName(c.Type),
+                            GetOverflowModeName(overflowMode), c.Value, dst[i], i, c.Expected);
+                        passed = false;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    return passed;
+}
+
+/*
+Blocks of subnormal float32 values, whose scale maxAbs / Max() is subnormal or
+underflows to 0. Scale 0 saturates all elements of the block, so scales must
+be normal numbers. Values must come back finite. Values not much smaller than
+FLT_MIN must also be close to the original, like values of any other block.
+Smaller ones may become 0, as the scale is at least FLT_MIN.
+*/
+static bool VerifyTensorSubnormalBlock()
+{
+    const uint64_t blockSize = 32;
+    const uint64_t shape[] = { 3, blockSize };
+    std::vector<float> data((size_t)(shape[0] * shape[1]));
+    for(size_t i = 0; i < blockSize; ++i)
+    {
+        data[i] = (float)(i + 1) * std::numeric_limits<float>::denorm_min(); // Scale underflows to 0.
+        data[blockSize + i] = (float)(i + 1) * 1e-40f; // Subnormal scale.
+        data[blockSize * 2 + i] = (float)(i + 1) * 0.5f; // Normal, for comparison.
+    }
+
+    bool passed = true;
+    for(FP8::TYPE type : TYPES)
+    {
+        if(!FP8::QuantizeTensorFile(TEMP_FILE_PATH, type, shape, 2, data.data(), blockSize))
+        {
+            printf("  %s: QuantizeTensorFile failed.\n", FP8::GetTypeName(type));
+            passed = false;
+            continue;
+        }
+        FP8::TensorFile file;
+        if(!file.Open(TEMP_FILE_PATH))
+        {
+            printf("  %s: TensorFile::Open failed.\n", FP8::GetTypeName(type));
+            passed = false;
+            continue;
+        }
+        for(uint64_t scaleIndex = 0; scaleIndex < file.GetHeader().ScaleCount; ++scaleIndex)
+        {
+            const float scale = file.GetScales()[scaleIndex];
+            if(!std::isnormal(scale))
+            {
+                printf("  %s: scale %llu is %g.\n", FP8::GetTypeName(type), (unsigned long long)scaleIndex, scale);
+                passed = false;
+            }
+        }
+        FP8::TensorView view(file);
+        for(uint64_t row = 0; row < shape[0]; ++row)
+        {
+            for(uint64_t column = 0; column < shape[1]; ++column)
+            {
+                const float expected = data[(size_t)(row * shape[1] + column)];
+                const float actual = view.Get(row, column);
+                // Smallest values of a block fall to subnormals of FP8.
+                const float maxError = row == 0 ? FLT_MIN : 0.25f * expected;
+                if(!std::isfinite(actual) || (row > 0 && actual == 0.f) ||
+                    std::abs(actual - expected) > maxError)
+                {
+                    printf("  %s: element (%llu, %llu) is %g, expected %g.\n", FP8::GetTypeName(type),
+                        (unsigned long long)row, (unsigned long long)column, actual, expected);
+                    passed = false;
+                    break;
+                }
+            }
+        }
+    }
+    remove(TEMP_FILE_PATH);
+    return passed;
+}
+
+/*
+In every gap between consecutive finite FP8 values lo and hi, of both signs, a
+value x at a few positions in the gap is encoded STOCHASTIC_SAMPLE_COUNT times.
+Every result must be lo or hi, and hi must come with probability
+(x - lo) / (hi - lo), which is exact, as random bits are uniform and x is
+a float32 value. Frequency is allowed to differ from it by 5 standard
+deviations. It is checked for every instruction set.
+*/
+static bool VerifyStochasticRoundingFrequency()
+{
+    const size_t sampleCount = 65536;
+    const double positions[] = { 0.01, 0.25, 0.5, 0.9 };
+    std::vector<float> src(sampleCount);
+    std::vector<uint8_t> dst(sampleCount);
+    bool passed = true;
+    uint64_t seed = 1;
+    for(FP8::TYPE type : TYPES)
+    {
+        uint32_t maxCode = 0;
+        bool hasNegativeZero = false;
+        FP8::Detail::VisitType(type, [&](auto format)
+        {
+            maxCode = decltype(format)::MaxCode;
+            hasNegativeZero = decltype(format)::HasNegativeZero;
+        });
+        for(uint32_t loCode = 0; loCode < maxCode && passed; ++loCode)
+        {
+            for(uint32_t signCode : { 0u, 0x80u })
+            {
+                // UZ types have no negative zero, so the negative gap at zero starts at 0x00.
+                const uint8_t lo = (uint8_t)(loCode == 0 && !hasNegativeZero ? 0 : loCode | signCode);
+                const uint8_t hi = (uint8_t)((loCode + 1) | signCode);
+                const double loValue = FP8::Decode(type, lo);
+                const double hiValue = FP8::Decode(type, hi);
+                for(double position : positions)
+                {
+                    const float x = (float)(loValue + (hiValue - loValue) * position);
+                    const double p = ((double)x - loValue) / (hiValue - loValue);
+                    const double maxError = 5.0 * std::sqrt(p * (1.0 - p) / (double)sampleCount) + 1.0 / (double)sampleCount;
+                    std::fill(src.begin(), src.end(), x);
+                    for(uint32_t isa = 0; isa <= (uint32_t)FP8::GetIsa(); ++isa)
+                    {
+                        const char* const isaName = FP8::GetIsaName((FP8::ISA)isa);
+                        FP8::EncodeArrayStochasticIsa((FP8::ISA)isa, type, src.data(), sampleCount, dst.data(), seed);
+                        size_t hiCount = 0;
+                        for(size_t i = 0; i < sampleCount; ++i)
+                        {
+                            if(dst[i] == hi)
+                                ++hiCount;
+                            else if(dst[i] != lo)
+                            {
+                                printf("  %s %s: %g gives 0x%02X, expected 0x%02X or 0x%02X.\n",
+                                    isaName, FP8::GetTypeName(type), x, dst[i], lo, hi);
+                                passed = false;
+                                break;
+                            }
+                        }
+                        const double frequency = (double)hiCount / (double)sampleCount;
+                        if(std::fabs(frequency - p) > maxError)
+                        {
+                            printf("  %s %s: %g between %g and %g rounds up with frequency %g, expected %g.\n",
+                                isaName, FP8::GetTypeName(type), x, loValue, hiValue, frequency, p);
+                            passed = false;
+                        }
+                    }
+                    ++seed;
+                }
+            }
+        }
+    }
+    return passed;
+}
+
+/*
+Random values over the whole range of each type, including overflow, encoded
+with stochastic rounding with the same seed: on 1 thread, on several threads,
+in parts of odd sizes, and element by element with EncodeStochastic and
+GetRandomBits. Results must be identical. Parts also start right before index
+2^32, where random keys change.
+*/
+static bool VerifyStochasticDeterminism()
+{
+    const size_t count = 1000003;
+    const uint64_t seed = 0x123456789ABCDEF0ull;
+    const uint32_t threadCounts[] = { 2, 3, 8 };
+    std::vector<float> src(count);
+    uint32_t state = 1;
+    for(size_t i = 0; i < count; ++i)
+    {
+        state = state * 1664525u + 1013904223u;
+        // Uniform exponent between 2^-30 and 2^30, random sign and mantissa.
+        src[i] = std::ldexp((float)(state >> 8) / 16777216.f, (int)(state % 61) - 30) * (state & 0x80 ? -1.f : 1.f);
+    }
+
+    std::vector<uint8_t> expected(count), actual(count);
+    bool passed = true;
+    for(FP8::TYPE type : TYPES)
+    {
+        for(FP8::OVERFLOW_MODE overflowMode : OVERFLOW_MODES)
+        {
+            const char* const typeName = FP8::GetTypeName(type);
+            const char* const modeName = GetOverflowModeName(overflowMode);
+            FP8::EncodeArrayStochasticParallel(type, src.data(), count, expected.data(), seed, 1, overflowMode);
+
+            for(size_t i = 0; i < count; ++i)
+            {
+                const uint8_t code = FP8::EncodeStochastic(type, src[i], FP8::GetRandomBits(seed, i), overflowMode);
+                if(code != expected[i])
+                {
+                    printf("  %s %s: element %zu is 0x%02X, EncodeStochastic gives 0x%02X.\n",
+                        typeName, modeName, i, expected[i], code);
+                    passed = false;
+                    break;
+                }
+            }
+
+            for(uint32_t threadCount : threadCounts)
+            {
+                FP8::EncodeArrayStochasticParallel(type, src.data(), count, actual.data(), seed, threadCount, overflowMode);
+                if(actual != expected)
+                {
+                    printf("  %s %s: results on %u threads differ from 1 thread.\n", typeName, modeName, threadCount);
+                    passed = false;
+                }
+            }
+
+            for(uint32_t isa = 0; isa <= (uint32_t)FP8::GetIsa(); ++isa)
+            {
+                const size_t partSize = 1001;
+                for(size_t begIndex = 0; begIndex < count; begIndex += partSize)
+                {
+                    FP8::EncodeArrayStochasticIsa((FP8::ISA)isa, type, src.data() + begIndex,
+                        std::min(partSize, count - begIndex), actual.data() + begIndex, seed, begIndex, overflowMode);
+                }
+                if(actual != expected)
+                {
+                    printf("  %s %s %s: results in parts differ.\n", FP8::GetIsaName((FP8::ISA)isa), typeName, modeName);
+                    passed = false;
+                }
+
+                // Crossing index 2^32 in the middle of a vector.
+                const uint64_t firstIndex = (1ull << 32) - 37;
+                const size_t crossCount = 200;
+                FP8::EncodeArrayStochasticIsa((FP8::ISA)isa, type, src.data(), crossCount, actual.data(), seed,
+                    firstIndex, overflowMode);
+                for(size_t i = 0; i < crossCount; ++i)
+                {
+                    const uint8_t code = FP8::EncodeStochastic(type, src[i],
+                        FP8::GetRandomBits(seed, firstIndex + i), overflowMode);
+                    if(actual[i] != code)
+                    {
+                        printf("  %s %s %s: element %llu is 0x%02X, EncodeStochastic gives 0x%02X.\n",
+                            FP8::GetIsaName((FP8::ISA)isa), typeName, modeName,
+                            (unsigned long long)(firstIndex + i), actual[i], code);
+                        passed = false;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    return passed;
+}
+
+struct CASE
+{
+    const char* Name;
+    bool (*Func)();
+};
+
+static const CASE CASES[] = {
+    { "EncodeZeroSubnormal", VerifyEncodeZeroSubnormal },
+    { "StochasticRoundingFrequency", VerifyStochasticRoundingFrequency },
+    { "StochasticDeterminism", VerifyStochasticDeterminism },
+    { "TensorSubnormalBlock", VerifyTensorSubnormalBlock },
+    { "EncodeArrayExhaustive", VerifyEncodeArrayExhaustive },
+};
+
+int main()
+{
+    bool allPassed = true;
+    for(const CASE& c : CASES)
+    {
+        const bool passed = c.Func();
+        printf("%-32s %s\n", c.Name, passed ? "PASSED" : "FAILED");
+        allPassed = allPassed && passed;
+    }
+    return allPassed ? 0 : 1;
+}
@@ -3,7 +3,8 @@ This is a simple C program demonstrating multiple solutions to a question:
 
     "Write a function that checks whether an integer number is a power of 10."
 
-It contains a set of tests.
+It contains a set of tests. Define ISLOG10_NO_MAIN to compile only the
+functions, declared in IsLog10.h, e.g. to link them with IsLog10Benchmark.cpp.
 
 Author  : Adam Sawicki, http://asawicki.info, 2017-10-04
 License : Public Domain
@@ -15,6 +16,18 @@ License : Public Domain
 #include <string.h>
 #include <math.h>
 
+#include "IsLog10.h"
+
+#ifndef _MSC_VER
+// itoa is not a standard function, so provide it for other compilers.
+static char* itoa(int value, char* str, int radix)
+{
+    (void)radix; // Only 10 is used.
+    sprintf(str, "%d", value);
+    return str;
+}
+#endif
+
 int IsLog10_v1(int32_t x)
 {
     // Convert x to string.
@@ -85,6 +98,8 @@ int IsLog10_v5(int32_t x)
         x == 1000000000;
 }
 
+#ifndef ISLOG10_NO_MAIN
+
 int Test(int32_t x)
 {
     // Choose version to test.
@@ -169,3 +184,5 @@ int main()
     if(allPassed)
         printf("All tests passed.\n");
 }
+
+#endif // #ifndef ISLOG10_NO_MAIN
@@ -0,0 +1,29 @@
+/*
+Declarations of functions from IsLog10.c, which check whether an integer number
+is a power of 10. Each returns 1 if it is, 0 otherwise.
+
+Author  : Adam Sawicki, http://asawicki.info, 2017-10-04
+License : Public Domain
+*/
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Converts x to string and checks if it is "1" followed by "0"-s.
+int IsLog10_v1(int32_t x);
+// Checks if log10(x) has zero fractional part.
+int IsLog10_v2(int32_t x);
+// Recursively divides by 10.
+int IsLog10_v3(int32_t x);
+// Divides by 10 in a loop.
+int IsLog10_v4(int32_t x);
+// Compares with all possible values.
+int IsLog10_v5(int32_t x);
+
+#ifdef __cplusplus
+}
+#endif
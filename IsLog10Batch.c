@@ -0,0 +1,336 @@
+/*
+IsLog10Batch
+
+Author  : Adam Sawicki, http://asawicki.info, adam__REMOVE__@asawicki.info
+Version : 1.0, 2026-10-19
+License : Public Domain
+
+For documentation, see accompanying file IsLog10Batch.h.
+*/
+#include "IsLog10Batch.h"
+
+#include <assert.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    #define ISLOG10_X86 1
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+#else
+    #define ISLOG10_X86 0
+#endif
+
+// GCC and Clang need functions using intrinsics from instruction sets not
+// enabled on command line to be marked with target attribute. MSVC doesn't.
+#if defined(__GNUC__) || defined(__clang__)
+    #define ISLOG10_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define ISLOG10_TARGET(isa)
+#endif
+
+#define ISLOG10_POWER_COUNT 10
+
+static const int32_t POWERS_OF_10[ISLOG10_POWER_COUNT] = {
+    1,
+    10,
+    100,
+    1000,
+    10000,
+    100000,
+    1000000,
+    10000000,
+    100000000,
+    1000000000,
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Scalar
+
+static int IsLog10_Scalar(int32_t x)
+{
+    // Same as IsLog10_v5, but with | instead of || so it doesn't branch.
+    int result = 0;
+    for(size_t i = 0; i < ISLOG10_POWER_COUNT; ++i)
+        result |= x == POWERS_OF_10[i];
+    return result;
+}
+
+static void IsLog10_Batch_Scalar(const int32_t* src, size_t count, uint8_t* dst)
+{
+    for(size_t i = 0; i < count; ++i)
+        dst[i] = (uint8_t)IsLog10_Scalar(src[i]);
+}
+
+// Calculates bits for up to 64 values.
+static uint64_t IsLog10_Mask64_Scalar(const int32_t* src, size_t count)
+{
+    assert(count <= 64);
+    uint64_t mask = 0;
+    for(size_t i = 0; i < count; ++i)
+        mask |= (uint64_t)IsLog10_Scalar(src[i]) << i;
+    return mask;
+}
+
+static void IsLog10_BatchMask_Scalar(const int32_t* src, size_t count, uint64_t* dstMask)
+{
+    for(size_t i = 0; i < count; i += 64)
+        dstMask[i / 64] = IsLog10_Mask64_Scalar(src + i, count - i < 64 ? count - i : 64);
+}
+
+#if ISLOG10_X86
+
+////////////////////////////////////////////////////////////////////////////////
+// SSE2
+
+ISLOG10_TARGET("sse2")
+static __m128i IsLog10_Cmp_Sse2(__m128i x)
+{
+    __m128i result = _mm_cmpeq_epi32(x, _mm_set1_epi32(POWERS_OF_10[0]));
+    for(size_t i = 1; i < ISLOG10_POWER_COUNT; ++i)
+        result = _mm_or_si128(result, _mm_cmpeq_epi32(x, _mm_set1_epi32(POWERS_OF_10[i])));
+    return result;
+}
+
+ISLOG10_TARGET("sse2")
+static void IsLog10_Batch_Sse2(const int32_t* src, size_t count, uint8_t* dst)
+{
+    const __m128i one = _mm_set1_epi8(1);
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16)
+    {
+        const __m128i m0 = IsLog10_Cmp_Sse2(_mm_loadu_si128((const __m128i*)(src + i)));
+        const __m128i m1 = IsLog10_Cmp_Sse2(_mm_loadu_si128((const __m128i*)(src + i + 4)));
+        const __m128i m2 = IsLog10_Cmp_Sse2(_mm_loadu_si128((const __m128i*)(src + i + 8)));
+        const __m128i m3 = IsLog10_Cmp_Sse2(_mm_loadu_si128((const __m128i*)(src + i + 12)));
+        // All-ones and all-zeros survive signed saturation unchanged.
+        const __m128i m01 = _mm_packs_epi32(m0, m1);
+        const __m128i m23 = _mm_packs_epi32(m2, m3);
+        const __m128i bytes = _mm_and_si128(_mm_packs_epi16(m01, m23), one);
+        _mm_storeu_si128((__m128i*)(dst + i), bytes);
+    }
+    IsLog10_Batch_Scalar(src + i, count - i, dst + i);
+}
+
+ISLOG10_TARGET("sse2")
+static void IsLog10_BatchMask_Sse2(const int32_t* src, size_t count, uint64_t* dstMask)
+{
+    size_t i = 0;
+    for(; i + 64 <= count; i += 64)
+    {
+        uint64_t mask = 0;
+        for(size_t j = 0; j < 64; j += 4)
+        {
+            const __m128i m = IsLog10_Cmp_Sse2(_mm_loadu_si128((const __m128i*)(src + i + j)));
+            mask |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(m)) << j;
+        }
+        dstMask[i / 64] = mask;
+    }
+    if(i < count)
+        dstMask[i / 64] = IsLog10_Mask64_Scalar(src + i, count - i);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// AVX2
+
+ISLOG10_TARGET("avx2")
+static __m256i IsLog10_Cmp_Avx2(__m256i x)
+{
+    __m256i result = _mm256_cmpeq_epi32(x, _mm256_set1_epi32(POWERS_OF_10[0]));
+    for(size_t i = 1; i < ISLOG10_POWER_COUNT; ++i)
+        result = _mm256_or_si256(result, _mm256_cmpeq_epi32(x, _mm256_set1_epi32(POWERS_OF_10[i])));
+    return result;
+}
+
+ISLOG10_TARGET("avx2")
+static void IsLog10_Batch_Avx2(const int32_t* src, size_t count, uint8_t* dst)
+{
+    const __m256i one = _mm256_set1_epi8(1);
+    // Packing works within 128-bit lanes, so 32-bit groups of 4 bytes end up
+    // in order 0, 2, 4, 6, 1, 3, 5, 7.
+    const __m256i permutation = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    size_t i = 0;
+    for(; i + 32 <= count; i += 32)
+    {
+        const __m256i m0 = IsLog10_Cmp_Avx2(_mm256_loadu_si256((const __m256i*)(src + i)));
+        const __m256i m1 = IsLog10_Cmp_Avx2(_mm256_loadu_si256((const __m256i*)(src + i + 8)));
+        const __m256i m2 = IsLog10_Cmp_Avx2(_mm256_loadu_si256((const __m256i*)(src + i + 16)));
+        const __m256i m3 = IsLog10_Cmp_Avx2(_mm256_loadu_si256((const __m256i*)(src + i + 24)));
+        const __m256i m01 = _mm256_packs_epi32(m0, m1);
+        const __m256i m23 = _mm256_packs_epi32(m2, m3);
+        __m256i bytes = _mm256_packs_epi16(m01, m23);
+        bytes = _mm256_permutevar8x32_epi32(bytes, permutation);
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_and_si256(bytes, one));
+    }
+    IsLog10_Batch_Scalar(src + i, count - i, dst + i);
+}
+
+ISLOG10_TARGET("avx2")
+static void IsLog10_BatchMask_Avx2(const int32_t* src, size_t count, uint64_t* dstMask)
+{
+    size_t i = 0;
+    for(; i + 64 <= count; i += 64)
+    {
+        uint64_t mask = 0;
+        for(size_t j = 0; j < 64; j += 8)
+        {
+            const __m256i m = IsLog10_Cmp_Avx2(_mm256_loadu_si256((const __m256i*)(src + i + j)));
+            mask |= (uint64_t)(uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(m)) << j;
+        }
+        dstMask[i / 64] = mask;
+    }
+    if(i < count)
+        dstMask[i / 64] = IsLog10_Mask64_Scalar(src + i, count - i);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// AVX-512
+
+ISLOG10_TARGET("avx512f,avx512bw")
+static uint64_t IsLog10_Cmp64_Avx512(const int32_t* src)
+{
+    uint64_t mask = 0;
+    for(size_t j = 0; j < 64; j += 16)
+    {
+        const __m512i x = _mm512_loadu_si512((const void*)(src + j));
+        __mmask16 m = _mm512_cmpeq_epi32_mask(x, _mm512_set1_epi32(POWERS_OF_10[0]));
+        for(size_t i = 1; i < ISLOG10_POWER_COUNT; ++i)
+            m = (__mmask16)(m | _mm512_cmpeq_epi32_mask(x, _mm512_set1_epi32(POWERS_OF_10[i])));
+        mask |= (uint64_t)m << j;
+    }
+    return mask;
+}
+
+ISLOG10_TARGET("avx512f,avx512bw")
+static void IsLog10_Batch_Avx512(const int32_t* src, size_t count, uint8_t* dst)
+{
+    const __m512i one = _mm512_set1_epi8(1);
+    size_t i = 0;
+    for(; i + 64 <= count; i += 64)
+    {
+        const __mmask64 mask = (__mmask64)IsLog10_Cmp64_Avx512(src + i);
+        _mm512_storeu_si512((void*)(dst + i), _mm512_maskz_mov_epi8(mask, one));
+    }
+    IsLog10_Batch_Scalar(src + i, count - i, dst + i);
+}
+
+ISLOG10_TARGET("avx512f,avx512bw")
+static void IsLog10_BatchMask_Avx512(const int32_t* src, size_t count, uint64_t* dstMask)
+{
+    size_t i = 0;
+    for(; i + 64 <= count; i += 64)
+        dstMask[i / 64] = IsLog10_Cmp64_Avx512(src + i);
+    if(i < count)
+        dstMask[i / 64] = IsLog10_Mask64_Scalar(src + i, count - i);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// CPU detection
+
+static IsLog10_Isa IsLog10_DetectIsa(void)
+{
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 0);
+    const int maxLeaf = regs[0];
+    __cpuid(regs, 1);
+    const int hasSse2 = (regs[3] & (1 << 26)) != 0;
+    const int hasOsxsave = (regs[2] & (1 << 27)) != 0;
+    const int hasAvx = (regs[2] & (1 << 28)) != 0;
+    if(!hasSse2)
+        return ISLOG10_ISA_SCALAR;
+    if(!hasOsxsave || !hasAvx || maxLeaf < 7)
+        return ISLOG10_ISA_SSE2;
+    // Check that the OS saves YMM and ZMM registers.
+    const unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(regs, 7, 0);
+    const int hasAvx2 = (regs[1] & (1 << 5)) != 0;
+    const int hasAvx512F = (regs[1] & (1 << 16)) != 0;
+    const int hasAvx512BW = (regs[1] & (1 << 30)) != 0;
+    if(hasAvx512F && hasAvx512BW && (xcr0 & 0xE6) == 0xE6)
+        return ISLOG10_ISA_AVX512;
+    if(hasAvx2 && (xcr0 & 0x6) == 0x6)
+        return ISLOG10_ISA_AVX2;
+    return ISLOG10_ISA_SSE2;
+#else
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+        return ISLOG10_ISA_AVX512;
+    if(__builtin_cpu_supports("avx2"))
+        return ISLOG10_ISA_AVX2;
+    if(__builtin_cpu_supports("sse2"))
+        return ISLOG10_ISA_SSE2;
+    return ISLOG10_ISA_SCALAR;
+#endif
+}
+
+#else // #if ISLOG10_X86
+
+static IsLog10_Isa IsLog10_DetectIsa(void)
+{
+    return ISLOG10_ISA_SCALAR;
+}
+
+#endif // #if ISLOG10_X86
+
+////////////////////////////////////////////////////////////////////////////////
+// Public functions
+
+IsLog10_Isa IsLog10_GetIsa(void)
+{
+    // Race between threads is harmless - all of them calculate the same value.
+    static volatile int s_Isa = -1;
+    if(s_Isa < 0)
+        s_Isa = (int)IsLog10_DetectIsa();
+    return (IsLog10_Isa)s_Isa;
+}
+
+const char* IsLog10_GetIsaName(IsLog10_Isa isa)
+{
+    switch(isa)
+    {
+    case ISLOG10_ISA_SCALAR: return "Scalar";
+    case ISLOG10_ISA_SSE2:   return "SSE2";
+    case ISLOG10_ISA_AVX2:   return "AVX2";
+    case ISLOG10_ISA_AVX512: return "AVX-512";
+    default:                 return "";
+    }
+}
+
+void IsLog10_BatchIsa(IsLog10_Isa isa, const int32_t* src, size_t count, uint8_t* dst)
+{
+    assert(isa <= IsLog10_GetIsa());
+    switch(isa)
+    {
+#if ISLOG10_X86
+    case ISLOG10_ISA_SSE2:   IsLog10_Batch_Sse2(src, count, dst); break;
+    case ISLOG10_ISA_AVX2:   IsLog10_Batch_Avx2(src, count, dst); break;
+    case ISLOG10_ISA_AVX512: IsLog10_Batch_Avx512(src, count, dst); break;
+#endif
+    default:                 IsLog10_Batch_Scalar(src, count, dst);
+    }
+}
+
+void IsLog10_BatchMaskIsa(IsLog10_Isa isa, const int32_t* src, size_t count, uint64_t* dstMask)
+{
+    assert(isa <= IsLog10_GetIsa());
+    switch(isa)
+    {
+#if ISLOG10_X86
+    case ISLOG10_ISA_SSE2:   IsLog10_BatchMask_Sse2(src, count, dstMask); break;
+    case ISLOG10_ISA_AVX2:   IsLog10_BatchMask_Avx2(src, count, dstMask); break;
+    case ISLOG10_ISA_AVX512: IsLog10_BatchMask_Avx512(src, count, dstMask); break;
+#endif
+    default:                 IsLog10_BatchMask_Scalar(src, count, dstMask);
+    }
+}
+
+void IsLog10_Batch(const int32_t* src, size_t count, uint8_t* dst)
+{
+    IsLog10_BatchIsa(IsLog10_GetIsa(), src, count, dst);
+}
+
+void IsLog10_BatchMask(const int32_t* src, size_t count, uint64_t* dstMask)
+{
+    IsLog10_BatchMaskIsa(IsLog10_GetIsa(), src, count, dstMask);
+}
@@ -0,0 +1,67 @@
+/*
+IsLog10Batch
+
+Author  : Adam Sawicki, http://asawicki.info, adam__REMOVE__@asawicki.info
+Version : 1.0, 2026-10-19
+License : Public Domain
+
+Batch version of the "is power of 10" check from IsLog10.c. Instead of one
+branchy call per value, it checks whole arrays of int32_t, comparing many values
+against all 10 powers of 10 at once using SIMD instructions. Implementation is
+selected at runtime based on CPUID: AVX-512 (F + BW), AVX2, SSE2, or plain C
+scalar code. All of them return exactly the same results as IsLog10_v5.
+
+Add IsLog10Batch.c to your project. It can be compiled as C or C++, with GCC,
+Clang or Visual Studio, without any special compiler flags.
+*/
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum IsLog10_Isa
+{
+    ISLOG10_ISA_SCALAR,
+    ISLOG10_ISA_SSE2,
+    ISLOG10_ISA_AVX2,
+    ISLOG10_ISA_AVX512,
+    ISLOG10_ISA_COUNT
+} IsLog10_Isa;
+
+/*
+Returns the best instruction set supported by current CPU and operating system,
+which is used by IsLog10_Batch and IsLog10_BatchMask.
+*/
+IsLog10_Isa IsLog10_GetIsa(void);
+
+// Returns name of the instruction set, like "AVX2".
+const char* IsLog10_GetIsaName(IsLog10_Isa isa);
+
+/*
+For each src[i], writes 1 to dst[i] if it is a power of 10, 0 otherwise.
+src and dst don't need any special alignment.
+*/
+void IsLog10_Batch(const int32_t* src, size_t count, uint8_t* dst);
+
+/*
+For each src[i], sets bit (i % 64) of dstMask[i / 64] if it is a power of 10,
+clears it otherwise. dstMask must have (count + 63) / 64 elements. Unused bits
+of the last element are cleared.
+*/
+void IsLog10_BatchMask(const int32_t* src, size_t count, uint64_t* dstMask);
+
+/*
+Same as IsLog10_Batch and IsLog10_BatchMask, but use specific instruction set.
+Useful for testing and benchmarking. Instruction set must be supported by
+current CPU - at most the one returned by IsLog10_GetIsa.
+*/
+void IsLog10_BatchIsa(IsLog10_Isa isa, const int32_t* src, size_t count, uint8_t* dst);
+void IsLog10_BatchMaskIsa(IsLog10_Isa isa, const int32_t* src, size_t count, uint64_t* dstMask);
+
+#ifdef __cplusplus
+}
+#endif
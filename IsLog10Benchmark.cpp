@@ -0,0 +1,197 @@
+/*
+IsLog10Benchmark.cpp
+
+Author  : Adam Sawicki, http://asawicki.info, adam__REMOVE__@asawicki.info
+Version : 1.0, 2026-10-19
+License : Public Domain
+
+Benchmark of the functions from IsLog10.c and their faster successors from
+IsPowerOf.hpp, DecimalInt.hpp and IsLog10Batch.h, over input data of different
+distributions. Performance of variants that branch, like the short-circuit
+chain of comparisons in IsLog10_v5, depends on how predictable the data is, so
+each variant is measured on:
+
+- Uniform   - uniformly distributed random int32_t numbers.
+- Powers    - 90% of numbers are powers of 10, in random order.
+- Sorted    - uniformly distributed random numbers, sorted.
+- Small     - random numbers from range 0..999.
+- Negative  - uniformly distributed random negative numbers.
+
+It prints time per value in nanoseconds and, when hardware performance counters
+are available (Linux, see MicroBenchmark.h), branch misses per value.
+
+Usage:
+    IsLog10Benchmark [--csv | --json]
+
+--csv, --json - additionally print raw results of all measurements, where one
+                iteration is a pass over all values.
+
+Build, e.g.:
+    g++ -O2 -DISLOG10_NO_MAIN IsLog10Benchmark.cpp IsLog10.c IsLog10Batch.c
+*/
+#define MICRO_BENCHMARK_IMPLEMENTATION
+#include "MicroBenchmark/MicroBenchmark.h"
+
+#include "IsLog10Batch.h"
+#include "IsLog10Variants.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// 64 KB of input - fits in L2 cache, so memory doesn't hide branch behavior.
+static const size_t VALUE_COUNT = 16384;
+
+enum DISTRIBUTION
+{
+    DISTRIBUTION_UNIFORM,
+    DISTRIBUTION_POWERS,
+    DISTRIBUTION_SORTED,
+    DISTRIBUTION_SMALL,
+    DISTRIBUTION_NEGATIVE,
+    DISTRIBUTION_COUNT
+};
+
+static const char* const DISTRIBUTION_NAMES[DISTRIBUTION_COUNT] = {
+    "Uniform",
+    "Powers",
+    "Sorted",
+    "Small",
+    "Negative",
+};
+
+struct VARIANT
+{
+    const char* Name;
+    BatchFunc Func;
+};
+
+// Add new variants here.
+static const VARIANT VARIANTS[] = {
+    { "IsLog10_v1", ScalarLoop<IsLog10_v1> },
+    { "IsLog10_v2", ScalarLoop<IsLog10_v2> },
+    { "IsLog10_v3", ScalarLoop<IsLog10_v3> },
+    { "IsLog10_v4", ScalarLoop<IsLog10_v4> },
+    { "IsLog10_v5", ScalarLoop<IsLog10_v5> },
+    { "IsPowerOf<10>", IsPowerOfLoop },
+    { "IsPowerOf10", IsPowerOf10Loop },
+    { "IsLog10_Batch", IsLog10_Batch },
+};
+static const size_t VARIANT_COUNT = sizeof(VARIANTS) / sizeof(VARIANTS[0]);
+
+static void GenerateValues(DISTRIBUTION distribution, std::vector<int32_t>& values)
+{
+    // Fixed seed, so every run measures the same data.
+    std::mt19937 rng(1234 + (uint32_t)distribution);
+    values.resize(VALUE_COUNT);
+    for(size_t i = 0; i < VALUE_COUNT; ++i)
+    {
+        switch(distribution)
+        {
+        case DISTRIBUTION_UNIFORM:
+        case DISTRIBUTION_SORTED:
+            values[i] = (int32_t)rng();
+            break;
+        case DISTRIBUTION_POWERS:
+            values[i] = rng() % 10 != 0 ? POWERS_OF_10[rng() % 10] : (int32_t)rng();
+            break;
+        case DISTRIBUTION_SMALL:
+            values[i] = (int32_t)(rng() % 1000);
+            break;
+        case DISTRIBUTION_NEGATIVE:
+            values[i] = (int32_t)(rng() | 0x80000000u);
+            break;
+        default:
+            break;
+        }
+    }
+    if(distribution == DISTRIBUTION_SORTED)
+        std::sort(values.begin(), values.end());
+}
+
+static void PrintTable(const char* title, const double (*table)[DISTRIBUTION_COUNT])
+{
+    printf("\n%s\n%-16s", title, "");
+    for(uint32_t d = 0; d < DISTRIBUTION_COUNT; ++d)
+        printf(" %10s", DISTRIBUTION_NAMES[d]);
+    printf("\n");
+    for(size_t v = 0; v < VARIANT_COUNT; ++v)
+    {
+        printf("%-16s", VARIANTS[v].Name);
+        for(uint32_t d = 0; d < DISTRIBUTION_COUNT; ++d)
+            printf(" %10.4g", table[v][d]);
+        printf("\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const bool writeCsv = argc == 2 && strcmp(argv[1], "--csv") == 0;
+    const bool writeJson = argc == 2 && strcmp(argv[1], "--json") == 0;
+
+    MicroBenchmark::CONFIG config;
+    config.WarmupSeconds = 0.05;
+    config.SampleCount = 15;
+    MicroBenchmark::Runner runner(config);
+
+    printf("IsLog10_Batch uses: %s\n", IsLog10_GetIsaName(IsLog10_GetIsa()));
+    printf("Values per pass: %zu\n", VALUE_COUNT);
+
+    std::vector<int32_t> values;
+    std::vector<uint8_t> expected(VALUE_COUNT);
+    std::vector<uint8_t> results(VALUE_COUNT);
+    double nsPerValue[VARIANT_COUNT][DISTRIBUTION_COUNT];
+    double branchMissesPerValue[VARIANT_COUNT][DISTRIBUTION_COUNT];
+    bool allCorrect = true;
+
+    for(uint32_t d = 0; d < DISTRIBUTION_COUNT; ++d)
+    {
+        GenerateValues((DISTRIBUTION)d, values);
+        ScalarLoop<IsLog10_v5>(values.data(), VALUE_COUNT, expected.data());
+
+        for(size_t v = 0; v < VARIANT_COUNT; ++v)
+        {
+            const BatchFunc func = VARIANTS[v].Func;
+            const int32_t* const src = values.data();
+            uint8_t* const dst = results.data();
+
+            char name[64];
+            snprintf(name, sizeof(name), "%s/%s", VARIANTS[v].Name, DISTRIBUTION_NAMES[d]);
+            const MicroBenchmark::RESULT& result = runner.Run(name, [=]() {
+                func(src, VALUE_COUNT, dst);
+                MicroBenchmark::ClobberMemory();
+            });
+
+            nsPerValue[v][d] = result.MeanNs / (double)VALUE_COUNT;
+            branchMissesPerValue[v][d] = result.Counters[MicroBenchmark::COUNTER_BRANCH_MISSES] / (double)VALUE_COUNT;
+
+            if(results != expected)
+            {
+                printf("%s: results differ from IsLog10_v5!\n", name);
+                allCorrect = false;
+            }
+        }
+    }
+
+    PrintTable("Time per value [ns]:", nsPerValue);
+    if(runner.GetPerfCounters() && runner.GetPerfCounters()->IsAvailable(MicroBenchmark::COUNTER_BRANCH_MISSES))
+        PrintTable("Branch misses per value:", branchMissesPerValue);
+    else
+        printf("\nBranch misses not available - hardware performance counters cannot be used.\n");
+
+    if(writeCsv)
+    {
+        printf("\n");
+        runner.WriteCsv(stdout);
+    }
+    if(writeJson)
+    {
+        printf("\n");
+        runner.WriteJson(stdout);
+    }
+
+    return allCorrect ? 0 : 1;
+}
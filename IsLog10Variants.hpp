@@ -0,0 +1,45 @@
+/*
+IsLog10Variants.hpp
+
+Author  : Adam Sawicki, http://asawicki.info, adam__REMOVE__@asawicki.info
+Version : 1.0, 2026-10-19
+License : Public Domain
+
+Common part of IsLog10Benchmark.cpp and IsLog10Verify.cpp: adapters that turn
+every scalar variant from IsLog10.c, IsPowerOf.hpp and DecimalInt.hpp into a
+function processing an array, with the same signature as IsLog10_Batch, so all
+variants can be measured and tested the same way.
+*/
+#pragma once
+
+#include "DecimalInt.hpp"
+#include "IsLog10.h"
+#include "IsPowerOf.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+typedef void (*BatchFunc)(const int32_t* src, size_t count, uint8_t* dst);
+
+// All powers of 10 that fit in int32_t.
+static const int32_t POWERS_OF_10[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+template<int (*Func)(int32_t)>
+static void ScalarLoop(const int32_t* src, size_t count, uint8_t* dst)
+{
+    for(size_t i = 0; i < count; ++i)
+        dst[i] = (uint8_t)Func(src[i]);
+}
+
+static void IsPowerOfLoop(const int32_t* src, size_t count, uint8_t* dst)
+{
+    for(size_t i = 0; i < count; ++i)
+        dst[i] = (uint8_t)IsPowerOf<10>(src[i]);
+}
+
+static void IsPowerOf10Loop(const int32_t* src, size_t count, uint8_t* dst)
+{
+    for(size_t i = 0; i < count; ++i)
+        dst[i] = (uint8_t)IsPowerOf10(src[i]);
+}
@@ -0,0 +1,252 @@
+/*
+IsLog10Verify.cpp
+
+Author  : Adam Sawicki, http://asawicki.info, adam__REMOVE__@asawicki.info
+Version : 1.0, 2026-10-19
+License : Public Domain
+
+Exhaustive test of the functions from IsLog10.c and their faster successors.
+Unlike the test in IsLog10.c, which checks about 40 hand-picked numbers, it
+checks every possible int32_t value - all 2^32 of them - with every variant.
+
+Reference results don't come from any of the tested functions. The range of
+values is split into chunks of consecutive numbers, and for each chunk the
+reference is an array of zeros with 1 written at the positions of the powers
+of 10 that fall into it. Chunks are small enough to stay in cache and are
+distributed among all CPU cores. Results of a variant are compared with the
+reference using memcmp, so only the variants themselves take noticeable time.
+
+For each variant it prints the number of wrong results and the first (lowest)
+value where the result is wrong.
+
+Usage:
+    IsLog10Verify [variant...]
+
+variant - name of a variant to test, like IsLog10_v4. Default: all variants.
+          IsLog10_v1 and IsLog10_v2 are slow - they take minutes of CPU time.
+
+Build, e.g.:
+    g++ -O2 -pthread -DISLOG10_NO_MAIN IsLog10Verify.cpp IsLog10.c IsLog10Batch.c
+*/
+#include "IsLog10Batch.h"
+#include "IsLog10Variants.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 16 K values = 64 KB of input, 16 KB of results - fits in L2 cache.
+static const uint32_t CHUNK_SIZE = 16384;
+static const uint64_t TOTAL_VALUE_COUNT = 1ull << 32;
+static const uint32_t CHUNK_COUNT = (uint32_t)(TOTAL_VALUE_COUNT / CHUNK_SIZE);
+
+struct VARIANT
+{
+    std::string Name;
+    // Either Func is not null, or the variant is IsLog10_BatchIsa or
+    // IsLog10_BatchMaskIsa (when Mask is true) with instruction set Isa.
+    BatchFunc Func;
+    IsLog10_Isa Isa;
+    bool Mask;
+
+    // Results, in CPU time and indices counted from INT32_MIN.
+    std::atomic<uint64_t> Nanoseconds;
+    std::atomic<uint64_t> MismatchCount;
+    std::atomic<uint64_t> FirstMismatchIndex;
+};
+
+static std::vector<VARIANT*> g_Variants;
+static std::atomic<uint32_t> g_NextChunk;
+
+static void AddVariant(const char* name, BatchFunc func, IsLog10_Isa isa, bool mask)
+{
+    VARIANT* v = new VARIANT();
+    v->Name = name;
+    v->Func = func;
+    v->Isa = isa;
+    v->Mask = mask;
+    v->Nanoseconds = 0;
+    v->MismatchCount = 0;
+    v->FirstMismatchIndex = UINT64_MAX;
+    g_Variants.push_back(v);
+}
+
+static void CreateVariants()
+{
+    AddVariant("IsLog10_v1", ScalarLoop<IsLog10_v1>, ISLOG10_ISA_SCALAR, false);
+    AddVariant("IsLog10_v2", ScalarLoop<IsLog10_v2>, ISLOG10_ISA_SCALAR, false);
+    AddVariant("IsLog10_v3", ScalarLoop<IsLog10_v3>, ISLOG10_ISA_SCALAR, false);
+    AddVariant("IsLog10_v4", ScalarLoop<IsLog10_v4>, ISLOG10_ISA_SCALAR, false);
+    AddVariant("IsLog10_v5", ScalarLoop<IsLog10_v5>, ISLOG10_ISA_SCALAR, false);
+    AddVariant("IsPowerOf<10>", IsPowerOfLoop, ISLOG10_ISA_SCALAR, false);
+    AddVariant("IsPowerOf10", IsPowerOf10Loop, ISLOG10_ISA_SCALAR, false);
+    // Every kernel supported by this CPU, not only the one used by default.
+    for(uint32_t isa = 0; isa <= (uint32_t)IsLog10_GetIsa(); ++isa)
+    {
+        const std::string isaName = IsLog10_GetIsaName((IsLog10_Isa)isa);
+        AddVariant(("IsLog10_Batch/" + isaName).c_str(), nullptr, (IsLog10_Isa)isa, false);
+        AddVariant(("IsLog10_BatchMask/" + isaName).c_str(), nullptr, (IsLog10_Isa)isa, true);
+    }
+}
+
+static void AtomicMin(std::atomic<uint64_t>& dst, uint64_t value)
+{
+    uint64_t prev = dst.load();
+    while(value < prev && !dst.compare_exchange_weak(prev, value))
+    {
+    }
+}
+
+static void CheckResult(VARIANT& v, uint64_t chunkBegIndex, const uint8_t* result, const uint8_t* reference)
+{
+    if(memcmp(result, reference, CHUNK_SIZE) == 0)
+        return;
+    uint64_t mismatchCount = 0;
+    uint64_t firstMismatch = UINT64_MAX;
+    for(uint32_t i = 0; i < CHUNK_SIZE; ++i)
+    {
+        if(result[i] != reference[i])
+        {
+            firstMismatch = std::min<uint64_t>(firstMismatch, chunkBegIndex + i);
+            ++mismatchCount;
+        }
+    }
+    v.MismatchCount += mismatchCount;
+    AtomicMin(v.FirstMismatchIndex, firstMismatch);
+}
+
+static void CheckMaskResult(VARIANT& v, uint64_t chunkBegIndex, const uint64_t* result, const uint64_t* reference)
+{
+    if(memcmp(result, reference, CHUNK_SIZE / 8) == 0)
+        return;
+    for(uint32_t i = 0; i < CHUNK_SIZE / 64; ++i)
+    {
+        uint64_t diff = result[i] ^ reference[i];
+        if(diff == 0)
+            continue;
+        AtomicMin(v.FirstMismatchIndex, chunkBegIndex + i * 64 + (uint64_t)IsPowerOfDetail::BitLength(diff & (0 - diff)) - 1);
+        for(; diff; diff &= diff - 1)
+            ++v.MismatchCount;
+    }
+}
+
+static void ThreadFunc()
+{
+    std::vector<int32_t> values(CHUNK_SIZE);
+    std::vector<uint8_t> reference(CHUNK_SIZE);
+    std::vector<uint8_t> result(CHUNK_SIZE);
+    std::vector<uint64_t> referenceMask(CHUNK_SIZE / 64);
+    std::vector<uint64_t> resultMask(CHUNK_SIZE / 64);
+    std::vector<uint64_t> nanoseconds(g_Variants.size());
+
+    for(;;)
+    {
+        const uint32_t chunkIndex = g_NextChunk++;
+        if(chunkIndex >= CHUNK_COUNT)
+            break;
+        const uint64_t begIndex = (uint64_t)chunkIndex * CHUNK_SIZE;
+        const int64_t begValue = (int64_t)begIndex + INT32_MIN;
+
+        for(uint32_t i = 0; i < CHUNK_SIZE; ++i)
+            values[i] = (int32_t)(begValue + i);
+
+        memset(reference.data(), 0, CHUNK_SIZE);
+        memset(referenceMask.data(), 0, CHUNK_SIZE / 8);
+        for(int32_t power : POWERS_OF_10)
+        {
+            const int64_t offset = power - begValue;
+            if(offset >= 0 && offset < CHUNK_SIZE)
+            {
+                reference[(size_t)offset] = 1;
+                referenceMask[(size_t)offset / 64] |= 1ull << (offset % 64);
+            }
+        }
+
+        for(size_t vIndex = 0; vIndex < g_Variants.size(); ++vIndex)
+        {
+            VARIANT& v = *g_Variants[vIndex];
+            const auto timeBeg = std::chrono::steady_clock::now();
+            if(v.Func)
+                v.Func(values.data(), CHUNK_SIZE, result.data());
+            else if(v.Mask)
+                IsLog10_BatchMaskIsa(v.Isa, values.data(), CHUNK_SIZE, resultMask.data());
+            else
+                IsLog10_BatchIsa(v.Isa, values.data(), CHUNK_SIZE, result.data());
+            const auto timeEnd = std::chrono::steady_clock::now();
+            nanoseconds[vIndex] += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(timeEnd - timeBeg).count();
+
+            if(v.Mask)
+                CheckMaskResult(v, begIndex, resultMask.data(), referenceMask.data());
+            else
+                CheckResult(v, begIndex, result.data(), reference.data());
+        }
+    }
+
+    for(size_t vIndex = 0; vIndex < g_Variants.size(); ++vIndex)
+        g_Variants[vIndex]->Nanoseconds += nanoseconds[vIndex];
+}
+
+int main(int argc, char** argv)
+{
+    CreateVariants();
+
+    // Filter variants by names given on command line.
+    if(argc > 1)
+    {
+        std::vector<VARIANT*> selected;
+        for(VARIANT* v : g_Variants)
+        {
+            bool found = false;
+            for(int i = 1; i < argc; ++i)
+                found = found || v->Name == argv[i];
+            if(found)
+                selected.push_back(v);
+            else
+                delete v;
+        }
+        g_Variants.swap(selected);
+        if(g_Variants.empty())
+        {
+            printf("No such variant.\n");
+            return 2;
+        }
+    }
+
+    const uint32_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    printf("Checking %zu variant(s) on all %llu int32_t values using %u thread(s)...\n",
+        g_Variants.size(), (unsigned long long)TOTAL_VALUE_COUNT, threadCount);
+
+    const auto timeBeg = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for(uint32_t i = 0; i < threadCount; ++i)
+        threads.emplace_back(ThreadFunc);
+    for(std::thread& t : threads)
+        t.join();
+    const auto timeEnd = std::chrono::steady_clock::now();
+
+    bool allPassed = true;
+    printf("%-24s %14s %12s %14s\n", "Variant", "CPU time [s]", "Wrong", "First wrong");
+    for(VARIANT* v : g_Variants)
+    {
+        printf("%-24s %14.2f %12llu ", v->Name.c_str(), (double)v->Nanoseconds * 1e-9, (unsigned long long)v->MismatchCount);
+        if(v->MismatchCount > 0)
+        {
+            printf("%14d\n", (int32_t)((int64_t)v->FirstMismatchIndex + INT32_MIN));
+            allPassed = false;
+        }
+        else
+            printf("%14s\n", "-");
+        delete v;
+    }
+    printf("Total time: %.2f s\n", std::chrono::duration<double>(timeEnd - timeBeg).count());
+    if(allPassed)
+        printf("All tests passed.\n");
+
+    return allPassed ? 0 : 1;
+}
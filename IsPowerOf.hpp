@@ -0,0 +1,151 @@
+/*
+IsPowerOf.hpp
+
+Author  : Adam Sawicki, http://asawicki.info, adam__REMOVE__@asawicki.info
+Version : 1.0, 2026-10-19
+License : Public Domain
+
+Generalization of the functions from IsLog10.c to any integer type (8, 16, 32
+or 64-bit, signed or unsigned) and any base, as C++14 templates:
+
+    IsPowerOf<10>(x)    // x can be int32_t, uint64_t, int8_t...
+    IsPowerOf<16>(x)
+    IsPowerOf<1000>(x)
+
+It is branchless and needs no loop. A power of Base >= 2 is at least 2 times
+larger than the previous one, so for every bit length there is at most one power
+of Base having it. A table of these powers, indexed by bit length, is generated
+at compile time. The bit length of x is calculated using a count-leading-zeros
+instruction, and x is a power of Base if and only if it is equal to the table
+entry for its bit length.
+
+Negative numbers are never powers of Base. Zero is not a power of any Base.
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+namespace IsPowerOfDetail
+{
+
+// Returns number of significant bits in x. x must not be zero.
+inline uint32_t BitLength32(uint32_t x)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse(&index, x);
+    return (uint32_t)index + 1;
+#else
+    return 32u - (uint32_t)__builtin_clz(x);
+#endif
+}
+
+inline uint32_t BitLength64(uint64_t x)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, x);
+    return (uint32_t)index + 1;
+#elif defined(_MSC_VER)
+    const uint32_t hi = (uint32_t)(x >> 32);
+    return hi ? BitLength32(hi) + 32 : BitLength32((uint32_t)x);
+#else
+    return 64u - (uint32_t)__builtin_clzll(x);
+#endif
+}
+
+template<typename U>
+inline uint32_t BitLength(U x)
+{
+    return sizeof(U) <= 4 ? BitLength32((uint32_t)x) : BitLength64((uint64_t)x);
+}
+
+/*
+Table of powers of Base representable in T, indexed by bit length.
+Entry at bit length with no power of Base is 0, which can never be equal to
+a value of that (nonzero) bit length.
+*/
+template<uint64_t Base, typename T>
+struct PowerTable
+{
+    static_assert(std::is_integral<T>::value && !std::is_same<T, bool>::value, "T must be an integer type.");
+    static_assert(Base >= 2, "Base must be at least 2.");
+
+    typedef typename std::make_unsigned<T>::type U;
+    static constexpr uint32_t BitCount = sizeof(T) * 8;
+    // Largest value of type T, as unsigned.
+    static constexpr U MaxValue = (U)std::numeric_limits<T>::max();
+
+    // Index 0 is never used, as x is checked with bit 0 forced to 1.
+    U Values[BitCount + 1];
+    // Number of powers of Base representable in T.
+    uint32_t Count;
+
+    constexpr PowerTable() : Values(), Count(0)
+    {
+        uint64_t power = 1;
+        for(;;)
+        {
+            uint32_t bitLength = 0;
+            for(uint64_t tmp = power; tmp; tmp >>= 1)
+                ++bitLength;
+            Values[bitLength] = (U)power;
+            ++Count;
+            if(power > (uint64_t)MaxValue / Base)
+                break;
+            power *= Base;
+        }
+    }
+};
+
+template<uint64_t Base, typename T>
+struct PowerTableInstance
+{
+    static constexpr PowerTable<Base, T> Table = PowerTable<Base, T>();
+};
+
+template<uint64_t Base, typename T>
+constexpr PowerTable<Base, T> PowerTableInstance<Base, T>::Table;
+
+} // namespace IsPowerOfDetail
+
+/*
+Returns true if x is equal to Base^n for some integer n >= 0.
+*/
+template<uint64_t Base, typename T>
+inline bool IsPowerOf(T x)
+{
+    typedef IsPowerOfDetail::PowerTable<Base, T> TableType;
+    typedef typename TableType::U U;
+    const U u = (U)x;
+    // Forcing bit 0 doesn't change bit length of nonzero values and makes it
+    // 1 for zero, whose table entry (Base^0 = 1) is not equal to 0.
+    // Negative values have the highest bit set, and no power fits there in
+    // signed T, so they compare with entry 0.
+    const uint32_t bitLength = IsPowerOfDetail::BitLength((U)(u | 1u));
+    return IsPowerOfDetail::PowerTableInstance<Base, T>::Table.Values[bitLength] == u;
+}
+
+// Returns number of powers of Base representable in type T, e.g. 10 for base 10
+// and int32_t: from 1 to 1000000000.
+template<uint64_t Base, typename T>
+constexpr uint32_t GetPowerCount()
+{
+    return IsPowerOfDetail::PowerTable<Base, T>().Count;
+}
+
+static_assert(GetPowerCount<10, int32_t>() == 10, "");
+static_assert(GetPowerCount<10, uint32_t>() == 10, "");
+static_assert(GetPowerCount<10, int64_t>() == 19, "");
+static_assert(GetPowerCount<10, uint64_t>() == 20, "");
+static_assert(GetPowerCount<2, int8_t>() == 7, "");
+static_assert(GetPowerCount<2, uint64_t>() == 64, "");
+static_assert(GetPowerCount<16, uint16_t>() == 4, "");
+static_assert(GetPowerCount<1000, int64_t>() == 7, "");
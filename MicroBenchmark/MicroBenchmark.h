@@ -0,0 +1,1012 @@
+/*
+MicroBenchmark.h
+
+Author:  Adam Sawicki, http://asawicki.info, adam__REMOVE__@asawicki.info
+Version: 1.1.0, 2026-10-19
+License: Public Domain
+
+This is a simple, single-header, C++ library for measuring how long it takes to
+execute a short piece of code. It grew out of QueryPerformanceCounterTest.cpp,
+which measured a fixed loop with GetTickCount64 and reported just one mean.
+This library additionally:
+
+- Warms up the code before measuring.
+- Automatically selects number of iterations so that each sample lasts long
+  enough to be measured precisely.
+- Measures overhead of the timer itself and subtracts it from every sample.
+- Pins current thread to one CPU core and detects if CPU frequency changed
+  during the measurement (e.g. due to power saving or turbo boost).
+- Rejects outlier samples and calculates 95% confidence interval of the mean.
+- On Linux, reads hardware performance counters (cycles, instructions, branch
+  misses, cache and TLB misses) through perf_event_open and reports them per
+  iteration, together with IPC.
+- Prints results as a human-readable table, CSV or JSON.
+
+It works on Windows (using QueryPerformanceCounter) and Linux (using
+clock_gettime with CLOCK_MONOTONIC).
+
+How to use it:
+
+1. In any CPP file where you want to use the library:
+   #include "MicroBenchmark.h"
+2. In exactly one CPP file, define following macro before that include:
+   #define MICRO_BENCHMARK_IMPLEMENTATION
+3. Create object of type MicroBenchmark::Runner, optionally passing
+   MicroBenchmark::CONFIG to it.
+4. Call method Run for each piece of code you want to measure, passing a name
+   and a function object. The function object is called once per iteration.
+   Pass values it calculates to MicroBenchmark::DoNotOptimize so the compiler
+   doesn't optimize the code out.
+5. Call PrintResults, WriteCsv or WriteJson.
+
+Example:
+
+    MicroBenchmark::Runner runner;
+    int32_t x = 1000;
+    runner.Run("IsLog10_v5", [&]() {
+        MicroBenchmark::DoNotOptimize(x);
+        MicroBenchmark::DoNotOptimize(IsLog10_v5(x));
+    });
+    runner.PrintResults(stdout);
+
+All times reported are in nanoseconds per single iteration.
+
+Hardware performance counters:
+
+Class MicroBenchmark::PerfCounters can also be used on its own, to measure any
+marked region of code:
+
+    MicroBenchmark::PerfCounters counters;
+    uint64_t beg[MicroBenchmark::COUNTER_COUNT], end[MicroBenchmark::COUNTER_COUNT];
+    counters.Read(beg);
+    // ... code to measure ...
+    counters.Read(end);
+
+Counters are opened for the calling thread only, counting user-space events.
+When the kernel allows user-space access to counters
+(/sys/bus/event_source/devices/cpu/rdpmc is 1 or 2), they are read with rdpmc
+instruction, which takes tens of cycles. Otherwise they are read with a single
+read() system call for the whole group. If perf_event_open is not permitted
+(see /proc/sys/kernel/perf_event_paranoid) or on other platforms, counters
+are reported as not available.
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+
+namespace MicroBenchmark
+{
+
+// Returns current value of high-resolution monotonic timer, in ticks.
+uint64_t GetTimestamp();
+// Returns number of timer ticks per second.
+uint64_t GetTimestampFrequency();
+
+// Makes the compiler believe that value is used, so it cannot optimize out the
+// code that calculates it.
+template<typename T>
+inline void DoNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    const volatile char* volatile sink = (const volatile char*)&value;
+    (void)sink;
+    _ReadWriteBarrier();
+#endif
+}
+
+// Makes the compiler believe that all memory may have been read and written.
+inline void ClobberMemory()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#else
+    _ReadWriteBarrier();
+#endif
+}
+
+enum COUNTER
+{
+    COUNTER_CYCLES,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_BRANCH_MISSES,
+    COUNTER_L1D_MISSES, // L1 data cache read misses.
+    COUNTER_LLC_MISSES, // Last level cache read misses.
+    COUNTER_DTLB_MISSES, // Data TLB read misses.
+    COUNTER_COUNT
+};
+
+// Returns short name of the counter, like "Cycles".
+const char* GetCounterName(COUNTER counter);
+
+/*
+Represents a set of hardware performance counters opened for the calling
+thread. Must be used only from the thread that created it.
+*/
+class PerfCounters
+{
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    bool IsAvailable(COUNTER counter) const { return m_Fds[counter] >= 0; }
+    bool IsAnyAvailable() const { return m_Fds[COUNTER_CYCLES] >= 0; }
+    // True if counters are read with rdpmc instruction instead of system call.
+    bool UsesRdpmc() const { return m_UseRdpmc; }
+
+    /*
+    Fetches current values of all counters. Values of counters that are not
+    available are set to 0. Only differences between two calls are meaningful,
+    and only if both calls returned the same value: true means raw rdpmc
+    values, false means values read with system call and scaled for
+    multiplexing. Pass allowRdpmc = false to force the system call, e.g. to
+    match the other end of an interval.
+    */
+    bool Read(uint64_t outValues[COUNTER_COUNT], bool allowRdpmc = true);
+
+private:
+    int m_Fds[COUNTER_COUNT];
+    void* m_MmapPages[COUNTER_COUNT];
+    uint32_t m_GroupCounters[COUNTER_COUNT]; // Counter index for each position in the group.
+    uint32_t m_GroupSize;
+    bool m_UseRdpmc;
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool ReadRdpmc(uint64_t outValues[COUNTER_COUNT]);
+    void ReadSyscall(uint64_t outValues[COUNTER_COUNT]);
+};
+
+struct CONFIG
+{
+    // Time spent executing the code before any measurement, in seconds.
+    double WarmupSeconds = 0.2;
+    // Desired duration of a single sample, in seconds. Used to select number
+    // of iterations per sample when IterationCount is 0.
+    double TargetSampleSeconds = 0.01;
+    // Number of iterations per sample. 0 means automatic selection.
+    uint64_t IterationCount = 0;
+    // Number of samples to collect.
+    uint32_t SampleCount = 31;
+    // Index of logical CPU to pin current thread to during measurement.
+    // -1 means don't change thread affinity.
+    int PinCpuIndex = 0;
+    // Samples further from the median than this many scaled median absolute
+    // deviations are rejected as outliers. 0 disables rejection.
+    double OutlierThreshold = 3.0;
+    // Relative change of CPU speed between beginning and end of a benchmark
+    // above which the result is marked with FrequencyChangeDetected.
+    double FrequencyChangeThreshold = 0.05;
+    // Measure hardware performance counters where available.
+    bool UsePerfCounters = true;
+};
+
+struct RESULT
+{
+    std::string Name;
+    uint64_t IterationCount; // Per sample.
+    uint32_t SampleCount; // Accepted samples.
+    uint32_t RejectedSampleCount; // Samples rejected as outliers.
+    double TimerOverheadNs; // Subtracted from every sample, per sample.
+    // Statistics of accepted samples, per single iteration.
+    double MeanNs;
+    double MedianNs;
+    double MinNs;
+    double MaxNs;
+    double StdDevNs;
+    double ConfidenceLowNs; // Lower bound of 95% confidence interval of the mean.
+    double ConfidenceHighNs; // Upper bound of 95% confidence interval of the mean.
+    // True if CPU speed measured before and after the benchmark differs.
+    bool FrequencyChangeDetected;
+    // Average value of hardware performance counters per single iteration,
+    // over all samples. Valid only where CountersAvailable is true.
+    bool CountersAvailable[COUNTER_COUNT];
+    double Counters[COUNTER_COUNT];
+    // Instructions per cycle. 0 if not available.
+    double Ipc;
+};
+
+class Runner
+{
+public:
+    explicit Runner(const CONFIG& config = CONFIG());
+    // Restores original thread affinity.
+    ~Runner();
+
+    const CONFIG& GetConfig() const { return m_Config; }
+    // Overhead of a single pair of timer calls, in nanoseconds.
+    double GetTimerOverheadNs() const { return m_TimerOverheadNs; }
+    // Empty if not available. On Linux it is content of scaling_governor of
+    // the CPU used, e.g. "performance" or "powersave".
+    const std::string& GetFrequencyGovernor() const { return m_FrequencyGovernor; }
+    // Null if CONFIG::UsePerfCounters was false or counters are not available.
+    PerfCounters* GetPerfCounters() const { return m_PerfCounters; }
+
+    /*
+    Measures given function object, which is called once per iteration with
+    no parameters. Returns the result, which is also appended to the list
+    returned by GetResults.
+    */
+    template<typename Func>
+    const RESULT& Run(const char* name, Func func);
+
+    const std::vector<RESULT>& GetResults() const { return m_Results; }
+    void ClearResults() { m_Results.clear(); }
+
+    void PrintResults(FILE* file) const;
+    void WriteCsv(FILE* file) const;
+    void WriteJson(FILE* file) const;
+
+private:
+    CONFIG m_Config;
+    double m_NsPerTick;
+    uint64_t m_TimerOverheadTicks;
+    double m_TimerOverheadNs;
+    std::string m_FrequencyGovernor;
+    PerfCounters* m_PerfCounters;
+    bool m_AffinityChanged;
+    uint64_t m_OriginalAffinity[16];
+    std::vector<RESULT> m_Results;
+
+    template<typename Func>
+    uint64_t MeasureSample(Func& func, uint64_t iterationCount);
+    template<typename Func>
+    uint64_t SelectIterationCount(Func& func);
+
+    void PinThread();
+    void RestoreThreadAffinity();
+    void MeasureTimerOverhead();
+    // Returns time of executing a fixed chain of dependent arithmetic
+    // instructions, in nanoseconds. Changes when CPU frequency changes.
+    double MeasureCpuSpeed();
+    void Finish(RESULT& result, std::vector<double>& sampleNs, double cpuSpeedBefore);
+    void FinishCounters(RESULT& result, const uint64_t counterSums[COUNTER_COUNT], uint32_t counterSampleCount);
+};
+
+template<typename Func>
+uint64_t Runner::MeasureSample(Func& func, uint64_t iterationCount)
+{
+    const uint64_t beg = GetTimestamp();
+    for(uint64_t i = 0; i < iterationCount; ++i)
+        func();
+    const uint64_t end = GetTimestamp();
+    const uint64_t elapsed = end - beg;
+    return elapsed > m_TimerOverheadTicks ? elapsed - m_TimerOverheadTicks : 0;
+}
+
+template<typename Func>
+uint64_t Runner::SelectIterationCount(Func& func)
+{
+    if(m_Config.IterationCount > 0)
+        return m_Config.IterationCount;
+    const double targetNs = m_Config.TargetSampleSeconds * 1e9;
+    uint64_t iterationCount = 1;
+    for(;;)
+    {
+        const double sampleNs = (double)MeasureSample(func, iterationCount) * m_NsPerTick;
+        if(sampleNs >= targetNs || iterationCount >= (UINT64_MAX >> 2))
+            break;
+        // Grow geometrically, but jump straight to the estimate once the
+        // sample is long enough to be trusted.
+        if(sampleNs * 100.0 >= targetNs)
+        {
+            const double estimate = (double)iterationCount * targetNs / sampleNs * 1.1;
+            iterationCount = estimate > (double)iterationCount * 2.0 ? (uint64_t)estimate : iterationCount * 2;
+        }
+        else
+            iterationCount *= 10;
+    }
+    return iterationCount;
+}
+
+template<typename Func>
+const RESULT& Runner::Run(const char* name, Func func)
+{
+    RESULT result = {};
+    result.Name = name;
+
+    const double cpuSpeedBefore = MeasureCpuSpeed();
+
+    // Warmup.
+    const double warmupNs = m_Config.WarmupSeconds * 1e9;
+    const uint64_t warmupBeg = GetTimestamp();
+    while((double)(GetTimestamp() - warmupBeg) * m_NsPerTick < warmupNs)
+        func();
+
+    result.IterationCount = SelectIterationCount(func);
+
+    // Counters are read outside of the timed region, so they don't add to the
+    // time, while the timer calls they include are negligible for a sample.
+    uint64_t counterSums[COUNTER_COUNT] = {};
+    uint32_t counterSampleCount = 0;
+    uint64_t countersBeg[COUNTER_COUNT], countersEnd[COUNTER_COUNT];
+    bool rdpmcBeg = false;
+    std::vector<double> sampleNs(m_Config.SampleCount);
+    for(uint32_t i = 0; i < m_Config.SampleCount; ++i)
+    {
+        if(m_PerfCounters)
+            rdpmcBeg = m_PerfCounters->Read(countersBeg);
+        sampleNs[i] = (double)MeasureSample(func, result.IterationCount) * m_NsPerTick;
+        if(m_PerfCounters)
+        {
+            // Raw rdpmc values can't be subtracted from scaled system call
+            // values. If the begin fell back to the system call, so does the
+            // end. If only the end fell back, the sample's counters are dropped.
+            const bool rdpmcEnd = m_PerfCounters->Read(countersEnd, rdpmcBeg);
+            if(rdpmcEnd == rdpmcBeg)
+            {
+                for(uint32_t c = 0; c < COUNTER_COUNT; ++c)
+                    counterSums[c] += countersEnd[c] > countersBeg[c] ? countersEnd[c] - countersBeg[c] : 0;
+                ++counterSampleCount;
+            }
+        }
+    }
+
+    Finish(result, sampleNs, cpuSpeedBefore);
+    FinishCounters(result, counterSums, counterSampleCount);
+    m_Results.push_back(result);
+    return m_Results.back();
+}
+
+} // namespace MicroBenchmark
+
+// For Visual Studio IntelliSense.
+#ifdef __INTELLISENSE__
+#define MICRO_BENCHMARK_IMPLEMENTATION
+#endif
+
+#ifdef MICRO_BENCHMARK_IMPLEMENTATION
+#undef MICRO_BENCHMARK_IMPLEMENTATION
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <Windows.h>
+#else
+    #include <sched.h>
+    #include <time.h>
+#endif
+
+#ifdef __linux__
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace MicroBenchmark
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// Global functions
+
+#ifdef _WIN32
+
+uint64_t GetTimestamp()
+{
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)counter.QuadPart;
+}
+
+uint64_t GetTimestampFrequency()
+{
+    LARGE_INTEGER freq;
+    QueryPerformanceFrequency(&freq);
+    return (uint64_t)freq.QuadPart;
+}
+
+#else
+
+uint64_t GetTimestamp()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t GetTimestampFrequency()
+{
+    return 1000000000ull;
+}
+
+#endif
+
+static const char* const COUNTER_NAMES[COUNTER_COUNT] = {
+    "Cycles",
+    "Instructions",
+    "BranchMisses",
+    "L1DMisses",
+    "LLCMisses",
+    "DTLBMisses",
+};
+
+const char* GetCounterName(COUNTER counter)
+{
+    assert(counter < COUNTER_COUNT);
+    return COUNTER_NAMES[counter];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal functions
+
+// Two-sided 95% critical values of Student's t-distribution for 1..30 degrees
+// of freedom. Above that, normal distribution is close enough.
+static const double STUDENT_T_95[30] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+};
+
+static double CalcMedian(std::vector<double> values)
+{
+    assert(!values.empty());
+    std::sort(values.begin(), values.end());
+    const size_t n = values.size();
+    return (n % 2) ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) * 0.5;
+}
+
+static void WriteJsonString(FILE* file, const std::string& str)
+{
+    fputc('"', file);
+    for(char ch : str)
+    {
+        if(ch == '"' || ch == '\\')
+            fprintf(file, "\\%c", ch);
+        else if((unsigned char)ch < 0x20)
+            fprintf(file, "\\u%04x", (unsigned)ch);
+        else
+            fputc(ch, file);
+    }
+    fputc('"', file);
+}
+
+static void WriteCsvString(FILE* file, const std::string& str)
+{
+    fputc('"', file);
+    for(char ch : str)
+    {
+        if(ch == '"')
+            fputc('"', file);
+        fputc(ch, file);
+    }
+    fputc('"', file);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// class PerfCounters
+
+#ifdef __linux__
+
+static int OpenPerfEvent(uint32_t type, uint64_t config, int groupFd)
+{
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = groupFd < 0 ? 1 : 0; // Group leader starts the whole group.
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
+
+static uint64_t MakeCacheConfig(uint64_t cache, uint64_t op, uint64_t result)
+{
+    return cache | (op << 8) | (result << 16);
+}
+
+PerfCounters::PerfCounters() :
+    m_GroupSize(0),
+    m_UseRdpmc(false)
+{
+    for(uint32_t i = 0; i < COUNTER_COUNT; ++i)
+    {
+        m_Fds[i] = -1;
+        m_MmapPages[i] = nullptr;
+    }
+
+    struct EventDesc { uint32_t type; uint64_t config; };
+    const EventDesc events[COUNTER_COUNT] = {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        { PERF_TYPE_HW_CACHE, MakeCacheConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+        { PERF_TYPE_HW_CACHE, MakeCacheConfig(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+        { PERF_TYPE_HW_CACHE, MakeCacheConfig(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+    };
+
+    // Cycles is the group leader. Without it nothing else is opened.
+    // Counters not supported by the CPU are just skipped.
+    for(uint32_t i = 0; i < COUNTER_COUNT; ++i)
+    {
+        m_Fds[i] = OpenPerfEvent(events[i].type, events[i].config, i == 0 ? -1 : m_Fds[0]);
+        if(m_Fds[i] < 0)
+        {
+            if(i == 0)
+                return;
+            continue;
+        }
+        m_GroupCounters[m_GroupSize++] = i;
+    }
+
+    // rdpmc can be used only if all counters allow it.
+    m_UseRdpmc = true;
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    for(uint32_t i = 0; i < COUNTER_COUNT; ++i)
+    {
+        if(m_Fds[i] < 0)
+            continue;
+        void* page = mmap(nullptr, (size_t)pageSize, PROT_READ, MAP_SHARED, m_Fds[i], 0);
+        if(page == MAP_FAILED)
+        {
+            m_UseRdpmc = false;
+            continue;
+        }
+        m_MmapPages[i] = page;
+        if(!((const perf_event_mmap_page*)page)->cap_user_rdpmc)
+            m_UseRdpmc = false;
+    }
+#if !defined(__x86_64__) && !defined(__i386__)
+    m_UseRdpmc = false;
+#endif
+
+    ioctl(m_Fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(m_Fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfCounters::~PerfCounters()
+{
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    // Group leader closed last.
+    for(uint32_t i = COUNTER_COUNT; i--; )
+    {
+        if(m_MmapPages[i])
+            munmap(m_MmapPages[i], (size_t)pageSize);
+        if(m_Fds[i] >= 0)
+            close(m_Fds[i]);
+    }
+}
+
+bool PerfCounters::Read(uint64_t outValues[COUNTER_COUNT], bool allowRdpmc)
+{
+    if(m_UseRdpmc && allowRdpmc && ReadRdpmc(outValues))
+        return true;
+    ReadSyscall(outValues);
+    return false;
+}
+
+bool PerfCounters::ReadRdpmc(uint64_t outValues[COUNTER_COUNT])
+{
+#if defined(__x86_64__) || defined(__i386__)
+    // Lock-free protocol described in linux/perf_event.h, struct perf_event_mmap_page.
+    for(uint32_t i = 0; i < COUNTER_COUNT; ++i)
+    {
+        const volatile perf_event_mmap_page* const pc = (const volatile perf_event_mmap_page*)m_MmapPages[i];
+        if(!pc)
+        {
+            outValues[i] = 0;
+            continue;
+        }
+        uint32_t seq;
+        uint64_t count;
+        do
+        {
+            seq = pc->lock;
+            ClobberMemory();
+            const uint32_t index = pc->index;
+            // Counter not currently scheduled on the PMU, e.g. multiplexed.
+            if(index == 0)
+                return false;
+            count = (uint64_t)pc->offset;
+            uint32_t lo, hi;
+            asm volatile("rdpmc" : "=a"(lo), "=d"(hi) : "c"(index - 1));
+            const uint32_t width = pc->pmc_width;
+            if(width == 0 || width > 64)
+                return false;
+            const uint32_t shift = 64 - width;
+            int64_t pmc = (int64_t)(((uint64_t)hi << 32) | lo);
+            if(shift > 0)
+                pmc = (int64_t)((uint64_t)pmc << shift) >> shift;
+            count += (uint64_t)pmc;
+            ClobberMemory();
+        } while(pc->lock != seq);
+        outValues[i] = count;
+    }
+    return true;
+#else
+    (void)outValues;
+    return false;
+#endif
+}
+
+void PerfCounters::ReadSyscall(uint64_t outValues[COUNTER_COUNT])
+{
+    for(uint32_t i = 0; i < COUNTER_COUNT; ++i)
+        outValues[i] = 0;
+    if(m_GroupSize == 0)
+        return;
+
+    // Format: nr, time_enabled, time_running, values[nr].
+    uint64_t data[3 + COUNTER_COUNT];
+    const ssize_t readSize = read(m_Fds[0], data, sizeof(data));
+    if(readSize < (ssize_t)(3 * sizeof(uint64_t)))
+        return;
+    const uint64_t count = (std::min<uint64_t>)(data[0], m_GroupSize);
+    const uint64_t timeEnabled = data[1];
+    const uint64_t timeRunning = data[2];
+    // Scale if counters were multiplexed with other users of the PMU.
+    const double scale = (timeRunning > 0 && timeRunning < timeEnabled) ?
+        (double)timeEnabled / (double)timeRunning : 1.0;
+    for(uint64_t i = 0; i < count; ++i)
+        outValues[m_GroupCounters[i]] = (uint64_t)((double)data[3 + i] * scale);
+}
+
+#else // #ifdef __linux__
+
+PerfCounters::PerfCounters() :
+    m_GroupSize(0),
+    m_UseRdpmc(false)
+{
+    for(uint32_t i = 0; i < COUNTER_COUNT; ++i)
+    {
+        m_Fds[i] = -1;
+        m_MmapPages[i] = nullptr;
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+}
+
+bool PerfCounters::Read(uint64_t outValues[COUNTER_COUNT], bool allowRdpmc)
+{
+    (void)allowRdpmc;
+    for(uint32_t i = 0; i < COUNTER_COUNT; ++i)
+        outValues[i] = 0;
+    return false;
+}
+
+bool PerfCounters::ReadRdpmc(uint64_t outValues[COUNTER_COUNT])
+{
+    (void)outValues;
+    return false;
+}
+
+void PerfCounters::ReadSyscall(uint64_t outValues[COUNTER_COUNT])
+{
+    Read(outValues);
+}
+
+#endif // #ifdef __linux__
+
+////////////////////////////////////////////////////////////////////////////////
+// class Runner
+
+Runner::Runner(const CONFIG& config) :
+    m_Config(config),
+    m_NsPerTick(1e9 / (double)GetTimestampFrequency()),
+    m_TimerOverheadTicks(0),
+    m_TimerOverheadNs(0.0),
+    m_PerfCounters(nullptr),
+    m_AffinityChanged(false),
+    m_OriginalAffinity()
+{
+    if(m_Config.SampleCount == 0)
+        m_Config.SampleCount = 1;
+    PinThread();
+    MeasureTimerOverhead();
+    if(m_Config.UsePerfCounters)
+    {
+        m_PerfCounters = new PerfCounters();
+        if(!m_PerfCounters->IsAnyAvailable())
+        {
+            delete m_PerfCounters;
+            m_PerfCounters = nullptr;
+        }
+    }
+}
+
+Runner::~Runner()
+{
+    delete m_PerfCounters;
+    RestoreThreadAffinity();
+}
+
+#ifdef _WIN32
+
+void Runner::PinThread()
+{
+    if(m_Config.PinCpuIndex < 0 || m_Config.PinCpuIndex >= (int)(sizeof(DWORD_PTR) * 8))
+        return;
+    const DWORD_PTR prevMask = SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << m_Config.PinCpuIndex);
+    if(prevMask != 0)
+    {
+        m_OriginalAffinity[0] = (uint64_t)prevMask;
+        m_AffinityChanged = true;
+    }
+}
+
+void Runner::RestoreThreadAffinity()
+{
+    if(m_AffinityChanged)
+        SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)m_OriginalAffinity[0]);
+}
+
+#else
+
+void Runner::PinThread()
+{
+    if(m_Config.PinCpuIndex < 0 || m_Config.PinCpuIndex >= CPU_SETSIZE)
+        return;
+
+    cpu_set_t prevSet;
+    static_assert(sizeof(prevSet) <= sizeof(m_OriginalAffinity), "cpu_set_t too large.");
+    if(sched_getaffinity(0, sizeof(prevSet), &prevSet) != 0)
+        return;
+    cpu_set_t newSet;
+    CPU_ZERO(&newSet);
+    CPU_SET(m_Config.PinCpuIndex, &newSet);
+    if(sched_setaffinity(0, sizeof(newSet), &newSet) != 0)
+        return;
+    memcpy(m_OriginalAffinity, &prevSet, sizeof(prevSet));
+    m_AffinityChanged = true;
+
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor", m_Config.PinCpuIndex);
+    if(FILE* file = fopen(path, "r"))
+    {
+        char governor[64] = {};
+        if(fgets(governor, sizeof(governor), file))
+        {
+            governor[strcspn(governor, "\r\n")] = '\0';
+            m_FrequencyGovernor = governor;
+        }
+        fclose(file);
+    }
+}
+
+void Runner::RestoreThreadAffinity()
+{
+    if(m_AffinityChanged)
+    {
+        cpu_set_t prevSet;
+        memcpy(&prevSet, m_OriginalAffinity, sizeof(prevSet));
+        sched_setaffinity(0, sizeof(prevSet), &prevSet);
+    }
+}
+
+#endif
+
+void Runner::MeasureTimerOverhead()
+{
+    // Minimum is the best estimate - anything above it is noise.
+    uint64_t minTicks = UINT64_MAX;
+    for(uint32_t i = 0; i < 10000; ++i)
+    {
+        const uint64_t beg = GetTimestamp();
+        const uint64_t end = GetTimestamp();
+        minTicks = (std::min)(minTicks, end - beg);
+    }
+    m_TimerOverheadTicks = minTicks;
+    m_TimerOverheadNs = (double)minTicks * m_NsPerTick;
+}
+
+double Runner::MeasureCpuSpeed()
+{
+    double minNs = 1e300;
+    for(uint32_t sampleIndex = 0; sampleIndex < 5; ++sampleIndex)
+    {
+        uint64_t x = 1;
+        const uint64_t beg = GetTimestamp();
+        for(uint32_t i = 0; i < 1000000; ++i)
+        {
+            x = x * 6364136223846793005ull + 1442695040888963407ull;
+            DoNotOptimize(x);
+        }
+        const uint64_t end = GetTimestamp();
+        minNs = (std::min)(minNs, (double)(end - beg) * m_NsPerTick);
+    }
+    return minNs;
+}
+
+void Runner::Finish(RESULT& result, std::vector<double>& sampleNs, double cpuSpeedBefore)
+{
+    const double cpuSpeedAfter = MeasureCpuSpeed();
+    result.FrequencyChangeDetected =
+        std::fabs(cpuSpeedAfter - cpuSpeedBefore) > cpuSpeedBefore * m_Config.FrequencyChangeThreshold;
+    result.TimerOverheadNs = m_TimerOverheadNs;
+
+    // Convert to time per iteration.
+    const double iterationCountInv = 1.0 / (double)result.IterationCount;
+    for(double& ns : sampleNs)
+        ns *= iterationCountInv;
+
+    // Reject outliers using median absolute deviation, which unlike standard
+    // deviation is not itself distorted by the outliers.
+    const size_t totalCount = sampleNs.size();
+    if(m_Config.OutlierThreshold > 0.0 && totalCount >= 3)
+    {
+        const double median = CalcMedian(sampleNs);
+        std::vector<double> deviations(totalCount);
+        for(size_t i = 0; i < totalCount; ++i)
+            deviations[i] = std::fabs(sampleNs[i] - median);
+        // 1.4826 makes MAD consistent with standard deviation for normal distribution.
+        const double maxDeviation = CalcMedian(deviations) * 1.4826 * m_Config.OutlierThreshold;
+        if(maxDeviation > 0.0)
+        {
+            sampleNs.erase(
+                std::remove_if(sampleNs.begin(), sampleNs.end(),
+                    [=](double ns) { return std::fabs(ns - median) > maxDeviation; }),
+                sampleNs.end());
+        }
+    }
+    result.SampleCount = (uint32_t)sampleNs.size();
+    result.RejectedSampleCount = (uint32_t)(totalCount - sampleNs.size());
+
+    const size_t n = sampleNs.size();
+    double sum = 0.0;
+    result.MinNs = sampleNs[0];
+    result.MaxNs = sampleNs[0];
+    for(double ns : sampleNs)
+    {
+        sum += ns;
+        result.MinNs = (std::min)(result.MinNs, ns);
+        result.MaxNs = (std::max)(result.MaxNs, ns);
+    }
+    result.MeanNs = sum / (double)n;
+    result.MedianNs = CalcMedian(sampleNs);
+
+    double sumSqDiff = 0.0;
+    for(double ns : sampleNs)
+        sumSqDiff += (ns - result.MeanNs) * (ns - result.MeanNs);
+    result.StdDevNs = n > 1 ? std::sqrt(sumSqDiff / (double)(n - 1)) : 0.0;
+
+    const double t = n > 1 ? (n - 1 <= 30 ? STUDENT_T_95[n - 2] : 1.96) : 0.0;
+    const double halfWidth = t * result.StdDevNs / std::sqrt((double)n);
+    result.ConfidenceLowNs = result.MeanNs - halfWidth;
+    result.ConfidenceHighNs = result.MeanNs + halfWidth;
+}
+
+void Runner::FinishCounters(RESULT& result, const uint64_t counterSums[COUNTER_COUNT], uint32_t counterSampleCount)
+{
+    // Counters can't reject outliers sample by sample, so they are averaged
+    // over all samples that were read consistently.
+    const double totalIterationCount = (double)result.IterationCount * (double)counterSampleCount;
+    for(uint32_t c = 0; c < COUNTER_COUNT; ++c)
+    {
+        result.CountersAvailable[c] = m_PerfCounters && m_PerfCounters->IsAvailable((COUNTER)c) &&
+            counterSampleCount > 0;
+        result.Counters[c] = result.CountersAvailable[c] ? (double)counterSums[c] / totalIterationCount : 0.0;
+    }
+    result.Ipc = 0.0;
+    if(result.CountersAvailable[COUNTER_INSTRUCTIONS] && result.Counters[COUNTER_CYCLES] > 0.0)
+        result.Ipc = result.Counters[COUNTER_INSTRUCTIONS] / result.Counters[COUNTER_CYCLES];
+}
+
+void Runner::PrintResults(FILE* file) const
+{
+    fprintf(file, "Timer overhead: %g ns\n", m_TimerOverheadNs);
+    if(!m_FrequencyGovernor.empty() && m_FrequencyGovernor != "performance")
+        fprintf(file, "Warning: CPU frequency governor is \"%s\", not \"performance\". Results may be unstable.\n",
+            m_FrequencyGovernor.c_str());
+    if(m_PerfCounters)
+        fprintf(file, "Performance counters read using: %s\n", m_PerfCounters->UsesRdpmc() ? "rdpmc" : "read()");
+    fprintf(file, "%-32s %14s %12s %12s %12s %25s %9s",
+        "Name", "Iterations", "Mean [ns]", "Median [ns]", "Min [ns]", "95% CI [ns]", "Rejected");
+    if(m_PerfCounters)
+    {
+        fprintf(file, " %6s", "IPC");
+        for(uint32_t c = 0; c < COUNTER_COUNT; ++c)
+            fprintf(file, " %12s", COUNTER_NAMES[c]);
+    }
+    fprintf(file, "\n");
+    for(const RESULT& r : m_Results)
+    {
+        char ciStr[64];
+        snprintf(ciStr, sizeof(ciStr), "%.4g..%.4g", r.ConfidenceLowNs, r.ConfidenceHighNs);
+        fprintf(file, "%-32s %14llu %12.4g %12.4g %12.4g %25s %4u/%-4u",
+            r.Name.c_str(),
+            (unsigned long long)r.IterationCount,
+            r.MeanNs, r.MedianNs, r.MinNs,
+            ciStr,
+            r.RejectedSampleCount, r.SampleCount + r.RejectedSampleCount);
+        if(m_PerfCounters)
+        {
+            fprintf(file, " %6.3g", r.Ipc);
+            for(uint32_t c = 0; c < COUNTER_COUNT; ++c)
+            {
+                if(r.CountersAvailable[c])
+                    fprintf(file, " %12.4g", r.Counters[c]);
+                else
+                    fprintf(file, " %12s", "-");
+            }
+        }
+        fprintf(file, "%s\n", r.FrequencyChangeDetected ? " (CPU frequency changed!)" : "");
+    }
+    if(m_PerfCounters)
+        fprintf(file, "Counters are per single iteration.\n");
+}
+
+void Runner::WriteCsv(FILE* file) const
+{
+    fprintf(file, "Name,IterationCount,SampleCount,RejectedSampleCount,TimerOverheadNs,"
+        "MeanNs,MedianNs,MinNs,MaxNs,StdDevNs,ConfidenceLowNs,ConfidenceHighNs,FrequencyChangeDetected,Ipc");
+    for(uint32_t c = 0; c < COUNTER_COUNT; ++c)
+        fprintf(file, ",%s", COUNTER_NAMES[c]);
+    fprintf(file, "\n");
+    for(const RESULT& r : m_Results)
+    {
+        WriteCsvString(file, r.Name);
+        fprintf(file, ",%llu,%u,%u,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%d,",
+            (unsigned long long)r.IterationCount,
+            r.SampleCount,
+            r.RejectedSampleCount,
+            r.TimerOverheadNs,
+            r.MeanNs, r.MedianNs, r.MinNs, r.MaxNs, r.StdDevNs,
+            r.ConfidenceLowNs, r.ConfidenceHighNs,
+            r.FrequencyChangeDetected ? 1 : 0);
+        // Counters that are not available are left empty.
+        if(r.Ipc > 0.0)
+            fprintf(file, "%.9g", r.Ipc);
+        for(uint32_t c = 0; c < COUNTER_COUNT; ++c)
+        {
+            if(r.CountersAvailable[c])
+                fprintf(file, ",%.9g", r.Counters[c]);
+            else
+                fprintf(file, ",");
+        }
+        fprintf(file, "\n");
+    }
+}
+
+void Runner::WriteJson(FILE* file) const
+{
+    fprintf(file, "{\n  \"TimerOverheadNs\": %.9g,\n  \"FrequencyGovernor\": ", m_TimerOverheadNs);
+    WriteJsonString(file, m_FrequencyGovernor);
+    fprintf(file, ",\n  \"Results\": [");
+    for(size_t i = 0; i < m_Results.size(); ++i)
+    {
+        const RESULT& r = m_Results[i];
+        fprintf(file, "%s\n    {\"Name\": ", i ? "," : "");
+        WriteJsonString(file, r.Name);
+        fprintf(file, ", \"IterationCount\": %llu, \"SampleCount\": %u, \"RejectedSampleCount\": %u, "
+            "\"MeanNs\": %.9g, \"MedianNs\": %.9g, \"MinNs\": %.9g, \"MaxNs\": %.9g, \"StdDevNs\": %.9g, "
+            "\"ConfidenceLowNs\": %.9g, \"ConfidenceHighNs\": %.9g, \"FrequencyChangeDetected\": %s",
+            (unsigned long long)r.IterationCount,
+            r.SampleCount,
+            r.RejectedSampleCount,
+            r.MeanNs, r.MedianNs, r.MinNs, r.MaxNs, r.StdDevNs,
+            r.ConfidenceLowNs, r.ConfidenceHighNs,
+            r.FrequencyChangeDetected ? "true" : "false");
+        // Counters that are not available are omitted.
+        if(r.Ipc > 0.0)
+            fprintf(file, ", \"Ipc\": %.9g", r.Ipc);
+        for(uint32_t c = 0; c < COUNTER_COUNT; ++c)
+        {
+            if(r.CountersAvailable[c])
+                fprintf(file, ", \"%s\": %.9g", COUNTER_NAMES[c], r.Counters[c]);
+        }
+        fprintf(file, "}");
+    }
+    fprintf(file, "\n  ]\n}\n");
+}
+
+} // namespace MicroBenchmark
+
+#endif // #ifdef MICRO_BENCHMARK_IMPLEMENTATION
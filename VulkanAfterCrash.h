@@ -2,7 +2,7 @@
 VulkanAfterCrash.h
 
 Author:  Adam Sawicki, http://asawicki.info, adam__REMOVE__@asawicki.info
-Version: 1.0.1, 2018-05-16
+Version: 1.7.0, 2026-10-19
 License: MIT
 
 This is a simple, single-header, C++ library for Vulkan that simplifies writing
@@ -17,14 +17,32 @@ How to use it:
 2. In exactly one CPP file, define following macro before that include:
    #define VULKAN_AFTER_CRASH_IMPLEMENTATION
 3. Create object of type VkAfterCrash_Device, once for VkDevice.
-4. Create one or more VkAfterCrash_Buffer objects.
+4. Create one or more VkAfterCrash_Buffer objects. If you need many of them,
+   e.g. one per queue and per frame in flight, create a VkAfterCrash_Pool
+   first and create the buffers in it, so they share one VkDeviceMemory.
 5. While recording your commands to VkCommandBuffer, record also marker writes
    using function VkAfterCrash_CmdWriteMarker or
-   VkAfterCrash_CmdWriteMarkerExtended.
+   VkAfterCrash_CmdWriteMarkerExtended. To write many markers at once, use
+   VkAfterCrash_CmdWriteMarkers or VkAfterCrash_CmdWriteMarkerRange.
+   When recording many command buffers in parallel, instead of choosing
+   marker indices yourself, reserve a range of them for each command buffer
+   using VkAfterCrash_BeginMarkerRange and write markers using
+   VkAfterCrash_CmdWriteNextMarker or VkAfterCrash_CmdWriteNextMarkerExtended.
+   To be able to control how many markers are written, use macros like
+   VK_AFTER_CRASH_CMD_WRITE_MARKER instead, which take a level of detail - see
+   VkAfterCrash_MarkerLevel.
+   Optionally, the same markers can also measure GPU time between them - see
+   VkAfterCrash_Profiler.
+   Alternatively, to keep GPU memory and writes minimal regardless of the
+   number of markers, use a VkAfterCrash_Timeline per queue and write markers
+   using VkAfterCrash_CmdWriteTimelineMarker.
 6. If graphics driver crashes, you receive VK_ERROR_DEVICE_LOST from a Vulkan
    function like vkQueueSubmit. After it happened, inspect values under pData
    pointer returned by VkAfterCrash_CreateBuffer to see value of markers
    successfully written.
+   If even your process may not survive it, create the buffer with
+   VkAfterCrash_BufferCreateInfo::filePath, so GPU writes markers directly to
+   a file, and read it later using command "decode" of AfterCrashMarkers.py.
 
 See blog post:
 http://asawicki.info/news_1677_debugging_vulkan_driver_crash_-_equivalent_of_nvidia_aftermath.html
@@ -72,12 +90,44 @@ Represent buffer in system memory that can hold a number of 32-bit markers.
 */
 VK_DEFINE_HANDLE(VkAfterCrash_Buffer)
 
+/*
+Represents one block of system memory, from which many buffers can be
+allocated.
+*/
+VK_DEFINE_HANDLE(VkAfterCrash_Pool)
+
+/*
+Records GPU timestamps together with markers, to measure time between them.
+*/
+VK_DEFINE_HANDLE(VkAfterCrash_Profiler)
+
+/*
+Writes increasing sequence numbers to a single marker and remembers on the
+host what they mean.
+*/
+VK_DEFINE_HANDLE(VkAfterCrash_Timeline)
+
 typedef enum VkAfterCrash_DeviceCreateFlagBits {
     /*
     Use this flag if you found and enabled "VK_AMD_buffer_marker" device extension.
     It is required if you want to use function VkAfterCrash_CmdWriteMarkerExtended.
     */
     VK_AFTER_CRASH_DEVICE_CREATE_USE_AMD_BUFFER_MARKER_BIT = 0x00000001,
+    /*
+    Use this flag if you found and enabled "VK_AMD_device_coherent_memory"
+    device extension and its deviceCoherentMemory feature. Memory of buffers is
+    then allocated from a memory type with VK_MEMORY_PROPERTY_DEVICE_COHERENT_BIT_AMD
+    and VK_MEMORY_PROPERTY_DEVICE_UNCACHED_BIT_AMD, if available, so markers
+    are not lost in GPU caches when the device hangs.
+    */
+    VK_AFTER_CRASH_DEVICE_CREATE_USE_AMD_DEVICE_COHERENT_MEMORY_BIT = 0x00000002,
+    /*
+    Use this flag if you found and enabled "VK_EXT_external_memory_host" device
+    extension. It is required for buffers created with
+    VkAfterCrash_BufferCreateInfo::filePath to actually use the file. Requires
+    Vulkan 1.1.
+    */
+    VK_AFTER_CRASH_DEVICE_CREATE_USE_EXT_EXTERNAL_MEMORY_HOST_BIT = 0x00000004,
 
     VK_AFTER_CRASH_DEVICE_CREATE_FLAG_BITS_MAX_ENUM = 0x7FFFFFFF
 } VkAfterCrash_DeviceCreateFlagBits;
@@ -97,11 +147,168 @@ VkResult VkAfterCrash_CreateDevice(
 void VkAfterCrash_DestroyDevice(
     VkAfterCrash_Device device);
 
+typedef struct VkAfterCrash_PoolCreateInfo
+{
+    // Total number of markers in all buffers that can be allocated from the pool.
+    uint32_t markerCount;
+} VkAfterCrash_PoolCreateInfo;
+
+/*
+Creates pool: a single VkBuffer with its own VkDeviceMemory, persistently
+mapped. Buffers created in it take parts of it instead of making their own
+allocations.
+*/
+VkResult VkAfterCrash_CreatePool(
+    VkAfterCrash_Device device,
+    const VkAfterCrash_PoolCreateInfo* pCreateInfo,
+    VkAfterCrash_Pool* pPool);
+
+/*
+All buffers created in the pool must be destroyed before the pool.
+*/
+void VkAfterCrash_DestroyPool(
+    VkAfterCrash_Pool pool);
+
+/*
+Profiler writes a timestamp together with every marker written using
+VkAfterCrash_CmdWriteMarker, VkAfterCrash_CmdWriteMarkerExtended or
+VkAfterCrash_CmdWriteNextMarker* to a buffer created with it. Functions
+writing many markers at once don't write timestamps.
+
+Time between consecutive markers in a command buffer makes a region, reported
+with value of the marker that begins it. Place a marker also at the end of
+the command buffer, otherwise its last region is not reported.
+
+Timestamps go to a ring of query pools, one per frame. Results of a frame are
+collected without waiting, when its query pool is reused, frameCount frames
+later. Timestamps not available by then, e.g. still being executed, are lost.
+Timestamps don't survive device loss - after a crash, only markers do.
+
+Collected regions wait for VkAfterCrash_GetProfilerRegions in a ring with
+space for frameCount frames of maxMarkersPerFrame markers, allocated once.
+When it is full, the oldest regions are overwritten.
+
+VkAfterCrash_CreateProfiler returns VK_ERROR_FEATURE_NOT_PRESENT if queues of
+queueFamilyIndex don't support timestamps (timestampValidBits is 0).
+*/
+typedef struct VkAfterCrash_ProfilerCreateInfo
+{
+    // Number of query pools. Must be greater than number of frames in flight.
+    uint32_t frameCount;
+    // Timestamps above this number in a frame are not written.
+    uint32_t maxMarkersPerFrame;
+    // Queue family where command buffers with markers are submitted.
+    // Timestamps are masked to its timestampValidBits.
+    uint32_t queueFamilyIndex;
+} VkAfterCrash_ProfilerCreateInfo;
+
+VkResult VkAfterCrash_CreateProfiler(
+    VkAfterCrash_Device device,
+    const VkAfterCrash_ProfilerCreateInfo* pCreateInfo,
+    VkAfterCrash_Profiler* pProfiler);
+
+/*
+All buffers using the profiler must be destroyed before it.
+*/
+void VkAfterCrash_DestroyProfiler(
+    VkAfterCrash_Profiler profiler);
+
+/*
+Starts new frame: collects results from the query pool used frameCount frames
+ago and records command resetting it. Submit vkCommandBuffer before any other
+command buffers with markers of this frame. It must not be called while
+markers are being recorded.
+*/
+void VkAfterCrash_CmdBeginProfilerFrame(
+    VkCommandBuffer vkCommandBuffer,
+    VkAfterCrash_Profiler profiler);
+
+typedef struct VkAfterCrash_ProfilerRegion
+{
+    // Index of the frame, counted by VkAfterCrash_CmdBeginProfilerFrame from 0.
+    uint64_t frameIndex;
+    // Command buffer where it was recorded. It may be already destroyed.
+    VkCommandBuffer vkCommandBuffer;
+    // Value of the marker at the beginning of the region.
+    uint32_t value;
+    // GPU timestamp of the beginning of the region, in nanoseconds.
+    uint64_t beginNs;
+    uint64_t durationNs;
+} VkAfterCrash_ProfilerRegion;
+
+/*
+Takes up to maxRegionCount regions collected so far, oldest first, and returns
+their number. Regions not taken are kept until overwritten by newer ones, so
+call it regularly, e.g. once per frame.
+*/
+uint32_t VkAfterCrash_GetProfilerRegions(
+    VkAfterCrash_Profiler profiler,
+    uint32_t maxRegionCount,
+    VkAfterCrash_ProfilerRegion* pRegions);
+
+/*
+Saves regions to a file in Trace Event Format (JSON), which can be opened in
+chrome://tracing or Perfetto. Regions are shown as threads per command
+buffer, named with hexadecimal marker values. See also "trace" command of
+AfterCrashMarkers.py, which replaces them with labels.
+Returns VK_ERROR_INITIALIZATION_FAILED if the file can't be written.
+*/
+VkResult VkAfterCrash_WriteProfilerTrace(
+    const char* filePath,
+    uint32_t regionCount,
+    const VkAfterCrash_ProfilerRegion* pRegions);
+
 typedef struct VkAfterCrash_BufferCreateInfo
 {
     uint32_t markerCount;
+    /*
+    Optional. If not null, the buffer is allocated from this pool.
+    VkAfterCrash_CreateBuffer returns VK_ERROR_OUT_OF_DEVICE_MEMORY if there is
+    not enough free space in it.
+    */
+    VkAfterCrash_Pool pool;
+    // Optional. If not null, markers in the buffer also write timestamps to it.
+    VkAfterCrash_Profiler profiler;
+    /*
+    Optional. If not null, the buffer uses memory of this file, mapped and
+    imported to Vulkan using VK_EXT_external_memory_host, so markers written by
+    GPU land directly in the file and stay there even if the process dies.
+    The file is created or overwritten. It starts with
+    VkAfterCrash_FileHeader, followed by markers.
+
+    If it is not possible, e.g. the extension is not enabled or doesn't support
+    such memory, the buffer is created like without it. Check it with
+    VkAfterCrash_IsBufferFileBacked. The memory is first created as file
+    filePath with ".tmp" appended, which replaces filePath only when the buffer
+    is successfully created on it, so a failed attempt doesn't destroy markers
+    saved there after a previous crash.
+
+    It can't be used together with pool.
+    */
+    const char* filePath;
 } VkAfterCrash_BufferCreateInfo;
 
+#define VK_AFTER_CRASH_FILE_MAGIC "VkAfCrsh"
+#define VK_AFTER_CRASH_FILE_VERSION 1
+
+/*
+Beginning of a file used by buffer created with
+VkAfterCrash_BufferCreateInfo::filePath.
+*/
+typedef struct VkAfterCrash_FileHeader
+{
+    // VK_AFTER_CRASH_FILE_MAGIC, without terminating zero.
+    char magic[8];
+    // VK_AFTER_CRASH_FILE_VERSION.
+    uint32_t version;
+    // Offset of the first marker in the file, in bytes.
+    uint32_t headerSize;
+    uint32_t markerCount;
+    uint32_t reserved;
+    // Seconds since 1970-01-01 UTC, when the buffer was created.
+    uint64_t creationTime;
+} VkAfterCrash_FileHeader;
+
 /*
 Creates and returns buffer object, as well as pointer to its data. This pointer
 will (hopefully) remain valid and preserve its content after graphics driver
@@ -116,6 +323,13 @@ VkResult VkAfterCrash_CreateBuffer(
 void VkAfterCrash_DestroyBuffer(
     VkAfterCrash_Buffer buffer);
 
+/*
+Returns VK_TRUE if the buffer was created with
+VkAfterCrash_BufferCreateInfo::filePath and uses memory of that file.
+*/
+VkBool32 VkAfterCrash_IsBufferFileBacked(
+    VkAfterCrash_Buffer buffer);
+
 /*
 Records command to a Vulkan command buffer that will write 32-bit marker to
 specific place in specific buffer.
@@ -144,6 +358,264 @@ void VkAfterCrash_CmdWriteMarkerExtended(
     uint32_t value,
     VkPipelineStageFlagBits pipelineStage);
 
+/*
+Marker to be written by VkAfterCrash_CmdWriteMarkers or
+VkAfterCrash_CmdWriteMarkersExtended.
+*/
+typedef struct VkAfterCrash_Marker
+{
+    uint32_t markerIndex;
+    uint32_t value;
+    // Used only by VkAfterCrash_CmdWriteMarkersExtended.
+    VkPipelineStageFlagBits pipelineStage;
+} VkAfterCrash_Marker;
+
+/*
+Records commands that write markerCount 32-bit markers to specific places in
+specific buffer, like VkAfterCrash_CmdWriteMarker called for each of them.
+Markers with consecutive indices, one after another in pMarkers, are written
+by a single vkCmdUpdateBuffer - one command for every 16384 markers, so sort
+them by index if possible.
+
+It must be called outside of render pass.
+*/
+void VkAfterCrash_CmdWriteMarkers(
+    VkCommandBuffer vkCommandBuffer,
+    VkAfterCrash_Buffer buffer,
+    uint32_t markerCount,
+    const VkAfterCrash_Marker* pMarkers);
+
+/*
+Records commands that write markerCount 32-bit values from pValues to
+consecutive markers starting from firstMarkerIndex, using vkCmdUpdateBuffer -
+one command for every 16384 markers.
+
+It must be called outside of render pass.
+*/
+void VkAfterCrash_CmdWriteMarkerRange(
+    VkCommandBuffer vkCommandBuffer,
+    VkAfterCrash_Buffer buffer,
+    uint32_t firstMarkerIndex,
+    uint32_t markerCount,
+    const uint32_t* pValues);
+
+/*
+Same as VkAfterCrash_CmdWriteMarkerExtended called for each of markerCount
+markers. VK_AMD_buffer_marker has no command writing multiple markers, so it
+still records one command per marker.
+*/
+void VkAfterCrash_CmdWriteMarkersExtended(
+    VkCommandBuffer vkCommandBuffer,
+    VkAfterCrash_Buffer buffer,
+    uint32_t markerCount,
+    const VkAfterCrash_Marker* pMarkers);
+
+/*
+Reserves markerCount consecutive marker slots in the buffer and returns index
+of the first one. It is thread-safe and lock-free - it takes a single atomic
+compare-and-swap, retried only when another thread allocates at the same time.
+
+Slots are taken from the buffer in a ring: after its end is reached,
+allocation starts again from the beginning, so markers of old command buffers
+get overwritten. Create the buffer large enough for markers of all command
+buffers that can be in flight. A range never crosses the end of the buffer.
+markerCount must not be greater than number of markers in the buffer.
+*/
+uint32_t VkAfterCrash_AllocateMarkers(
+    VkAfterCrash_Buffer buffer,
+    uint32_t markerCount);
+
+/*
+Range of marker slots reserved for one command buffer, used by functions
+VkAfterCrash_CmdWriteNextMarker*, which take consecutive slots from it. When
+it is used up, a new one of the same size is allocated automatically, so it
+doesn't need to be large enough for all markers of the command buffer.
+
+It is not thread-safe - use a separate one for each command buffer being
+recorded. Members are for internal use.
+*/
+typedef struct VkAfterCrash_MarkerRange
+{
+    VkAfterCrash_Buffer buffer;
+    uint32_t markerCount;
+    uint32_t nextMarkerIndex;
+    uint32_t endMarkerIndex;
+} VkAfterCrash_MarkerRange;
+
+/*
+Initializes marker range with markerCount slots allocated from the buffer
+using VkAfterCrash_AllocateMarkers. Call it when you start recording a command
+buffer. Larger ranges mean fewer atomic operations on the buffer, shared by
+all threads.
+*/
+void VkAfterCrash_BeginMarkerRange(
+    VkAfterCrash_Buffer buffer,
+    uint32_t markerCount,
+    VkAfterCrash_MarkerRange* pRange);
+
+/*
+Same as VkAfterCrash_CmdWriteMarker, but writes to the next slot from the
+range. Returns index of the marker slot used.
+*/
+uint32_t VkAfterCrash_CmdWriteNextMarker(
+    VkCommandBuffer vkCommandBuffer,
+    VkAfterCrash_MarkerRange* pRange,
+    uint32_t value);
+
+/*
+Same as VkAfterCrash_CmdWriteMarkerExtended, but writes to the next slot from
+the range. Returns index of the marker slot used.
+*/
+uint32_t VkAfterCrash_CmdWriteNextMarkerExtended(
+    VkCommandBuffer vkCommandBuffer,
+    VkAfterCrash_MarkerRange* pRange,
+    uint32_t value,
+    VkPipelineStageFlagBits pipelineStage);
+
+/*
+Timeline uses a single marker of a buffer, e.g. one per queue. Every marker
+written with VkAfterCrash_CmdWriteTimelineMarker* writes the next sequence
+number to it, while its label and command buffer are stored on the host in
+a ring of entryCount entries, indexed by the sequence number. After a crash,
+VkAfterCrash_GetTimelineSequence reads the number of the last marker executed
+and VkAfterCrash_GetTimelineEntry tells what it was.
+
+Create one timeline per queue - when command buffers from different queues
+write to the same marker, the last value doesn't tell much. entryCount must
+be larger than the number of markers of all command buffers that can be in
+flight, otherwise entries of the oldest ones are lost. When two threads record
+markers whose sequence numbers are entryCount apart at the same time, one of
+the two entries is also lost, never mixed with the other one.
+*/
+typedef struct VkAfterCrash_TimelineCreateInfo
+{
+    VkAfterCrash_Buffer buffer;
+    uint32_t markerIndex;
+    uint32_t entryCount;
+} VkAfterCrash_TimelineCreateInfo;
+
+VkResult VkAfterCrash_CreateTimeline(
+    VkAfterCrash_Device device,
+    const VkAfterCrash_TimelineCreateInfo* pCreateInfo,
+    VkAfterCrash_Timeline* pTimeline);
+
+void VkAfterCrash_DestroyTimeline(
+    VkAfterCrash_Timeline timeline);
+
+/*
+Same as VkAfterCrash_CmdWriteMarker, but writes the next sequence number to
+the marker of the timeline and stores label and command buffer under it.
+label is not copied, so it should be a string literal. Returns the sequence
+number, which is never 0.
+
+It is thread-safe and lock-free. Sequence numbers are taken in the order of
+recording, not submission, so use them only to find the entry, not to compare
+which marker was earlier.
+*/
+uint32_t VkAfterCrash_CmdWriteTimelineMarker(
+    VkCommandBuffer vkCommandBuffer,
+    VkAfterCrash_Timeline timeline,
+    const char* label);
+
+/*
+Same as VkAfterCrash_CmdWriteTimelineMarker, using
+VkAfterCrash_CmdWriteMarkerExtended.
+*/
+uint32_t VkAfterCrash_CmdWriteTimelineMarkerExtended(
+    VkCommandBuffer vkCommandBuffer,
+    VkAfterCrash_Timeline timeline,
+    const char* label,
+    VkPipelineStageFlagBits pipelineStage);
+
+/*
+Returns sequence number currently in the marker of the timeline, which is
+the last one executed, or 0 if none was.
+*/
+uint32_t VkAfterCrash_GetTimelineSequence(
+    VkAfterCrash_Timeline timeline);
+
+typedef struct VkAfterCrash_TimelineEntry
+{
+    uint32_t sequence;
+    VkCommandBuffer vkCommandBuffer;
+    const char* label;
+} VkAfterCrash_TimelineEntry;
+
+/*
+Finds the entry of given sequence number. Returns VK_FALSE if it was never
+written, was lost or was already overwritten in the ring.
+
+Sequence numbers follow the order of recording, not submission. When command
+buffers are recorded in parallel, sequence + 1 after the last one executed may
+belong to another command buffer, even one that was never submitted, so check
+vkCommandBuffer of the entries before treating them as in flight.
+*/
+VkBool32 VkAfterCrash_GetTimelineEntry(
+    VkAfterCrash_Timeline timeline,
+    uint32_t sequence,
+    VkAfterCrash_TimelineEntry* pEntry);
+
+/*
+Level of detail of a marker, passed to macros VK_AFTER_CRASH_CMD_WRITE_*.
+A marker is written only if its level is not greater than both:
+
+- VK_AFTER_CRASH_MAX_MARKER_LEVEL - compile-time ceiling. Markers above it are
+  compiled out completely - their arguments are not even evaluated.
+- VkAfterCrash_MarkerLevelThreshold - runtime threshold. Markers above it
+  cost just one comparison.
+
+This way you can ship detailed markers and turn them on only when needed, e.g.
+on machines that reported crashes.
+*/
+typedef enum VkAfterCrash_MarkerLevel {
+    // Used only as a threshold, to disable all markers.
+    VK_AFTER_CRASH_MARKER_LEVEL_OFF = 0,
+    // Few markers per frame, e.g. around render passes.
+    VK_AFTER_CRASH_MARKER_LEVEL_PASS = 1,
+    // Marker per draw call or dispatch.
+    VK_AFTER_CRASH_MARKER_LEVEL_DRAW = 2,
+    // Even more detailed, e.g. around copies and barriers.
+    VK_AFTER_CRASH_MARKER_LEVEL_FINE = 3,
+
+    VK_AFTER_CRASH_MARKER_LEVEL_MAX_ENUM = 0x7FFFFFFF
+} VkAfterCrash_MarkerLevel;
+
+#ifndef VK_AFTER_CRASH_MAX_MARKER_LEVEL
+    #define VK_AFTER_CRASH_MAX_MARKER_LEVEL VK_AFTER_CRASH_MARKER_LEVEL_FINE
+#endif
+
+/*
+Default: VK_AFTER_CRASH_MARKER_LEVEL_FINE. Set it e.g. at startup, when no
+command buffers are being recorded, as it is read without synchronization.
+*/
+extern VkAfterCrash_MarkerLevel VkAfterCrash_MarkerLevelThreshold;
+
+#define VK_AFTER_CRASH_MARKER_LEVEL_ENABLED(level) \
+    ((level) <= VK_AFTER_CRASH_MAX_MARKER_LEVEL && (level) <= VkAfterCrash_MarkerLevelThreshold)
+
+/*
+Same as functions VkAfterCrash_CmdWrite*, but with additional first parameter
+level, which should be a constant.
+*/
+#define VK_AFTER_CRASH_CMD_WRITE_MARKER(level, vkCommandBuffer, buffer, markerIndex, value) \
+    do { if(VK_AFTER_CRASH_MARKER_LEVEL_ENABLED(level)) \
+        VkAfterCrash_CmdWriteMarker((vkCommandBuffer), (buffer), (markerIndex), (value)); } while(0)
+#define VK_AFTER_CRASH_CMD_WRITE_MARKER_EXTENDED(level, vkCommandBuffer, buffer, markerIndex, value, pipelineStage) \
+    do { if(VK_AFTER_CRASH_MARKER_LEVEL_ENABLED(level)) \
+        VkAfterCrash_CmdWriteMarkerExtended((vkCommandBuffer), (buffer), (markerIndex), (value), (pipelineStage)); } while(0)
+#define VK_AFTER_CRASH_CMD_WRITE_NEXT_MARKER(level, vkCommandBuffer, pRange, value) \
+    do { if(VK_AFTER_CRASH_MARKER_LEVEL_ENABLED(level)) \
+        VkAfterCrash_CmdWriteNextMarker((vkCommandBuffer), (pRange), (value)); } while(0)
+#define VK_AFTER_CRASH_CMD_WRITE_NEXT_MARKER_EXTENDED(level, vkCommandBuffer, pRange, value, pipelineStage) \
+    do { if(VK_AFTER_CRASH_MARKER_LEVEL_ENABLED(level)) \
+        VkAfterCrash_CmdWriteNextMarkerExtended((vkCommandBuffer), (pRange), (value), (pipelineStage)); } while(0)
+#define VK_AFTER_CRASH_CMD_WRITE_TIMELINE_MARKER(level, vkCommandBuffer, timeline, label) \
+    do { if(VK_AFTER_CRASH_MARKER_LEVEL_ENABLED(level)) \
+        VkAfterCrash_CmdWriteTimelineMarker((vkCommandBuffer), (timeline), (label)); } while(0)
+#define VK_AFTER_CRASH_CMD_WRITE_TIMELINE_MARKER_EXTENDED(level, vkCommandBuffer, timeline, label, pipelineStage) \
+    do { if(VK_AFTER_CRASH_MARKER_LEVEL_ENABLED(level)) \
+        VkAfterCrash_CmdWriteTimelineMarkerExtended((vkCommandBuffer), (timeline), (label), (pipelineStage)); } while(0)
+
 #ifdef __cplusplus
 }
 #endif
@@ -158,8 +630,189 @@ void VkAfterCrash_CmdWriteMarkerExtended(
 #ifdef VULKAN_AFTER_CRASH_IMPLEMENTATION
 #undef VULKAN_AFTER_CRASH_IMPLEMENTATION
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// class VkAfterCrash_MappedFile
+
+// File mapped to memory shared with the operating system, so its content is
+// saved even if the process is killed.
+//
+// It is created as a temporary file next to the destination one, so that an
+// existing file is left intact until Commit - e.g. when the memory turns out to
+// be unusable. Close deletes the temporary file if it wasn't committed.
+class VkAfterCrash_MappedFile
+{
+public:
+    VkAfterCrash_MappedFile();
+    ~VkAfterCrash_MappedFile() { Close(); }
+
+    // Creates the temporary file with given size, filled with zeros. Returns
+    // false on failure.
+    bool Open(const char* filePath, size_t size);
+    // Replaces the destination file with the temporary one, which stays mapped.
+    // Returns false on failure.
+    bool Commit();
+    void Close();
+    void* GetData() const { return m_Data; }
+
+private:
+#ifdef _WIN32
+    HANDLE m_File;
+    HANDLE m_Mapping;
+#else
+    int m_File;
+#endif
+    void* m_Data;
+    size_t m_Size;
+    std::string m_FilePath;
+    std::string m_TempFilePath;
+    bool m_Committed;
+
+    VkAfterCrash_MappedFile(const VkAfterCrash_MappedFile&) = delete;
+    VkAfterCrash_MappedFile& operator=(const VkAfterCrash_MappedFile&) = delete;
+};
+
+#ifdef _WIN32
+
+VkAfterCrash_MappedFile::VkAfterCrash_MappedFile() :
+    m_File(INVALID_HANDLE_VALUE),
+    m_Mapping(NULL),
+    m_Data(nullptr),
+    m_Size(0),
+    m_Committed(false)
+{
+}
+
+bool VkAfterCrash_MappedFile::Open(const char* filePath, size_t size)
+{
+    assert(m_Data == nullptr);
+    m_FilePath = filePath;
+    m_TempFilePath = m_FilePath + ".tmp";
+    m_Committed = false;
+    // FILE_SHARE_DELETE allows Commit to rename it while open.
+    m_File = CreateFileA(m_TempFilePath.c_str(), GENERIC_READ | GENERIC_WRITE,
+        FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(m_File == INVALID_HANDLE_VALUE)
+        return false;
+    m_Mapping = CreateFileMappingA(m_File, NULL, PAGE_READWRITE,
+        (DWORD)((uint64_t)size >> 32), (DWORD)size, NULL);
+    if(m_Mapping == NULL)
+    {
+        Close();
+        return false;
+    }
+    m_Data = MapViewOfFile(m_Mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if(m_Data == nullptr)
+    {
+        Close();
+        return false;
+    }
+    m_Size = size;
+    return true;
+}
+
+bool VkAfterCrash_MappedFile::Commit()
+{
+    assert(m_Data != nullptr && !m_Committed);
+    m_Committed = MoveFileExA(m_TempFilePath.c_str(), m_FilePath.c_str(), MOVEFILE_REPLACE_EXISTING) != FALSE;
+    return m_Committed;
+}
+
+void VkAfterCrash_MappedFile::Close()
+{
+    if(m_Data)
+        UnmapViewOfFile(m_Data);
+    if(m_Mapping)
+        CloseHandle(m_Mapping);
+    if(m_File != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_File);
+        if(!m_Committed)
+            DeleteFileA(m_TempFilePath.c_str());
+    }
+    m_File = INVALID_HANDLE_VALUE;
+    m_Mapping = NULL;
+    m_Data = nullptr;
+    m_Size = 0;
+}
+
+#else // #ifdef _WIN32
+
+VkAfterCrash_MappedFile::VkAfterCrash_MappedFile() :
+    m_File(-1),
+    m_Data(nullptr),
+    m_Size(0),
+    m_Committed(false)
+{
+}
+
+bool VkAfterCrash_MappedFile::Open(const char* filePath, size_t size)
+{
+    assert(m_Data == nullptr);
+    m_FilePath = filePath;
+    m_TempFilePath = m_FilePath + ".tmp";
+    m_Committed = false;
+    m_File = open(m_TempFilePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(m_File == -1)
+        return false;
+    if(ftruncate(m_File, (off_t)size) != 0)
+    {
+        Close();
+        return false;
+    }
+    void* const data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_File, 0);
+    if(data == MAP_FAILED)
+    {
+        Close();
+        return false;
+    }
+    m_Data = data;
+    m_Size = size;
+    return true;
+}
+
+bool VkAfterCrash_MappedFile::Commit()
+{
+    assert(m_Data != nullptr && !m_Committed);
+    m_Committed = rename(m_TempFilePath.c_str(), m_FilePath.c_str()) == 0;
+    return m_Committed;
+}
+
+void VkAfterCrash_MappedFile::Close()
+{
+    if(m_Data)
+        munmap(m_Data, m_Size);
+    if(m_File != -1)
+    {
+        close(m_File);
+        if(!m_Committed)
+            unlink(m_TempFilePath.c_str());
+    }
+    m_File = -1;
+    m_Data = nullptr;
+    m_Size = 0;
+}
+
+#endif // #ifdef _WIN32
 
 ////////////////////////////////////////////////////////////////////////////////
 // struct VkAfterCrash_Device_T
@@ -172,55 +825,601 @@ public:
     ~VkAfterCrash_Device_T();
     
     bool UseAmdBufferMarker() const { return (m_CreateInfo.flags & VK_AFTER_CRASH_DEVICE_CREATE_USE_AMD_BUFFER_MARKER_BIT) != 0; }
+    bool CanImportHostMemory() const { return m_vkGetMemoryHostPointerPropertiesEXT != nullptr; }
     VkDevice GetVkDevice() const { return m_CreateInfo.vkDevice; }
+    VkPhysicalDevice GetVkPhysicalDevice() const { return m_CreateInfo.vkPhysicalDevice; }
     PFN_vkCmdWriteBufferMarkerAMD GetVkCmdWriteBufferMarkerAMD() const { return m_vkCmdWriteBufferMarkerAMD; }
     bool FindMemoryTypeIndex(uint32_t memTypeBits, uint32_t* pMemTypeIndex) const;
 
+    // Creates buffer with its own memory, persistently mapped.
+    VkResult CreateMappedBuffer(
+        VkDeviceSize size,
+        VkBuffer* pVkBuffer,
+        VkDeviceMemory* pVkMemory,
+        void** ppData) const;
+    // Handles that are null are ignored.
+    void DestroyMappedBuffer(
+        VkBuffer vkBuffer,
+        VkDeviceMemory vkMemory,
+        void* pData) const;
+    // Creates buffer with memory of the file, mapped and imported. Size of the
+    // buffer is size of the file. Requires CanImportHostMemory().
+    VkResult CreateFileBackedBuffer(
+        const char* filePath,
+        VkDeviceSize size,
+        VkAfterCrash_MappedFile& file,
+        VkBuffer* pVkBuffer,
+        VkDeviceMemory* pVkMemory) const;
+
 private:
     VkAfterCrash_DeviceCreateInfo m_CreateInfo;
     PFN_vkCmdWriteBufferMarkerAMD m_vkCmdWriteBufferMarkerAMD;
+    // Null if VK_EXT_external_memory_host is not used.
+    PFN_vkGetMemoryHostPointerPropertiesEXT m_vkGetMemoryHostPointerPropertiesEXT;
+    VkDeviceSize m_MinImportedHostPointerAlignment;
+    // Fetched once, in Initialize.
+    VkPhysicalDeviceMemoryProperties m_MemProps;
+};
+
+VkAfterCrash_Device_T::VkAfterCrash_Device_T(const VkAfterCrash_DeviceCreateInfo& createInfo) :
+    m_CreateInfo(createInfo),
+    m_vkCmdWriteBufferMarkerAMD(nullptr),
+    m_vkGetMemoryHostPointerPropertiesEXT(nullptr),
+    m_MinImportedHostPointerAlignment(0),
+    m_MemProps()
+{
+}
+
+VkResult VkAfterCrash_Device_T::Initialize()
+{
+    if(UseAmdBufferMarker())
+    {
+        m_vkCmdWriteBufferMarkerAMD = (PFN_vkCmdWriteBufferMarkerAMD)vkGetDeviceProcAddr(GetVkDevice(), "vkCmdWriteBufferMarkerAMD");
+        if(m_vkCmdWriteBufferMarkerAMD == nullptr)
+            return VK_ERROR_FEATURE_NOT_PRESENT;
+    }
+
+    // Missing extension is not an error - file-backed buffers just fall back
+    // to normal memory.
+    if((m_CreateInfo.flags & VK_AFTER_CRASH_DEVICE_CREATE_USE_EXT_EXTERNAL_MEMORY_HOST_BIT) != 0)
+    {
+        VkPhysicalDeviceExternalMemoryHostPropertiesEXT hostProps = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT };
+        VkPhysicalDeviceProperties2 props2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+        props2.pNext = &hostProps;
+        vkGetPhysicalDeviceProperties2(m_CreateInfo.vkPhysicalDevice, &props2);
+        m_MinImportedHostPointerAlignment = hostProps.minImportedHostPointerAlignment;
+        if(m_MinImportedHostPointerAlignment > 0)
+        {
+            m_vkGetMemoryHostPointerPropertiesEXT = (PFN_vkGetMemoryHostPointerPropertiesEXT)vkGetDeviceProcAddr(
+                GetVkDevice(), "vkGetMemoryHostPointerPropertiesEXT");
+        }
+    }
+
+    vkGetPhysicalDeviceMemoryProperties(m_CreateInfo.vkPhysicalDevice, &m_MemProps);
+
+    return VK_SUCCESS;
+}
+
+VkAfterCrash_Device_T::~VkAfterCrash_Device_T()
+{
+}
+
+bool VkAfterCrash_Device_T::FindMemoryTypeIndex(uint32_t memTypeBits, uint32_t* pMemTypeIndex) const
+{
+    const uint32_t expectedFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    const uint32_t deviceCoherentFlags = VK_MEMORY_PROPERTY_DEVICE_COHERENT_BIT_AMD |
+        VK_MEMORY_PROPERTY_DEVICE_UNCACHED_BIT_AMD;
+    const bool useDeviceCoherent =
+        (m_CreateInfo.flags & VK_AFTER_CRASH_DEVICE_CREATE_USE_AMD_DEVICE_COHERENT_MEMORY_BIT) != 0;
+
+    // Among types with expectedFlags, prefer device coherent (if allowed),
+    // then host cached, which is faster to read after crash.
+    *pMemTypeIndex = UINT32_MAX;
+    uint32_t bestScore = 0;
+    for(uint32_t i = 0; i < m_MemProps.memoryTypeCount; ++i)
+    {
+        const uint32_t flags = m_MemProps.memoryTypes[i].propertyFlags;
+        if(((1u << i) & memTypeBits) == 0 ||
+            (flags & expectedFlags) != expectedFlags)
+            continue;
+        // Memory types with these flags can't be used without the feature enabled.
+        if(!useDeviceCoherent && (flags & deviceCoherentFlags) != 0)
+            continue;
+
+        uint32_t score = 1;
+        if(useDeviceCoherent && (flags & deviceCoherentFlags) == deviceCoherentFlags)
+            score += 4;
+        if((flags & VK_MEMORY_PROPERTY_HOST_CACHED_BIT) != 0)
+            score += 2;
+        if(score > bestScore)
+        {
+            *pMemTypeIndex = i;
+            bestScore = score;
+        }
+    }
+
+    return bestScore > 0;
+}
+
+VkResult VkAfterCrash_Device_T::CreateMappedBuffer(
+    VkDeviceSize size,
+    VkBuffer* pVkBuffer,
+    VkDeviceMemory* pVkMemory,
+    void** ppData) const
+{
+    const VkDevice dev = GetVkDevice();
+    *pVkBuffer = VK_NULL_HANDLE;
+    *pVkMemory = VK_NULL_HANDLE;
+    *ppData = nullptr;
+
+    VkBufferCreateInfo bufCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    bufCreateInfo.size = size;
+    bufCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    VkResult res = vkCreateBuffer(dev, &bufCreateInfo, nullptr, pVkBuffer);
+    if(res != VK_SUCCESS)
+        return res;
+
+    VkMemoryRequirements memReq = {};
+    vkGetBufferMemoryRequirements(dev, *pVkBuffer, &memReq);
+
+    VkMemoryAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+    allocInfo.allocationSize = memReq.size;
+    bool ok = FindMemoryTypeIndex(memReq.memoryTypeBits, &allocInfo.memoryTypeIndex);
+    if(!ok)
+        return VK_ERROR_FORMAT_NOT_SUPPORTED;
+    res = vkAllocateMemory(dev, &allocInfo, nullptr, pVkMemory);
+    if(res != VK_SUCCESS)
+        return res;
+
+    res = vkMapMemory(dev, *pVkMemory, 0, VK_WHOLE_SIZE, 0, ppData);
+    if(res != VK_SUCCESS)
+        return res;
+
+    return vkBindBufferMemory(dev, *pVkBuffer, *pVkMemory, 0);
+}
+
+void VkAfterCrash_Device_T::DestroyMappedBuffer(
+    VkBuffer vkBuffer,
+    VkDeviceMemory vkMemory,
+    void* pData) const
+{
+    const VkDevice dev = GetVkDevice();
+
+    if(pData)
+        vkUnmapMemory(dev, vkMemory);
+    if(vkBuffer)
+        vkDestroyBuffer(dev, vkBuffer, nullptr);
+    if(vkMemory)
+        vkFreeMemory(dev, vkMemory, nullptr);
+}
+
+VkResult VkAfterCrash_Device_T::CreateFileBackedBuffer(
+    const char* filePath,
+    VkDeviceSize size,
+    VkAfterCrash_MappedFile& file,
+    VkBuffer* pVkBuffer,
+    VkDeviceMemory* pVkMemory) const
+{
+    assert(CanImportHostMemory());
+    const VkDevice dev = GetVkDevice();
+    *pVkBuffer = VK_NULL_HANDLE;
+    *pVkMemory = VK_NULL_HANDLE;
+
+    // Both address and size of imported memory must be aligned.
+    size = (size + m_MinImportedHostPointerAlignment - 1) /
+        m_MinImportedHostPointerAlignment * m_MinImportedHostPointerAlignment;
+    if(!file.Open(filePath, (size_t)size))
+        return VK_ERROR_INITIALIZATION_FAILED;
+    if((uintptr_t)file.GetData() % m_MinImportedHostPointerAlignment != 0)
+        return VK_ERROR_INVALID_EXTERNAL_HANDLE;
+
+    // Mapped file is "foreign memory", but some drivers support only
+    // "host allocation".
+    const VkExternalMemoryHandleTypeFlagBits handleTypes[] = {
+        VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_MAPPED_FOREIGN_MEMORY_BIT_EXT,
+        VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT,
+    };
+    VkExternalMemoryHandleTypeFlagBits handleType = handleTypes[0];
+    VkMemoryHostPointerPropertiesEXT hostPointerProps = { VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT };
+    VkResult res = VK_ERROR_INVALID_EXTERNAL_HANDLE;
+    for(size_t i = 0; i < sizeof(handleTypes) / sizeof(handleTypes[0]) && res != VK_SUCCESS; ++i)
+    {
+        handleType = handleTypes[i];
+        res = m_vkGetMemoryHostPointerPropertiesEXT(dev, handleType, file.GetData(), &hostPointerProps);
+    }
+    if(res != VK_SUCCESS)
+        return res;
+
+    VkExternalMemoryBufferCreateInfo externalCreateInfo = { VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO };
+    externalCreateInfo.handleTypes = handleType;
+    VkBufferCreateInfo bufCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    bufCreateInfo.pNext = &externalCreateInfo;
+    bufCreateInfo.size = size;
+    bufCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    res = vkCreateBuffer(dev, &bufCreateInfo, nullptr, pVkBuffer);
+    if(res != VK_SUCCESS)
+        return res;
+
+    VkMemoryRequirements memReq = {};
+    vkGetBufferMemoryRequirements(dev, *pVkBuffer, &memReq);
+    if(memReq.size > size)
+        return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+
+    VkImportMemoryHostPointerInfoEXT importInfo = { VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT };
+    importInfo.handleType = handleType;
+    importInfo.pHostPointer = file.GetData();
+    VkMemoryAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+    allocInfo.pNext = &importInfo;
+    allocInfo.allocationSize = size;
+    bool ok = FindMemoryTypeIndex(memReq.memoryTypeBits & hostPointerProps.memoryTypeBits, &allocInfo.memoryTypeIndex);
+    if(!ok)
+        return VK_ERROR_FORMAT_NOT_SUPPORTED;
+    res = vkAllocateMemory(dev, &allocInfo, nullptr, pVkMemory);
+    if(res != VK_SUCCESS)
+        return res;
+
+    return vkBindBufferMemory(dev, *pVkBuffer, *pVkMemory, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// struct VkAfterCrash_Pool_T
+
+struct VkAfterCrash_Pool_T
+{
+public:
+    VkAfterCrash_Pool_T(
+        VkAfterCrash_Device device,
+        const VkAfterCrash_PoolCreateInfo& createInfo);
+    VkResult Initialize();
+    ~VkAfterCrash_Pool_T();
+
+    VkBuffer GetVkBuffer() const { return m_VkBuffer; }
+    uint32_t* GetData() const { return m_Data; }
+
+    // Returns false if there is no free range large enough. It is thread-safe.
+    bool Allocate(uint32_t markerCount, uint32_t* pFirstMarkerIndex);
+    void Free(uint32_t firstMarkerIndex, uint32_t markerCount);
+
+private:
+    struct Range
+    {
+        uint32_t firstMarkerIndex;
+        uint32_t markerCount;
+    };
+
+    // Beginning of every buffer is aligned to this number of markers (64 B),
+    // so buffers used by different queues don't share cache lines.
+    static const uint32_t MARKER_ALIGNMENT = 16;
+
+    VkAfterCrash_Device m_Device;
+    VkAfterCrash_PoolCreateInfo m_CreateInfo;
+    VkDeviceMemory m_VkMemory;
+    uint32_t* m_Data;
+    VkBuffer m_VkBuffer;
+
+    std::mutex m_Mutex;
+    // Sorted by firstMarkerIndex, never adjacent to each other.
+    std::vector<Range> m_FreeRanges;
+    uint32_t m_AllocationCount;
+};
+
+VkAfterCrash_Pool_T::VkAfterCrash_Pool_T(
+    VkAfterCrash_Device device,
+    const VkAfterCrash_PoolCreateInfo& createInfo) :
+    m_Device(device),
+    m_CreateInfo(createInfo),
+    m_VkMemory(VK_NULL_HANDLE),
+    m_Data(nullptr),
+    m_VkBuffer(VK_NULL_HANDLE),
+    m_AllocationCount(0)
+{
+}
+
+VkResult VkAfterCrash_Pool_T::Initialize()
+{
+    m_CreateInfo.markerCount = (m_CreateInfo.markerCount + MARKER_ALIGNMENT - 1) / MARKER_ALIGNMENT * MARKER_ALIGNMENT;
+    VkResult res = m_Device->CreateMappedBuffer(
+        m_CreateInfo.markerCount * sizeof(uint32_t),
+        &m_VkBuffer,
+        &m_VkMemory,
+        (void**)&m_Data);
+    if(res != VK_SUCCESS)
+        return res;
+
+    Range wholePool = { 0, m_CreateInfo.markerCount };
+    m_FreeRanges.push_back(wholePool);
+    return VK_SUCCESS;
+}
+
+VkAfterCrash_Pool_T::~VkAfterCrash_Pool_T()
+{
+    assert(m_AllocationCount == 0 && "Some buffers allocated from this pool were not destroyed.");
+    m_Device->DestroyMappedBuffer(m_VkBuffer, m_VkMemory, m_Data);
+}
+
+bool VkAfterCrash_Pool_T::Allocate(uint32_t markerCount, uint32_t* pFirstMarkerIndex)
+{
+    markerCount = (markerCount + MARKER_ALIGNMENT - 1) / MARKER_ALIGNMENT * MARKER_ALIGNMENT;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    // First fit. Buffers are created rarely and there are few of them.
+    for(size_t i = 0; i < m_FreeRanges.size(); ++i)
+    {
+        Range& range = m_FreeRanges[i];
+        if(range.markerCount >= markerCount)
+        {
+            *pFirstMarkerIndex = range.firstMarkerIndex;
+            range.firstMarkerIndex += markerCount;
+            range.markerCount -= markerCount;
+            if(range.markerCount == 0)
+                m_FreeRanges.erase(m_FreeRanges.begin() + i);
+            ++m_AllocationCount;
+            return true;
+        }
+    }
+    return false;
+}
+
+void VkAfterCrash_Pool_T::Free(uint32_t firstMarkerIndex, uint32_t markerCount)
+{
+    markerCount = (markerCount + MARKER_ALIGNMENT - 1) / MARKER_ALIGNMENT * MARKER_ALIGNMENT;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    assert(m_AllocationCount > 0);
+    --m_AllocationCount;
+
+    size_t i = 0;
+    while(i < m_FreeRanges.size() && m_FreeRanges[i].firstMarkerIndex < firstMarkerIndex)
+        ++i;
+    // Merge with previous and/or next free range if adjacent.
+    const bool mergePrev = i > 0 &&
+        m_FreeRanges[i - 1].firstMarkerIndex + m_FreeRanges[i - 1].markerCount == firstMarkerIndex;
+    const bool mergeNext = i < m_FreeRanges.size() &&
+        firstMarkerIndex + markerCount == m_FreeRanges[i].firstMarkerIndex;
+    if(mergePrev && mergeNext)
+    {
+        m_FreeRanges[i - 1].markerCount += markerCount + m_FreeRanges[i].markerCount;
+        m_FreeRanges.erase(m_FreeRanges.begin() + i);
+    }
+    else if(mergePrev)
+        m_FreeRanges[i - 1].markerCount += markerCount;
+    else if(mergeNext)
+    {
+        m_FreeRanges[i].firstMarkerIndex = firstMarkerIndex;
+        m_FreeRanges[i].markerCount += markerCount;
+    }
+    else
+    {
+        Range range = { firstMarkerIndex, markerCount };
+        m_FreeRanges.insert(m_FreeRanges.begin() + i, range);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// struct VkAfterCrash_Profiler_T
+
+struct VkAfterCrash_Profiler_T
+{
+public:
+    VkAfterCrash_Profiler_T(
+        VkAfterCrash_Device device,
+        const VkAfterCrash_ProfilerCreateInfo& createInfo);
+    VkResult Initialize();
+    ~VkAfterCrash_Profiler_T();
+
+    void CmdBeginFrame(VkCommandBuffer vkCommandBuffer);
+    // Thread-safe with other calls to this function.
+    void CmdWriteTimestamp(
+        VkCommandBuffer vkCommandBuffer,
+        VkPipelineStageFlagBits pipelineStage,
+        uint32_t value);
+    uint32_t GetRegions(uint32_t maxRegionCount, VkAfterCrash_ProfilerRegion* pRegions);
+
+private:
+    struct Query
+    {
+        VkCommandBuffer vkCommandBuffer;
+        uint32_t value;
+    };
+    struct Frame
+    {
+        VkQueryPool vkQueryPool = VK_NULL_HANDLE;
+        uint64_t frameIndex = 0;
+        // Frame started and not collected yet.
+        bool pending = false;
+        // Number of queries taken, may exceed maxMarkersPerFrame.
+        std::atomic<uint32_t> queryCount;
+        std::vector<Query> queries;
+    };
+
+    VkAfterCrash_Device m_Device;
+    VkAfterCrash_ProfilerCreateInfo m_CreateInfo;
+    double m_TimestampPeriod;
+    // Bits of timestamps that are valid - the rest are undefined.
+    uint64_t m_TimestampMask;
+    Frame* m_Frames;
+    // Frame being recorded, nullptr before first CmdBeginFrame.
+    Frame* m_CurrentFrame;
+    uint64_t m_NextFrameIndex;
+
+    std::mutex m_RegionsMutex;
+    // Ring of regions not taken yet. When full, the oldest are overwritten.
+    std::vector<VkAfterCrash_ProfilerRegion> m_Regions;
+    size_t m_FirstRegion;
+    size_t m_RegionCount;
+
+    void Collect(Frame& frame);
+    void AddRegion(const VkAfterCrash_ProfilerRegion& region);
 };
 
-VkAfterCrash_Device_T::VkAfterCrash_Device_T(const VkAfterCrash_DeviceCreateInfo& createInfo) :
-    m_CreateInfo(createInfo)
+VkAfterCrash_Profiler_T::VkAfterCrash_Profiler_T(
+    VkAfterCrash_Device device,
+    const VkAfterCrash_ProfilerCreateInfo& createInfo) :
+    m_Device(device),
+    m_CreateInfo(createInfo),
+    m_TimestampPeriod(1.0),
+    m_TimestampMask(UINT64_MAX),
+    m_Frames(nullptr),
+    m_CurrentFrame(nullptr),
+    m_NextFrameIndex(0),
+    m_FirstRegion(0),
+    m_RegionCount(0)
 {
 }
 
-VkResult VkAfterCrash_Device_T::Initialize()
+VkResult VkAfterCrash_Profiler_T::Initialize()
 {
-    if(UseAmdBufferMarker())
+    assert(m_CreateInfo.frameCount > 0 && m_CreateInfo.maxMarkersPerFrame > 0);
+
+    VkPhysicalDeviceProperties props = {};
+    vkGetPhysicalDeviceProperties(m_Device->GetVkPhysicalDevice(), &props);
+    m_TimestampPeriod = props.limits.timestampPeriod;
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(m_Device->GetVkPhysicalDevice(), &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(m_Device->GetVkPhysicalDevice(), &queueFamilyCount, queueFamilies.data());
+    assert(m_CreateInfo.queueFamilyIndex < queueFamilyCount);
+    const uint32_t validBits = m_CreateInfo.queueFamilyIndex < queueFamilyCount ?
+        queueFamilies[m_CreateInfo.queueFamilyIndex].timestampValidBits : 0;
+    if(validBits == 0)
+        return VK_ERROR_FEATURE_NOT_PRESENT;
+    m_TimestampMask = validBits < 64 ? (1ull << validBits) - 1 : UINT64_MAX;
+
+    m_Regions.resize((size_t)m_CreateInfo.frameCount * m_CreateInfo.maxMarkersPerFrame);
+    m_Frames = new Frame[m_CreateInfo.frameCount];
+    VkQueryPoolCreateInfo queryPoolCreateInfo = { VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+    queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolCreateInfo.queryCount = m_CreateInfo.maxMarkersPerFrame;
+    for(uint32_t i = 0; i < m_CreateInfo.frameCount; ++i)
     {
-        m_vkCmdWriteBufferMarkerAMD = (PFN_vkCmdWriteBufferMarkerAMD)vkGetDeviceProcAddr(GetVkDevice(), "vkCmdWriteBufferMarkerAMD");
-        if(m_vkCmdWriteBufferMarkerAMD == nullptr)
-            return VK_ERROR_FEATURE_NOT_PRESENT;
+        m_Frames[i].queryCount = 0;
+        m_Frames[i].queries.resize(m_CreateInfo.maxMarkersPerFrame);
+        VkResult res = vkCreateQueryPool(m_Device->GetVkDevice(), &queryPoolCreateInfo, nullptr, &m_Frames[i].vkQueryPool);
+        if(res != VK_SUCCESS)
+            return res;
     }
-
     return VK_SUCCESS;
 }
 
-VkAfterCrash_Device_T::~VkAfterCrash_Device_T()
+VkAfterCrash_Profiler_T::~VkAfterCrash_Profiler_T()
+{
+    if(m_Frames)
+    {
+        for(uint32_t i = 0; i < m_CreateInfo.frameCount; ++i)
+        {
+            if(m_Frames[i].vkQueryPool)
+                vkDestroyQueryPool(m_Device->GetVkDevice(), m_Frames[i].vkQueryPool, nullptr);
+        }
+        delete[] m_Frames;
+    }
+}
+
+void VkAfterCrash_Profiler_T::CmdBeginFrame(VkCommandBuffer vkCommandBuffer)
 {
+    Frame& frame = m_Frames[m_NextFrameIndex % m_CreateInfo.frameCount];
+    if(frame.pending)
+        Collect(frame);
+
+    vkCmdResetQueryPool(vkCommandBuffer, frame.vkQueryPool, 0, m_CreateInfo.maxMarkersPerFrame);
+    frame.frameIndex = m_NextFrameIndex++;
+    frame.pending = true;
+    frame.queryCount.store(0, std::memory_order_relaxed);
+    m_CurrentFrame = &frame;
 }
 
-bool VkAfterCrash_Device_T::FindMemoryTypeIndex(uint32_t memTypeBits, uint32_t* pMemTypeIndex) const
+void VkAfterCrash_Profiler_T::CmdWriteTimestamp(
+    VkCommandBuffer vkCommandBuffer,
+    VkPipelineStageFlagBits pipelineStage,
+    uint32_t value)
 {
-    VkPhysicalDeviceMemoryProperties memProps = {};
-    vkGetPhysicalDeviceMemoryProperties(m_CreateInfo.vkPhysicalDevice, &memProps);
-    
-    const uint32_t expectedFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-    for(uint32_t i = 0; i < memProps.memoryTypeCount; ++i)
+    Frame* const frame = m_CurrentFrame;
+    if(frame == nullptr)
+        return;
+    const uint32_t queryIndex = frame->queryCount.fetch_add(1, std::memory_order_relaxed);
+    if(queryIndex >= m_CreateInfo.maxMarkersPerFrame)
+        return;
+    frame->queries[queryIndex].vkCommandBuffer = vkCommandBuffer;
+    frame->queries[queryIndex].value = value;
+    vkCmdWriteTimestamp(vkCommandBuffer, pipelineStage, frame->vkQueryPool, queryIndex);
+}
+
+void VkAfterCrash_Profiler_T::Collect(Frame& frame)
+{
+    frame.pending = false;
+    const uint32_t queryCount = (std::min)(
+        frame.queryCount.load(std::memory_order_relaxed), m_CreateInfo.maxMarkersPerFrame);
+    if(queryCount == 0)
+        return;
+
+    // Pairs of timestamp and availability. Without VK_QUERY_RESULT_WAIT_BIT it
+    // doesn't wait and returns VK_NOT_READY if some are not available.
+    std::vector<uint64_t> results(queryCount * 2);
+    const VkResult res = vkGetQueryPoolResults(
+        m_Device->GetVkDevice(),
+        frame.vkQueryPool,
+        0,
+        queryCount,
+        results.size() * sizeof(uint64_t),
+        results.data(),
+        2 * sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if(res != VK_SUCCESS && res != VK_NOT_READY)
+        return;
+
+    // Queries of one command buffer were taken in the order of recording.
+    std::vector<uint32_t> order(queryCount);
+    for(uint32_t i = 0; i < queryCount; ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) {
+        return frame.queries[lhs].vkCommandBuffer < frame.queries[rhs].vkCommandBuffer;
+    });
+
+    std::lock_guard<std::mutex> lock(m_RegionsMutex);
+    for(uint32_t i = 0; i + 1 < queryCount; ++i)
     {
-        if(((1u << i) & memTypeBits) != 0 &&
-            (memProps.memoryTypes[i].propertyFlags & expectedFlags) == expectedFlags)
-        {
-            *pMemTypeIndex = i;
-            return true;
-        }
+        const uint32_t beg = order[i];
+        const uint32_t end = order[i + 1];
+        if(frame.queries[beg].vkCommandBuffer != frame.queries[end].vkCommandBuffer ||
+            results[beg * 2 + 1] == 0 || results[end * 2 + 1] == 0)
+            continue;
+        // Difference of masked timestamps is correct also if the counter
+        // wrapped around between them.
+        const uint64_t begTimestamp = results[beg * 2] & m_TimestampMask;
+        const uint64_t endTimestamp = results[end * 2] & m_TimestampMask;
+        VkAfterCrash_ProfilerRegion region = {};
+        region.frameIndex = frame.frameIndex;
+        region.vkCommandBuffer = frame.queries[beg].vkCommandBuffer;
+        region.value = frame.queries[beg].value;
+        region.beginNs = (uint64_t)((double)begTimestamp * m_TimestampPeriod);
+        region.durationNs = (uint64_t)((double)((endTimestamp - begTimestamp) & m_TimestampMask) * m_TimestampPeriod);
+        AddRegion(region);
     }
+}
 
-    *pMemTypeIndex = UINT32_MAX;
-    return false;
+void VkAfterCrash_Profiler_T::AddRegion(const VkAfterCrash_ProfilerRegion& region)
+{
+    const size_t capacity = m_Regions.size();
+    if(m_RegionCount == capacity)
+    {
+        m_FirstRegion = (m_FirstRegion + 1) % capacity;
+        --m_RegionCount;
+    }
+    m_Regions[(m_FirstRegion + m_RegionCount) % capacity] = region;
+    ++m_RegionCount;
+}
+
+uint32_t VkAfterCrash_Profiler_T::GetRegions(uint32_t maxRegionCount, VkAfterCrash_ProfilerRegion* pRegions)
+{
+    std::lock_guard<std::mutex> lock(m_RegionsMutex);
+    const uint32_t regionCount = (uint32_t)(std::min<size_t>)(maxRegionCount, m_RegionCount);
+    for(uint32_t i = 0; i < regionCount; ++i)
+        pRegions[i] = m_Regions[(m_FirstRegion + i) % m_Regions.size()];
+    m_FirstRegion = (m_FirstRegion + regionCount) % m_Regions.size();
+    m_RegionCount -= regionCount;
+    return regionCount;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -236,7 +1435,22 @@ public:
     ~VkAfterCrash_Buffer_T();
     
     uint32_t* GetData() const { return m_Data; }
+    bool IsFileBacked() const { return m_File.GetData() != nullptr; }
 
+    uint32_t AllocateMarkers(uint32_t markerCount);
+    void CmdWriteMarkers(
+        VkCommandBuffer vkCommandBuffer,
+        uint32_t markerCount,
+        const VkAfterCrash_Marker* pMarkers);
+    void CmdWriteMarkerRange(
+        VkCommandBuffer vkCommandBuffer,
+        uint32_t firstMarkerIndex,
+        uint32_t markerCount,
+        const uint32_t* pValues);
+    void CmdWriteMarkersExtended(
+        VkCommandBuffer vkCommandBuffer,
+        uint32_t markerCount,
+        const VkAfterCrash_Marker* pMarkers);
     void CmdWriteMarker(
         VkCommandBuffer vkCommandBuffer,
         uint32_t markerIndex,
@@ -252,7 +1466,15 @@ private:
     VkAfterCrash_BufferCreateInfo m_CreateInfo;
     VkDeviceMemory m_VkMemory;
     uint32_t* m_Data;
+    // Owned by the buffer or, if m_CreateInfo.pool is not null, by the pool.
     VkBuffer m_VkBuffer;
+    // Offset of marker 0 in m_VkBuffer, nonzero when allocated from a pool or
+    // file-backed, after the header.
+    VkDeviceSize m_Offset;
+    // Opened only if the buffer is file-backed.
+    VkAfterCrash_MappedFile m_File;
+    // Index of the first free marker slot, from 0 to markerCount.
+    std::atomic<uint32_t> m_NextMarkerIndex;
 };
 
 VkAfterCrash_Buffer_T::VkAfterCrash_Buffer_T(
@@ -262,55 +1484,100 @@ VkAfterCrash_Buffer_T::VkAfterCrash_Buffer_T(
     m_CreateInfo(createInfo),
     m_VkMemory(VK_NULL_HANDLE),
     m_Data(nullptr),
-    m_VkBuffer(VK_NULL_HANDLE)
+    m_VkBuffer(VK_NULL_HANDLE),
+    m_Offset(0),
+    m_NextMarkerIndex(0)
 {
 }
 
 VkResult VkAfterCrash_Buffer_T::Initialize()
 {
-    const VkDevice dev = m_Device->GetVkDevice();
-
-    VkBufferCreateInfo bufCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
-    bufCreateInfo.size = m_CreateInfo.markerCount * sizeof(uint32_t);
-    bufCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-
-    VkResult res = vkCreateBuffer(dev, &bufCreateInfo, nullptr, &m_VkBuffer);
-    if(res != VK_SUCCESS)
-        return res;
-
-    VkMemoryRequirements memReq = {};
-    vkGetBufferMemoryRequirements(dev, m_VkBuffer, &memReq);
-
-    VkMemoryAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
-    allocInfo.allocationSize = memReq.size;
-    bool ok = m_Device->FindMemoryTypeIndex(memReq.memoryTypeBits, &allocInfo.memoryTypeIndex);
-    if(!ok)
-        return VK_ERROR_FORMAT_NOT_SUPPORTED;
-    res = vkAllocateMemory(dev, &allocInfo, nullptr, &m_VkMemory);
-    if(res != VK_SUCCESS)
-        return res;
-
-    res = vkMapMemory(dev, m_VkMemory, 0, VK_WHOLE_SIZE, 0, (void**)&m_Data);
-    if(res != VK_SUCCESS)
-        return res;
+    if(m_CreateInfo.pool)
+    {
+        uint32_t firstMarkerIndex = 0;
+        if(!m_CreateInfo.pool->Allocate(m_CreateInfo.markerCount, &firstMarkerIndex))
+            return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        m_VkBuffer = m_CreateInfo.pool->GetVkBuffer();
+        m_Offset = firstMarkerIndex * sizeof(uint32_t);
+        m_Data = m_CreateInfo.pool->GetData() + firstMarkerIndex;
+        return VK_SUCCESS;
+    }
 
-    res = vkBindBufferMemory(dev, m_VkBuffer, m_VkMemory, 0);
-    if(res != VK_SUCCESS)
-        return res;
+    if(m_CreateInfo.filePath && m_Device->CanImportHostMemory())
+    {
+        const uint32_t headerSize = 64;
+        static_assert(sizeof(VkAfterCrash_FileHeader) <= headerSize, "");
+        VkResult res = m_Device->CreateFileBackedBuffer(
+            m_CreateInfo.filePath,
+            headerSize + m_CreateInfo.markerCount * sizeof(uint32_t),
+            m_File,
+            &m_VkBuffer,
+            &m_VkMemory);
+        if(res == VK_SUCCESS)
+        {
+            // New file is filled with zeros, so markers are not written yet.
+            VkAfterCrash_FileHeader* const header = (VkAfterCrash_FileHeader*)m_File.GetData();
+            memcpy(header->magic, VK_AFTER_CRASH_FILE_MAGIC, sizeof(header->magic));
+            header->version = VK_AFTER_CRASH_FILE_VERSION;
+            header->headerSize = headerSize;
+            header->markerCount = m_CreateInfo.markerCount;
+            header->creationTime = (uint64_t)time(nullptr);
+            // Only now the file replaces the one that may be left by previous crash.
+            if(m_File.Commit())
+            {
+                m_Offset = headerSize;
+                m_Data = (uint32_t*)((char*)m_File.GetData() + headerSize);
+                return VK_SUCCESS;
+            }
+        }
+        // Fall back to normal memory. Temporary file is deleted.
+        m_Device->DestroyMappedBuffer(m_VkBuffer, m_VkMemory, nullptr);
+        m_VkBuffer = VK_NULL_HANDLE;
+        m_VkMemory = VK_NULL_HANDLE;
+        m_File.Close();
+    }
 
-    return VK_SUCCESS;
+    return m_Device->CreateMappedBuffer(
+        m_CreateInfo.markerCount * sizeof(uint32_t),
+        &m_VkBuffer,
+        &m_VkMemory,
+        (void**)&m_Data);
 }
 
 VkAfterCrash_Buffer_T::~VkAfterCrash_Buffer_T()
 {
-    const VkDevice dev = m_Device->GetVkDevice();
+    if(m_CreateInfo.pool)
+    {
+        if(m_Data)
+            m_CreateInfo.pool->Free((uint32_t)(m_Offset / sizeof(uint32_t)), m_CreateInfo.markerCount);
+    }
+    else if(IsFileBacked())
+    {
+        // Memory is not mapped with vkMapMemory. The file is closed after
+        // freeing it, and stays on disk.
+        m_Device->DestroyMappedBuffer(m_VkBuffer, m_VkMemory, nullptr);
+    }
+    else
+        m_Device->DestroyMappedBuffer(m_VkBuffer, m_VkMemory, m_Data);
+}
 
-    if(m_Data)
-        vkUnmapMemory(dev, m_VkMemory);
-    if(m_VkBuffer)
-        vkDestroyBuffer(dev, m_VkBuffer, nullptr);
-    if(m_VkMemory)
-        vkFreeMemory(dev, m_VkMemory, nullptr);
+uint32_t VkAfterCrash_Buffer_T::AllocateMarkers(uint32_t markerCount)
+{
+    assert(markerCount > 0 && markerCount <= m_CreateInfo.markerCount);
+    uint32_t nextMarkerIndex = m_NextMarkerIndex.load(std::memory_order_relaxed);
+    for(;;)
+    {
+        // Range would cross the end of the buffer. Leave the rest unused and
+        // start again from the beginning.
+        const uint32_t firstMarkerIndex =
+            markerCount <= m_CreateInfo.markerCount - nextMarkerIndex ? nextMarkerIndex : 0;
+        if(m_NextMarkerIndex.compare_exchange_weak(
+            nextMarkerIndex, firstMarkerIndex + markerCount,
+            std::memory_order_relaxed, std::memory_order_relaxed))
+        {
+            return firstMarkerIndex;
+        }
+    }
 }
 
 void VkAfterCrash_Buffer_T::CmdWriteMarker(
@@ -321,8 +1588,10 @@ void VkAfterCrash_Buffer_T::CmdWriteMarker(
     vkCmdFillBuffer(
         vkCommandBuffer,
         m_VkBuffer,
-        markerIndex * sizeof(uint32_t),
+        m_Offset + markerIndex * sizeof(uint32_t),
         sizeof(uint32_t), value);
+    if(m_CreateInfo.profiler)
+        m_CreateInfo.profiler->CmdWriteTimestamp(vkCommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, value);
 }
 
 void VkAfterCrash_Buffer_T::CmdWriteMarkerExtended(
@@ -336,13 +1605,248 @@ void VkAfterCrash_Buffer_T::CmdWriteMarkerExtended(
         vkCommandBuffer,
         pipelineStage,
         m_VkBuffer,
-        markerIndex * sizeof(uint32_t),
+        m_Offset + markerIndex * sizeof(uint32_t),
         value);
+    if(m_CreateInfo.profiler)
+        m_CreateInfo.profiler->CmdWriteTimestamp(vkCommandBuffer, pipelineStage, value);
+}
+
+void VkAfterCrash_Buffer_T::CmdWriteMarkers(
+    VkCommandBuffer vkCommandBuffer,
+    uint32_t markerCount,
+    const VkAfterCrash_Marker* pMarkers)
+{
+    // vkCmdUpdateBuffer can write at most 65536 bytes. Longer runs of
+    // consecutive markers are split.
+    const uint32_t maxRunLength = 65536 / sizeof(uint32_t);
+    // Values of a run are gathered here to be passed to vkCmdUpdateBuffer.
+    // Runs too long for the array on the stack use the vector, allocated at
+    // most once per call.
+    uint32_t localValues[256];
+    std::vector<uint32_t> heapValues;
+    uint32_t i = 0;
+    while(i < markerCount)
+    {
+        const uint32_t firstMarkerIndex = pMarkers[i].markerIndex;
+        uint32_t runLength = 1;
+        while(i + runLength < markerCount &&
+            runLength < maxRunLength &&
+            pMarkers[i + runLength].markerIndex == firstMarkerIndex + runLength)
+        {
+            ++runLength;
+        }
+
+        assert(firstMarkerIndex + runLength <= m_CreateInfo.markerCount);
+        if(runLength == 1)
+        {
+            vkCmdFillBuffer(
+                vkCommandBuffer,
+                m_VkBuffer,
+                m_Offset + firstMarkerIndex * sizeof(uint32_t),
+                sizeof(uint32_t), pMarkers[i].value);
+        }
+        else
+        {
+            uint32_t* values = localValues;
+            if(runLength > sizeof(localValues) / sizeof(localValues[0]))
+            {
+                if(heapValues.empty())
+                    heapValues.resize((std::min)(markerCount - i, maxRunLength));
+                values = heapValues.data();
+            }
+            for(uint32_t j = 0; j < runLength; ++j)
+                values[j] = pMarkers[i + j].value;
+            vkCmdUpdateBuffer(
+                vkCommandBuffer,
+                m_VkBuffer,
+                m_Offset + firstMarkerIndex * sizeof(uint32_t),
+                runLength * sizeof(uint32_t),
+                values);
+        }
+        i += runLength;
+    }
+}
+
+void VkAfterCrash_Buffer_T::CmdWriteMarkerRange(
+    VkCommandBuffer vkCommandBuffer,
+    uint32_t firstMarkerIndex,
+    uint32_t markerCount,
+    const uint32_t* pValues)
+{
+    assert(firstMarkerIndex + markerCount <= m_CreateInfo.markerCount);
+    // vkCmdUpdateBuffer can write at most 65536 bytes.
+    const uint32_t maxUpdateMarkerCount = 65536 / sizeof(uint32_t);
+    while(markerCount > 0)
+    {
+        const uint32_t updateMarkerCount = markerCount < maxUpdateMarkerCount ? markerCount : maxUpdateMarkerCount;
+        vkCmdUpdateBuffer(
+            vkCommandBuffer,
+            m_VkBuffer,
+            m_Offset + firstMarkerIndex * sizeof(uint32_t),
+            updateMarkerCount * sizeof(uint32_t),
+            pValues);
+        firstMarkerIndex += updateMarkerCount;
+        markerCount -= updateMarkerCount;
+        pValues += updateMarkerCount;
+    }
+}
+
+void VkAfterCrash_Buffer_T::CmdWriteMarkersExtended(
+    VkCommandBuffer vkCommandBuffer,
+    uint32_t markerCount,
+    const VkAfterCrash_Marker* pMarkers)
+{
+    assert(m_Device->UseAmdBufferMarker());
+    const PFN_vkCmdWriteBufferMarkerAMD vkCmdWriteBufferMarkerAMD = m_Device->GetVkCmdWriteBufferMarkerAMD();
+    for(uint32_t i = 0; i < markerCount; ++i)
+    {
+        vkCmdWriteBufferMarkerAMD(
+            vkCommandBuffer,
+            pMarkers[i].pipelineStage,
+            m_VkBuffer,
+            m_Offset + pMarkers[i].markerIndex * sizeof(uint32_t),
+            pMarkers[i].value);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// struct VkAfterCrash_Timeline_T
+
+struct VkAfterCrash_Timeline_T
+{
+public:
+    VkAfterCrash_Timeline_T(const VkAfterCrash_TimelineCreateInfo& createInfo);
+    ~VkAfterCrash_Timeline_T();
+
+    // Takes the next sequence number and stores the entry under it.
+    uint32_t AddEntry(VkCommandBuffer vkCommandBuffer, const char* label);
+    // Return the sequence number written.
+    uint32_t CmdWriteMarker(
+        VkCommandBuffer vkCommandBuffer,
+        const char* label);
+    uint32_t CmdWriteMarkerExtended(
+        VkCommandBuffer vkCommandBuffer,
+        const char* label,
+        VkPipelineStageFlagBits pipelineStage);
+    uint32_t GetSequence() const;
+    bool GetEntry(uint32_t sequence, VkAfterCrash_TimelineEntry* pEntry) const;
+
+private:
+    // Entry::sequence while a thread is writing the entry. Never taken as a
+    // sequence number.
+    static const uint32_t BUSY_SEQUENCE = UINT32_MAX;
+
+    struct Entry
+    {
+        // Claimed by setting to BUSY_SEQUENCE, stored last, so an entry with
+        // matching sequence is complete.
+        std::atomic<uint32_t> sequence;
+        // Atomic only so they can be read while written by another thread.
+        std::atomic<VkCommandBuffer> vkCommandBuffer;
+        std::atomic<const char*> label;
+    };
+
+    VkAfterCrash_TimelineCreateInfo m_CreateInfo;
+    std::atomic<uint32_t> m_LastSequence;
+    Entry* m_Entries;
+};
+
+VkAfterCrash_Timeline_T::VkAfterCrash_Timeline_T(const VkAfterCrash_TimelineCreateInfo& createInfo) :
+    m_CreateInfo(createInfo),
+    m_LastSequence(0),
+    m_Entries(new Entry[createInfo.entryCount])
+{
+    for(uint32_t i = 0; i < m_CreateInfo.entryCount; ++i)
+    {
+        m_Entries[i].sequence.store(0, std::memory_order_relaxed);
+        m_Entries[i].vkCommandBuffer.store(VK_NULL_HANDLE, std::memory_order_relaxed);
+        m_Entries[i].label.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+VkAfterCrash_Timeline_T::~VkAfterCrash_Timeline_T()
+{
+    delete[] m_Entries;
+}
+
+uint32_t VkAfterCrash_Timeline_T::AddEntry(VkCommandBuffer vkCommandBuffer, const char* label)
+{
+    // 0 means no marker executed, so it is skipped when the counter wraps.
+    uint32_t sequence;
+    do
+    {
+        sequence = m_LastSequence.fetch_add(1, std::memory_order_relaxed) + 1;
+    } while(sequence == 0 || sequence == BUSY_SEQUENCE);
+
+    // Claim the entry, so two threads with sequence numbers entryCount apart
+    // never write it at the same time. If it is being written or already
+    // holds a newer sequence number, entryCount is too small and this entry
+    // is lost.
+    Entry& entry = m_Entries[sequence % m_CreateInfo.entryCount];
+    uint32_t prevSequence = entry.sequence.load(std::memory_order_relaxed);
+    do
+    {
+        if(prevSequence == BUSY_SEQUENCE ||
+            (prevSequence != 0 && (int32_t)(prevSequence - sequence) > 0))
+        {
+            return sequence;
+        }
+    } while(!entry.sequence.compare_exchange_weak(
+        prevSequence, BUSY_SEQUENCE, std::memory_order_relaxed, std::memory_order_relaxed));
+    // Orders the claim before the fields for GetEntry reading them.
+    std::atomic_thread_fence(std::memory_order_release);
+
+    entry.vkCommandBuffer.store(vkCommandBuffer, std::memory_order_relaxed);
+    entry.label.store(label, std::memory_order_relaxed);
+    entry.sequence.store(sequence, std::memory_order_release);
+    return sequence;
+}
+
+uint32_t VkAfterCrash_Timeline_T::CmdWriteMarker(
+    VkCommandBuffer vkCommandBuffer,
+    const char* label)
+{
+    const uint32_t sequence = AddEntry(vkCommandBuffer, label);
+    m_CreateInfo.buffer->CmdWriteMarker(vkCommandBuffer, m_CreateInfo.markerIndex, sequence);
+    return sequence;
+}
+
+uint32_t VkAfterCrash_Timeline_T::CmdWriteMarkerExtended(
+    VkCommandBuffer vkCommandBuffer,
+    const char* label,
+    VkPipelineStageFlagBits pipelineStage)
+{
+    const uint32_t sequence = AddEntry(vkCommandBuffer, label);
+    m_CreateInfo.buffer->CmdWriteMarkerExtended(vkCommandBuffer, m_CreateInfo.markerIndex, sequence, pipelineStage);
+    return sequence;
+}
+
+uint32_t VkAfterCrash_Timeline_T::GetSequence() const
+{
+    // Written by GPU, so it must be read from memory every time.
+    return *(volatile const uint32_t*)(m_CreateInfo.buffer->GetData() + m_CreateInfo.markerIndex);
+}
+
+bool VkAfterCrash_Timeline_T::GetEntry(uint32_t sequence, VkAfterCrash_TimelineEntry* pEntry) const
+{
+    if(sequence == 0)
+        return false;
+    const Entry& entry = m_Entries[sequence % m_CreateInfo.entryCount];
+    if(entry.sequence.load(std::memory_order_acquire) != sequence)
+        return false;
+    pEntry->sequence = sequence;
+    pEntry->vkCommandBuffer = entry.vkCommandBuffer.load(std::memory_order_relaxed);
+    pEntry->label = entry.label.load(std::memory_order_relaxed);
+    // Claimed meanwhile by another thread, so the fields may be mixed.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return entry.sequence.load(std::memory_order_relaxed) == sequence;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // Global functions
 
+VkAfterCrash_MarkerLevel VkAfterCrash_MarkerLevelThreshold = VK_AFTER_CRASH_MARKER_LEVEL_FINE;
+
 VkResult VkAfterCrash_CreateDevice(
     const VkAfterCrash_DeviceCreateInfo* pCreateInfo,
     VkAfterCrash_Device* pDevice)
@@ -364,6 +1868,100 @@ void VkAfterCrash_DestroyDevice(
     delete device;
 }
 
+VkResult VkAfterCrash_CreatePool(
+    VkAfterCrash_Device device,
+    const VkAfterCrash_PoolCreateInfo* pCreateInfo,
+    VkAfterCrash_Pool* pPool)
+{
+    assert(device && pCreateInfo && pPool);
+    *pPool = new VkAfterCrash_Pool_T(device, *pCreateInfo);
+    VkResult res = (*pPool)->Initialize();
+    if(res != VK_SUCCESS)
+    {
+        delete *pPool;
+        *pPool = nullptr;
+    }
+    return res;
+}
+
+void VkAfterCrash_DestroyPool(
+    VkAfterCrash_Pool pool)
+{
+    delete pool;
+}
+
+VkResult VkAfterCrash_CreateProfiler(
+    VkAfterCrash_Device device,
+    const VkAfterCrash_ProfilerCreateInfo* pCreateInfo,
+    VkAfterCrash_Profiler* pProfiler)
+{
+    assert(device && pCreateInfo && pProfiler);
+    *pProfiler = new VkAfterCrash_Profiler_T(device, *pCreateInfo);
+    VkResult res = (*pProfiler)->Initialize();
+    if(res != VK_SUCCESS)
+    {
+        delete *pProfiler;
+        *pProfiler = nullptr;
+    }
+    return res;
+}
+
+void VkAfterCrash_DestroyProfiler(
+    VkAfterCrash_Profiler profiler)
+{
+    delete profiler;
+}
+
+void VkAfterCrash_CmdBeginProfilerFrame(
+    VkCommandBuffer vkCommandBuffer,
+    VkAfterCrash_Profiler profiler)
+{
+    assert(vkCommandBuffer && profiler);
+    profiler->CmdBeginFrame(vkCommandBuffer);
+}
+
+uint32_t VkAfterCrash_GetProfilerRegions(
+    VkAfterCrash_Profiler profiler,
+    uint32_t maxRegionCount,
+    VkAfterCrash_ProfilerRegion* pRegions)
+{
+    assert(profiler && (maxRegionCount == 0 || pRegions));
+    return profiler->GetRegions(maxRegionCount, pRegions);
+}
+
+VkResult VkAfterCrash_WriteProfilerTrace(
+    const char* filePath,
+    uint32_t regionCount,
+    const VkAfterCrash_ProfilerRegion* pRegions)
+{
+    assert(filePath && (regionCount == 0 || pRegions));
+    FILE* file = fopen(filePath, "w");
+    if(file == nullptr)
+        return VK_ERROR_INITIALIZATION_FAILED;
+
+    // Command buffers become threads with consecutive IDs.
+    std::map<VkCommandBuffer, uint32_t> threadIds;
+    fprintf(file, "{\"traceEvents\": [");
+    for(uint32_t i = 0; i < regionCount; ++i)
+    {
+        const VkAfterCrash_ProfilerRegion& region = pRegions[i];
+        const uint32_t threadId = threadIds.insert(
+            std::make_pair(region.vkCommandBuffer, (uint32_t)threadIds.size())).first->second;
+        // Times are in microseconds.
+        fprintf(file, "%s\n{\"name\": \"0x%08X\", \"ph\": \"X\", \"pid\": 0, \"tid\": %u, "
+            "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"frame\": %llu}}",
+            i ? "," : "",
+            region.value,
+            threadId,
+            (double)region.beginNs * 1e-3,
+            (double)region.durationNs * 1e-3,
+            (unsigned long long)region.frameIndex);
+    }
+    fprintf(file, "\n]}\n");
+    const bool ok = ferror(file) == 0;
+    return fclose(file) == 0 && ok ? VK_SUCCESS : VK_ERROR_INITIALIZATION_FAILED;
+}
+
 VkResult VkAfterCrash_CreateBuffer(
     VkAfterCrash_Device device,
     const VkAfterCrash_BufferCreateInfo* pCreateInfo,
@@ -371,6 +1969,7 @@ VkResult VkAfterCrash_CreateBuffer(
     uint32_t** pData)
 {
     assert(device && pCreateInfo && pBuffer && pData);
+    assert(!(pCreateInfo->pool && pCreateInfo->filePath));
     *pBuffer = new VkAfterCrash_Buffer_T(device, *pCreateInfo);
     VkResult res = (*pBuffer)->Initialize();
     if(res == VK_SUCCESS)
@@ -390,6 +1989,13 @@ void VkAfterCrash_DestroyBuffer(
     delete buffer;
 }
 
+VkBool32 VkAfterCrash_IsBufferFileBacked(
+    VkAfterCrash_Buffer buffer)
+{
+    assert(buffer);
+    return buffer->IsFileBacked() ? VK_TRUE : VK_FALSE;
+}
+
 void VkAfterCrash_CmdWriteMarker(
     VkCommandBuffer vkCommandBuffer,
     VkAfterCrash_Buffer buffer,
@@ -411,4 +2017,141 @@ void VkAfterCrash_CmdWriteMarkerExtended(
     buffer->CmdWriteMarkerExtended(vkCommandBuffer, markerIndex, value, pipelineStage);
 }
 
+void VkAfterCrash_CmdWriteMarkers(
+    VkCommandBuffer vkCommandBuffer,
+    VkAfterCrash_Buffer buffer,
+    uint32_t markerCount,
+    const VkAfterCrash_Marker* pMarkers)
+{
+    assert(vkCommandBuffer && buffer && (markerCount == 0 || pMarkers));
+    buffer->CmdWriteMarkers(vkCommandBuffer, markerCount, pMarkers);
+}
+
+void VkAfterCrash_CmdWriteMarkerRange(
+    VkCommandBuffer vkCommandBuffer,
+    VkAfterCrash_Buffer buffer,
+    uint32_t firstMarkerIndex,
+    uint32_t markerCount,
+    const uint32_t* pValues)
+{
+    assert(vkCommandBuffer && buffer && (markerCount == 0 || pValues));
+    buffer->CmdWriteMarkerRange(vkCommandBuffer, firstMarkerIndex, markerCount, pValues);
+}
+
+void VkAfterCrash_CmdWriteMarkersExtended(
+    VkCommandBuffer vkCommandBuffer,
+    VkAfterCrash_Buffer buffer,
+    uint32_t markerCount,
+    const VkAfterCrash_Marker* pMarkers)
+{
+    assert(vkCommandBuffer && buffer && (markerCount == 0 || pMarkers));
+    buffer->CmdWriteMarkersExtended(vkCommandBuffer, markerCount, pMarkers);
+}
+
+uint32_t VkAfterCrash_AllocateMarkers(
+    VkAfterCrash_Buffer buffer,
+    uint32_t markerCount)
+{
+    assert(buffer);
+    return buffer->AllocateMarkers(markerCount);
+}
+
+void VkAfterCrash_BeginMarkerRange(
+    VkAfterCrash_Buffer buffer,
+    uint32_t markerCount,
+    VkAfterCrash_MarkerRange* pRange)
+{
+    assert(buffer && pRange);
+    pRange->buffer = buffer;
+    pRange->markerCount = markerCount;
+    pRange->nextMarkerIndex = buffer->AllocateMarkers(markerCount);
+    pRange->endMarkerIndex = pRange->nextMarkerIndex + markerCount;
+}
+
+static uint32_t VkAfterCrash_TakeNextMarker(
+    VkAfterCrash_MarkerRange* pRange)
+{
+    if(pRange->nextMarkerIndex == pRange->endMarkerIndex)
+    {
+        pRange->nextMarkerIndex = pRange->buffer->AllocateMarkers(pRange->markerCount);
+        pRange->endMarkerIndex = pRange->nextMarkerIndex + pRange->markerCount;
+    }
+    return pRange->nextMarkerIndex++;
+}
+
+uint32_t VkAfterCrash_CmdWriteNextMarker(
+    VkCommandBuffer vkCommandBuffer,
+    VkAfterCrash_MarkerRange* pRange,
+    uint32_t value)
+{
+    assert(vkCommandBuffer && pRange && pRange->buffer);
+    const uint32_t markerIndex = VkAfterCrash_TakeNextMarker(pRange);
+    pRange->buffer->CmdWriteMarker(vkCommandBuffer, markerIndex, value);
+    return markerIndex;
+}
+
+uint32_t VkAfterCrash_CmdWriteNextMarkerExtended(
+    VkCommandBuffer vkCommandBuffer,
+    VkAfterCrash_MarkerRange* pRange,
+    uint32_t value,
+    VkPipelineStageFlagBits pipelineStage)
+{
+    assert(vkCommandBuffer && pRange && pRange->buffer);
+    const uint32_t markerIndex = VkAfterCrash_TakeNextMarker(pRange);
+    pRange->buffer->CmdWriteMarkerExtended(vkCommandBuffer, markerIndex, value, pipelineStage);
+    return markerIndex;
+}
+
+VkResult VkAfterCrash_CreateTimeline(
+    VkAfterCrash_Device device,
+    const VkAfterCrash_TimelineCreateInfo* pCreateInfo,
+    VkAfterCrash_Timeline* pTimeline)
+{
+    assert(device && pCreateInfo && pTimeline);
+    assert(pCreateInfo->buffer && pCreateInfo->entryCount > 0);
+    *pTimeline = new VkAfterCrash_Timeline_T(*pCreateInfo);
+    return VK_SUCCESS;
+}
+
+void VkAfterCrash_DestroyTimeline(
+    VkAfterCrash_Timeline timeline)
+{
+    delete timeline;
+}
+
+uint32_t VkAfterCrash_CmdWriteTimelineMarker(
+    VkCommandBuffer vkCommandBuffer,
+    VkAfterCrash_Timeline timeline,
+    const char* label)
+{
+    assert(vkCommandBuffer && timeline);
+    return timeline->CmdWriteMarker(vkCommandBuffer, label);
+}
+
+uint32_t VkAfterCrash_CmdWriteTimelineMarkerExtended(
+    VkCommandBuffer vkCommandBuffer,
+    VkAfterCrash_Timeline timeline,
+    const char* label,
+    VkPipelineStageFlagBits pipelineStage)
+{
+    assert(vkCommandBuffer && timeline);
+    return timeline->CmdWriteMarkerExtended(vkCommandBuffer, label, pipelineStage);
+}
+
+uint32_t VkAfterCrash_GetTimelineSequence(
+    VkAfterCrash_Timeline timeline)
+{
+    assert(timeline);
+    return timeline->GetSequence();
+}
+
+VkBool32 VkAfterCrash_GetTimelineEntry(
+    VkAfterCrash_Timeline timeline,
+    uint32_t sequence,
+    VkAfterCrash_TimelineEntry* pEntry)
+{
+    assert(timeline && pEntry);
+    return timeline->GetEntry(sequence, pEntry) ? VK_TRUE : VK_FALSE;
+}
+
 #endif // #ifdef VULKAN_AFTER_CRASH_IMPLEMENTATION
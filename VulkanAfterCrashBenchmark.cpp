@@ -0,0 +1,428 @@
+/*
+VulkanAfterCrashBenchmark.cpp
+
+Author:  Adam Sawicki, http://asawicki.info, adam__REMOVE__@asawicki.info
+Version: 1.0.0, 2026-10-19
+License: MIT
+
+Measures overhead of markers from VulkanAfterCrash.h, to decide how many of
+them can be left enabled:
+
+1. CPU cost of recording one marker, written using:
+   - VkAfterCrash_CmdWriteMarker - vkCmdFillBuffer per marker.
+   - VkAfterCrash_CmdWriteMarkerRange - vkCmdUpdateBuffer per batch of
+     markers, for different batch sizes.
+   - VkAfterCrash_CmdWriteMarkerExtended - vkCmdWriteBufferMarkerAMD per
+     marker, if VK_AMD_buffer_marker is supported.
+2. GPU cost of executing them, measured with timestamp queries, for different
+   marker densities: from one marker per pass to one marker per draw. Draws
+   are simulated by WORK_ITEM_COUNT vkCmdFillBuffer commands, each filling
+   WORK_ITEM_SIZE bytes, so no shaders are needed. Markers are written between
+   them using each of the methods above, vkCmdUpdateBuffer with one marker.
+
+Results are differences from the same work recorded or executed without
+markers, divided by number of markers. GPU results are also shown as
+a percentage of the time without markers, which for sparse markers is more
+meaningful than the cost of a single marker, hidden in noise.
+
+To use a software driver like lavapipe from Mesa instead of a GPU, point the
+Vulkan loader to its ICD, e.g.:
+
+    VK_DRIVER_FILES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json VulkanAfterCrashBenchmark
+
+(VK_ICD_FILENAMES with older Vulkan loader.) Results on a software driver are
+only a rough estimate of the ones on a real GPU, especially on the GPU side.
+
+Usage:
+    VulkanAfterCrashBenchmark [--device N] [--csv | --json]
+
+--device N    - index of physical device to use. Default: 0.
+--csv, --json - additionally print raw results of CPU measurements.
+
+Build, e.g.:
+    g++ -O2 -std=c++14 VulkanAfterCrashBenchmark.cpp -lvulkan
+*/
+#define VULKAN_AFTER_CRASH_IMPLEMENTATION
+#include "VulkanAfterCrash.h"
+
+#define MICRO_BENCHMARK_IMPLEMENTATION
+#include "MicroBenchmark/MicroBenchmark.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// CPU part: markers recorded to a command buffer per iteration.
+static const uint32_t MARKER_COUNT = 4096;
+static const uint32_t BATCH_SIZES[] = { 16, 256, 4096 };
+static const size_t BATCH_SIZE_COUNT = sizeof(BATCH_SIZES) / sizeof(BATCH_SIZES[0]);
+
+// GPU part.
+static const uint32_t WORK_ITEM_COUNT = 4096;
+static const VkDeviceSize WORK_ITEM_SIZE = 4096;
+// Number of work items per marker.
+static const uint32_t DENSITIES[] = { 4096, 256, 16, 1 };
+static const char* const DENSITY_NAMES[] = { "Per pass", "Per 256", "Per 16", "Per draw" };
+static const size_t DENSITY_COUNT = sizeof(DENSITIES) / sizeof(DENSITIES[0]);
+// Median of this number of submissions is taken.
+static const uint32_t GPU_REPEAT_COUNT = 15;
+
+enum METHOD
+{
+    METHOD_NONE,
+    METHOD_FILL_BUFFER,
+    METHOD_UPDATE_BUFFER,
+    METHOD_AMD_BUFFER_MARKER,
+    METHOD_COUNT
+};
+
+static const char* const METHOD_NAMES[METHOD_COUNT] = {
+    "None",
+    "vkCmdFillBuffer",
+    "vkCmdUpdateBuffer",
+    "vkCmdWriteBufferMarkerAMD",
+};
+
+#define CHECK_VK(expr) do { if((expr) != VK_SUCCESS) { printf("%s failed.\n", #expr); exit(1); } } while(false)
+
+struct VULKAN
+{
+    VkInstance Instance = VK_NULL_HANDLE;
+    VkPhysicalDevice PhysicalDevice = VK_NULL_HANDLE;
+    VkDevice Device = VK_NULL_HANDLE;
+    VkQueue Queue = VK_NULL_HANDLE;
+    VkCommandPool CommandPool = VK_NULL_HANDLE;
+    VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+    VkFence Fence = VK_NULL_HANDLE;
+    VkQueryPool QueryPool = VK_NULL_HANDLE;
+    VkBuffer WorkBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory WorkMemory = VK_NULL_HANDLE;
+    float TimestampPeriod = 1.f;
+    bool AmdBufferMarker = false;
+};
+
+static bool HasDeviceExtension(VkPhysicalDevice physicalDevice, const char* name)
+{
+    uint32_t count = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, nullptr);
+    std::vector<VkExtensionProperties> extensions(count);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, extensions.data());
+    for(uint32_t i = 0; i < count; ++i)
+    {
+        if(strcmp(extensions[i].extensionName, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+static void InitVulkan(VULKAN& vk, uint32_t deviceIndex)
+{
+    VkApplicationInfo appInfo = { VK_STRUCTURE_TYPE_APPLICATION_INFO };
+    appInfo.pApplicationName = "VulkanAfterCrashBenchmark";
+    appInfo.apiVersion = VK_API_VERSION_1_0;
+    VkInstanceCreateInfo instanceCreateInfo = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+    instanceCreateInfo.pApplicationInfo = &appInfo;
+    CHECK_VK(vkCreateInstance(&instanceCreateInfo, nullptr, &vk.Instance));
+
+    uint32_t physicalDeviceCount = 0;
+    vkEnumeratePhysicalDevices(vk.Instance, &physicalDeviceCount, nullptr);
+    std::vector<VkPhysicalDevice> physicalDevices(physicalDeviceCount);
+    vkEnumeratePhysicalDevices(vk.Instance, &physicalDeviceCount, physicalDevices.data());
+    if(deviceIndex >= physicalDeviceCount)
+    {
+        printf("Physical device %u not found. Number of devices: %u.\n", deviceIndex, physicalDeviceCount);
+        exit(1);
+    }
+    vk.PhysicalDevice = physicalDevices[deviceIndex];
+
+    VkPhysicalDeviceProperties props = {};
+    vkGetPhysicalDeviceProperties(vk.PhysicalDevice, &props);
+    vk.TimestampPeriod = props.limits.timestampPeriod;
+    printf("Device: %s\n", props.deviceName);
+
+    // Any queue supports transfer commands.
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(vk.PhysicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(vk.PhysicalDevice, &queueFamilyCount, queueFamilies.data());
+    uint32_t queueFamilyIndex = UINT32_MAX;
+    for(uint32_t i = 0; i < queueFamilyCount && queueFamilyIndex == UINT32_MAX; ++i)
+    {
+        if((queueFamilies[i].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) != 0 &&
+            queueFamilies[i].timestampValidBits > 0)
+            queueFamilyIndex = i;
+    }
+    if(queueFamilyIndex == UINT32_MAX)
+    {
+        printf("No queue supporting timestamps found.\n");
+        exit(1);
+    }
+
+    vk.AmdBufferMarker = HasDeviceExtension(vk.PhysicalDevice, "VK_AMD_buffer_marker");
+    const char* const extensionName = "VK_AMD_buffer_marker";
+
+    const float queuePriority = 1.f;
+    VkDeviceQueueCreateInfo queueCreateInfo = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO };
+    queueCreateInfo.queueFamilyIndex = queueFamilyIndex;
+    queueCreateInfo.queueCount = 1;
+    queueCreateInfo.pQueuePriorities = &queuePriority;
+    VkDeviceCreateInfo deviceCreateInfo = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+    deviceCreateInfo.queueCreateInfoCount = 1;
+    deviceCreateInfo.pQueueCreateInfos = &queueCreateInfo;
+    deviceCreateInfo.enabledExtensionCount = vk.AmdBufferMarker ? 1 : 0;
+    deviceCreateInfo.ppEnabledExtensionNames = &extensionName;
+    CHECK_VK(vkCreateDevice(vk.PhysicalDevice, &deviceCreateInfo, nullptr, &vk.Device));
+    vkGetDeviceQueue(vk.Device, queueFamilyIndex, 0, &vk.Queue);
+
+    VkCommandPoolCreateInfo commandPoolCreateInfo = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+    commandPoolCreateInfo.queueFamilyIndex = queueFamilyIndex;
+    CHECK_VK(vkCreateCommandPool(vk.Device, &commandPoolCreateInfo, nullptr, &vk.CommandPool));
+    VkCommandBufferAllocateInfo commandBufferAllocateInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+    commandBufferAllocateInfo.commandPool = vk.CommandPool;
+    commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    commandBufferAllocateInfo.commandBufferCount = 1;
+    CHECK_VK(vkAllocateCommandBuffers(vk.Device, &commandBufferAllocateInfo, &vk.CommandBuffer));
+
+    VkFenceCreateInfo fenceCreateInfo = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+    CHECK_VK(vkCreateFence(vk.Device, &fenceCreateInfo, nullptr, &vk.Fence));
+
+    VkQueryPoolCreateInfo queryPoolCreateInfo = { VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+    queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolCreateInfo.queryCount = 2;
+    CHECK_VK(vkCreateQueryPool(vk.Device, &queryPoolCreateInfo, nullptr, &vk.QueryPool));
+
+    // Destination of simulated draws. Any memory type will do.
+    VkBufferCreateInfo bufferCreateInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    bufferCreateInfo.size = WORK_ITEM_COUNT * WORK_ITEM_SIZE;
+    bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    CHECK_VK(vkCreateBuffer(vk.Device, &bufferCreateInfo, nullptr, &vk.WorkBuffer));
+    VkMemoryRequirements memReq = {};
+    vkGetBufferMemoryRequirements(vk.Device, vk.WorkBuffer, &memReq);
+    VkMemoryAllocateInfo allocInfo = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+    allocInfo.allocationSize = memReq.size;
+    while((memReq.memoryTypeBits & (1u << allocInfo.memoryTypeIndex)) == 0)
+        ++allocInfo.memoryTypeIndex;
+    CHECK_VK(vkAllocateMemory(vk.Device, &allocInfo, nullptr, &vk.WorkMemory));
+    CHECK_VK(vkBindBufferMemory(vk.Device, vk.WorkBuffer, vk.WorkMemory, 0));
+}
+
+static void DestroyVulkan(VULKAN& vk)
+{
+    vkDestroyBuffer(vk.Device, vk.WorkBuffer, nullptr);
+    vkFreeMemory(vk.Device, vk.WorkMemory, nullptr);
+    vkDestroyQueryPool(vk.Device, vk.QueryPool, nullptr);
+    vkDestroyFence(vk.Device, vk.Fence, nullptr);
+    vkDestroyCommandPool(vk.Device, vk.CommandPool, nullptr);
+    vkDestroyDevice(vk.Device, nullptr);
+    vkDestroyInstance(vk.Instance, nullptr);
+}
+
+static void BeginCommandBuffer(const VULKAN& vk)
+{
+    CHECK_VK(vkResetCommandPool(vk.Device, vk.CommandPool, 0));
+    VkCommandBufferBeginInfo beginInfo = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    CHECK_VK(vkBeginCommandBuffer(vk.CommandBuffer, &beginInfo));
+}
+
+static void WriteMarker(const VULKAN& vk, VkAfterCrash_Buffer buffer, METHOD method, uint32_t markerIndex)
+{
+    switch(method)
+    {
+    case METHOD_FILL_BUFFER:
+        VkAfterCrash_CmdWriteMarker(vk.CommandBuffer, buffer, markerIndex, markerIndex + 1);
+        break;
+    case METHOD_UPDATE_BUFFER:
+    {
+        const uint32_t value = markerIndex + 1;
+        VkAfterCrash_CmdWriteMarkerRange(vk.CommandBuffer, buffer, markerIndex, 1, &value);
+        break;
+    }
+    case METHOD_AMD_BUFFER_MARKER:
+        VkAfterCrash_CmdWriteMarkerExtended(vk.CommandBuffer, buffer, markerIndex, markerIndex + 1,
+            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+        break;
+    default:
+        break;
+    }
+}
+
+// Returns GPU time of WORK_ITEM_COUNT work items with a marker every
+// workItemsPerMarker of them, in nanoseconds, as median of GPU_REPEAT_COUNT
+// submissions.
+static double MeasureGpuNs(const VULKAN& vk, VkAfterCrash_Buffer buffer, METHOD method, uint32_t workItemsPerMarker)
+{
+    std::vector<double> samples;
+    for(uint32_t repeat = 0; repeat < GPU_REPEAT_COUNT; ++repeat)
+    {
+        BeginCommandBuffer(vk);
+        vkCmdResetQueryPool(vk.CommandBuffer, vk.QueryPool, 0, 2);
+        vkCmdWriteTimestamp(vk.CommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vk.QueryPool, 0);
+        for(uint32_t i = 0; i < WORK_ITEM_COUNT; ++i)
+        {
+            if(i % workItemsPerMarker == 0)
+                WriteMarker(vk, buffer, method, i / workItemsPerMarker);
+            vkCmdFillBuffer(vk.CommandBuffer, vk.WorkBuffer, i * WORK_ITEM_SIZE, WORK_ITEM_SIZE, i);
+        }
+        vkCmdWriteTimestamp(vk.CommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vk.QueryPool, 1);
+        CHECK_VK(vkEndCommandBuffer(vk.CommandBuffer));
+
+        VkSubmitInfo submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &vk.CommandBuffer;
+        CHECK_VK(vkQueueSubmit(vk.Queue, 1, &submitInfo, vk.Fence));
+        CHECK_VK(vkWaitForFences(vk.Device, 1, &vk.Fence, VK_TRUE, UINT64_MAX));
+        CHECK_VK(vkResetFences(vk.Device, 1, &vk.Fence));
+
+        uint64_t timestamps[2] = {};
+        CHECK_VK(vkGetQueryPoolResults(vk.Device, vk.QueryPool, 0, 2, sizeof(timestamps), timestamps,
+            sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+        samples.push_back((double)(timestamps[1] - timestamps[0]) * vk.TimestampPeriod);
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t deviceIndex = 0;
+    bool writeCsv = false;
+    bool writeJson = false;
+    for(int i = 1; i < argc; ++i)
+    {
+        if(strcmp(argv[i], "--device") == 0 && i + 1 < argc)
+            deviceIndex = (uint32_t)atoi(argv[++i]);
+        else if(strcmp(argv[i], "--csv") == 0)
+            writeCsv = true;
+        else if(strcmp(argv[i], "--json") == 0)
+            writeJson = true;
+        else
+        {
+            printf("Usage: VulkanAfterCrashBenchmark [--device N] [--csv | --json]\n");
+            return 2;
+        }
+    }
+
+    VULKAN vk;
+    InitVulkan(vk, deviceIndex);
+    printf("VK_AMD_buffer_marker: %s\n", vk.AmdBufferMarker ? "supported" : "not supported");
+
+    VkAfterCrash_DeviceCreateInfo deviceCreateInfo = {};
+    deviceCreateInfo.flags = vk.AmdBufferMarker ? VK_AFTER_CRASH_DEVICE_CREATE_USE_AMD_BUFFER_MARKER_BIT : 0;
+    deviceCreateInfo.vkPhysicalDevice = vk.PhysicalDevice;
+    deviceCreateInfo.vkDevice = vk.Device;
+    VkAfterCrash_Device device = VK_NULL_HANDLE;
+    CHECK_VK(VkAfterCrash_CreateDevice(&deviceCreateInfo, &device));
+    VkAfterCrash_BufferCreateInfo bufferCreateInfo = { MARKER_COUNT };
+    VkAfterCrash_Buffer buffer = VK_NULL_HANDLE;
+    uint32_t* bufferData = nullptr;
+    CHECK_VK(VkAfterCrash_CreateBuffer(device, &bufferCreateInfo, &buffer, &bufferData));
+
+    // 1. CPU recording cost.
+
+    MicroBenchmark::CONFIG config;
+    config.WarmupSeconds = 0.1;
+    MicroBenchmark::Runner runner(config);
+
+    std::vector<uint32_t> values(MARKER_COUNT);
+    for(uint32_t i = 0; i < MARKER_COUNT; ++i)
+        values[i] = i + 1;
+
+    auto measureCpu = [&](const char* name, auto recordMarkers) -> double
+    {
+        return runner.Run(name, [&]() {
+            BeginCommandBuffer(vk);
+            recordMarkers();
+            vkEndCommandBuffer(vk.CommandBuffer);
+        }).MeanNs;
+    };
+
+    const double emptyNs = measureCpu("Empty", [&]() { });
+    printf("\nCPU cost of recording one marker [ns], %u markers per command buffer:\n", MARKER_COUNT);
+    const double fillNs = measureCpu("vkCmdFillBuffer", [&]() {
+        for(uint32_t i = 0; i < MARKER_COUNT; ++i)
+            VkAfterCrash_CmdWriteMarker(vk.CommandBuffer, buffer, i, i + 1);
+    });
+    printf("%-36s %10.4g\n", "vkCmdFillBuffer", (fillNs - emptyNs) / MARKER_COUNT);
+    for(size_t b = 0; b < BATCH_SIZE_COUNT; ++b)
+    {
+        const uint32_t batchSize = BATCH_SIZES[b];
+        char name[64];
+        snprintf(name, sizeof(name), "vkCmdUpdateBuffer, batch %u", batchSize);
+        const double updateNs = measureCpu(name, [&]() {
+            for(uint32_t i = 0; i < MARKER_COUNT; i += batchSize)
+                VkAfterCrash_CmdWriteMarkerRange(vk.CommandBuffer, buffer, i, batchSize, values.data() + i);
+        });
+        printf("%-36s %10.4g\n", name, (updateNs - emptyNs) / MARKER_COUNT);
+    }
+    if(vk.AmdBufferMarker)
+    {
+        const double amdNs = measureCpu("vkCmdWriteBufferMarkerAMD", [&]() {
+            for(uint32_t i = 0; i < MARKER_COUNT; ++i)
+            {
+                VkAfterCrash_CmdWriteMarkerExtended(vk.CommandBuffer, buffer, i, i + 1,
+                    VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+            }
+        });
+        printf("%-36s %10.4g\n", "vkCmdWriteBufferMarkerAMD", (amdNs - emptyNs) / MARKER_COUNT);
+    }
+
+    // 2. GPU execution cost.
+
+    // Work without markers is the same for all densities.
+    const double noMarkersNs = MeasureGpuNs(vk, buffer, METHOD_NONE, WORK_ITEM_COUNT);
+    double gpuNs[METHOD_COUNT][DENSITY_COUNT] = {};
+    for(uint32_t m = METHOD_NONE + 1; m < METHOD_COUNT; ++m)
+    {
+        if(m == METHOD_AMD_BUFFER_MARKER && !vk.AmdBufferMarker)
+            continue;
+        for(size_t d = 0; d < DENSITY_COUNT; ++d)
+            gpuNs[m][d] = MeasureGpuNs(vk, buffer, (METHOD)m, DENSITIES[d]);
+    }
+
+    printf("\nGPU time of %u simulated draws, %llu B each, without markers: %.4g us\n", WORK_ITEM_COUNT,
+        (unsigned long long)WORK_ITEM_SIZE, noMarkersNs * 1e-3);
+    // Per marker cost is precise only with many markers - for one marker per
+    // pass, it is within noise of the whole measurement.
+    const char* const tableTitles[] = { "GPU time overhead [%]:", "GPU cost of one marker [ns]:" };
+    for(uint32_t table = 0; table < 2; ++table)
+    {
+        printf("\n%s\n%-28s", tableTitles[table], "");
+        for(size_t d = 0; d < DENSITY_COUNT; ++d)
+            printf(" %10s", DENSITY_NAMES[d]);
+        printf("\n");
+        for(uint32_t m = METHOD_NONE + 1; m < METHOD_COUNT; ++m)
+        {
+            if(m == METHOD_AMD_BUFFER_MARKER && !vk.AmdBufferMarker)
+                continue;
+            printf("%-28s", METHOD_NAMES[m]);
+            for(size_t d = 0; d < DENSITY_COUNT; ++d)
+            {
+                const double overheadNs = gpuNs[m][d] - noMarkersNs;
+                if(table == 0)
+                    printf(" %10.3f", overheadNs * 100.0 / noMarkersNs);
+                else
+                    printf(" %10.4g", overheadNs / (WORK_ITEM_COUNT / DENSITIES[d]));
+            }
+            printf("\n");
+        }
+    }
+
+    if(writeCsv)
+    {
+        printf("\n");
+        runner.WriteCsv(stdout);
+    }
+    if(writeJson)
+    {
+        printf("\n");
+        runner.WriteJson(stdout);
+    }
+
+    VkAfterCrash_DestroyBuffer(buffer);
+    VkAfterCrash_DestroyDevice(device);
+    DestroyVulkan(vk);
+    return 0;
+}
@@ -0,0 +1,1174 @@
+/*
+VulkanAfterCrashTest.cpp
+
+Author:  Adam Sawicki, http://asawicki.info, adam__REMOVE__@asawicki.info
+Version: 1.0.0, 2026-10-19
+License: MIT
+
+Test of VulkanAfterCrash.h against a mock Vulkan driver, using vulkan.h from
+this directory instead of Vulkan SDK, so it runs on any platform, without GPU
+or Vulkan driver. Memory of the mock driver is host memory and commands are
+executed immediately when recorded, so their effects can be checked right
+after recording. The driver checks that commands stay inside their buffers.
+Checks that:
+
+- Buffers are allocated from a pool first fit, aligned to 16 markers, and
+  VkAfterCrash_CreateBuffer returns VK_ERROR_OUT_OF_DEVICE_MEMORY when there is
+  no free range large enough.
+- Destroyed buffers are merged with previous, next or both free neighbors, so
+  the whole pool can be allocated again when all buffers are destroyed.
+- Markers written to buffers in a pool land at their offsets and don't touch
+  neighbors.
+- Buffers created and destroyed in one pool from many threads never overlap.
+- Buffer without a pool has its own host visible memory, freed on destroy.
+- Profiler makes regions between consecutive markers of each command buffer,
+  when recorded in parallel, from results collected frameCount frames later.
+- Markers above maxMarkersPerFrame and timestamps not available are skipped.
+- Timestamps are masked to timestampValidBits, also when the counter wraps,
+  and VkAfterCrash_CreateProfiler fails for a queue family without them.
+- Regions not taken are kept in a ring of frameCount * maxMarkersPerFrame,
+  overwriting the oldest.
+- Trace file has the expected events and a failure to write it is reported.
+- File-backed buffer writes the header and markers to the file, which stays
+  after the buffer is destroyed, also when only host allocation handle type
+  can be imported.
+- When the file can't be used, the buffer falls back to normal memory, the
+  previous file is left intact and the temporary one is deleted.
+- Timeline writes consecutive sequence numbers to its marker and finds
+  entries of the last entryCount of them.
+- Timeline markers recorded from many threads take every sequence number
+  once, and entries read meanwhile are never mixed from two markers.
+
+Returns 0 if all checks passed. Creates and deletes files VulkanAfterCrashTest.*
+in the current directory.
+
+Build and run from the main directory, e.g.:
+    g++ -std=c++14 -pthread -IVulkanAfterCrashTest VulkanAfterCrashTest/VulkanAfterCrashTest.cpp && ./a.out
+*/
+#define VULKAN_AFTER_CRASH_IMPLEMENTATION
+#include "../VulkanAfterCrash.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int g_FailedCount = 0;
+
+#define CHECK(expr) do { if(!(expr)) { printf("%s(%d): Check failed: %s\n", __FILE__, __LINE__, #expr); ++g_FailedCount; } } while(false)
+
+////////////////////////////////////////////////////////////////////////////////
+// Mock driver
+
+static const VkPhysicalDevice PHYSICAL_DEVICE = (VkPhysicalDevice)0x1000;
+static const VkDevice DEVICE = (VkDevice)0x2000;
+
+static const VkMemoryPropertyFlags MEMORY_TYPES[] = {
+    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+};
+static const uint32_t MEMORY_TYPE_COUNT = sizeof(MEMORY_TYPES) / sizeof(MEMORY_TYPES[0]);
+// Imported host memory can use only the uncached type.
+static const uint32_t HOST_POINTER_MEMORY_TYPE_BITS = 1u << 1;
+static const VkDeviceSize HOST_POINTER_ALIGNMENT = 4096;
+
+struct VkDeviceMemory_T
+{
+    uint32_t memoryTypeIndex;
+    VkDeviceSize size;
+    char* data;
+    // Memory of the application imported with VK_EXT_external_memory_host,
+    // not freed by the driver.
+    bool imported;
+    bool mapped;
+};
+
+struct VkBuffer_T
+{
+    VkDeviceSize size;
+    VkExternalMemoryHandleTypeFlags externalHandleTypes;
+    VkDeviceMemory memory;
+    VkDeviceSize memoryOffset;
+};
+
+struct VkQueryPool_T
+{
+    std::vector<uint64_t> timestamps;
+    std::vector<bool> written;
+};
+
+// Settings and statistics of the mock driver, reset by each test.
+struct MockDriver
+{
+    // If false, vkGetMemoryHostPointerPropertiesEXT is not available.
+    bool externalMemoryHost = false;
+    bool importForeignMemory = true;
+    bool importHostAllocation = true;
+    // Of queue family 0. Queue family 1 doesn't support timestamps.
+    uint32_t timestampValidBits = 64;
+    float timestampPeriod = 1.f;
+    // Timestamps recorded while false are never available, like when the
+    // command buffer is still executing.
+    bool executeTimestamps = true;
+    uint64_t nextTimestamp = 0;
+    uint64_t timestampStep = 1;
+    // Written to bits of timestamps above timestampValidBits.
+    uint64_t timestampInvalidBits = 0;
+
+    int bufferCount = 0;
+    int memoryCount = 0;
+    int queryPoolCount = 0;
+    uint32_t lastMemoryTypeIndex = UINT32_MAX;
+    VkExternalMemoryHandleTypeFlagBits lastImportHandleType = (VkExternalMemoryHandleTypeFlagBits)0;
+};
+
+static MockDriver g_Mock;
+// Commands can be recorded from many threads.
+static std::mutex g_MockMutex;
+
+static void ResetMock()
+{
+    g_Mock = MockDriver();
+}
+
+// Returns pointer to memory of the buffer at given offset, or null if the range
+// is outside of the buffer.
+static char* GetBufferData(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size)
+{
+    const bool valid = buffer && buffer->memory &&
+        offset % 4 == 0 && size % 4 == 0 && offset + size <= buffer->size;
+    CHECK(valid);
+    return valid ? buffer->memory->data + buffer->memoryOffset + offset : nullptr;
+}
+
+static VkResult MockGetMemoryHostPointerPropertiesEXT(
+    VkDevice device,
+    VkExternalMemoryHandleTypeFlagBits handleType,
+    const void* pHostPointer,
+    VkMemoryHostPointerPropertiesEXT* pMemoryHostPointerProperties)
+{
+    CHECK(device == DEVICE);
+    CHECK((uintptr_t)pHostPointer % HOST_POINTER_ALIGNMENT == 0);
+    const bool supported = handleType == VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_MAPPED_FOREIGN_MEMORY_BIT_EXT ?
+        g_Mock.importForeignMemory : g_Mock.importHostAllocation;
+    if(!supported)
+        return VK_ERROR_INVALID_EXTERNAL_HANDLE;
+    pMemoryHostPointerProperties->memoryTypeBits = HOST_POINTER_MEMORY_TYPE_BITS;
+    return VK_SUCCESS;
+}
+
+PFN_vkVoidFunction vkGetDeviceProcAddr(VkDevice device, const char* pName)
+{
+    CHECK(device == DEVICE);
+    if(g_Mock.externalMemoryHost && strcmp(pName, "vkGetMemoryHostPointerPropertiesEXT") == 0)
+        return (PFN_vkVoidFunction)&MockGetMemoryHostPointerPropertiesEXT;
+    return nullptr;
+}
+
+void vkGetPhysicalDeviceProperties(VkPhysicalDevice physicalDevice, VkPhysicalDeviceProperties* pProperties)
+{
+    CHECK(physicalDevice == PHYSICAL_DEVICE);
+    memset(pProperties, 0, sizeof(*pProperties));
+    pProperties->limits.timestampPeriod = g_Mock.timestampPeriod;
+}
+
+void vkGetPhysicalDeviceProperties2(VkPhysicalDevice physicalDevice, VkPhysicalDeviceProperties2* pProperties)
+{
+    CHECK(pProperties->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2);
+    vkGetPhysicalDeviceProperties(physicalDevice, &pProperties->properties);
+    for(void* next = pProperties->pNext; next; )
+    {
+        VkPhysicalDeviceExternalMemoryHostPropertiesEXT* const hostProps =
+            (VkPhysicalDeviceExternalMemoryHostPropertiesEXT*)next;
+        if(hostProps->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT)
+            hostProps->minImportedHostPointerAlignment = HOST_POINTER_ALIGNMENT;
+        next = hostProps->pNext;
+    }
+}
+
+void vkGetPhysicalDeviceMemoryProperties(VkPhysicalDevice physicalDevice, VkPhysicalDeviceMemoryProperties* pMemoryProperties)
+{
+    CHECK(physicalDevice == PHYSICAL_DEVICE);
+    memset(pMemoryProperties, 0, sizeof(*pMemoryProperties));
+    pMemoryProperties->memoryTypeCount = MEMORY_TYPE_COUNT;
+    for(uint32_t i = 0; i < MEMORY_TYPE_COUNT; ++i)
+        pMemoryProperties->memoryTypes[i].propertyFlags = MEMORY_TYPES[i];
+    pMemoryProperties->memoryHeapCount = 1;
+    pMemoryProperties->memoryHeaps[0].size = 1ull << 30;
+}
+
+void vkGetPhysicalDeviceQueueFamilyProperties(VkPhysicalDevice physicalDevice,
+    uint32_t* pQueueFamilyPropertyCount, VkQueueFamilyProperties* pQueueFamilyProperties)
+{
+    CHECK(physicalDevice == PHYSICAL_DEVICE);
+    const uint32_t queueFamilyCount = 2;
+    if(pQueueFamilyProperties == nullptr)
+    {
+        *pQueueFamilyPropertyCount = queueFamilyCount;
+        return;
+    }
+    if(*pQueueFamilyPropertyCount > queueFamilyCount)
+        *pQueueFamilyPropertyCount = queueFamilyCount;
+    for(uint32_t i = 0; i < *pQueueFamilyPropertyCount; ++i)
+    {
+        memset(&pQueueFamilyProperties[i], 0, sizeof(pQueueFamilyProperties[i]));
+        pQueueFamilyProperties[i].queueCount = 1;
+        pQueueFamilyProperties[i].timestampValidBits = i == 0 ? g_Mock.timestampValidBits : 0;
+    }
+}
+
+VkResult vkCreateBuffer(VkDevice device, const VkBufferCreateInfo* pCreateInfo,
+    const VkAllocationCallbacks*, VkBuffer* pBuffer)
+{
+    CHECK(device == DEVICE);
+    CHECK(pCreateInfo->sType == VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO);
+    CHECK((pCreateInfo->usage & VK_BUFFER_USAGE_TRANSFER_DST_BIT) != 0);
+    const VkExternalMemoryBufferCreateInfo* const externalCreateInfo =
+        (const VkExternalMemoryBufferCreateInfo*)pCreateInfo->pNext;
+    CHECK(externalCreateInfo == nullptr ||
+        externalCreateInfo->sType == VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO);
+    *pBuffer = new VkBuffer_T();
+    (*pBuffer)->size = pCreateInfo->size;
+    (*pBuffer)->externalHandleTypes = externalCreateInfo ? externalCreateInfo->handleTypes : 0;
+    ++g_Mock.bufferCount;
+    return VK_SUCCESS;
+}
+
+void vkDestroyBuffer(VkDevice device, VkBuffer buffer, const VkAllocationCallbacks*)
+{
+    CHECK(device == DEVICE);
+    if(buffer == VK_NULL_HANDLE)
+        return;
+    --g_Mock.bufferCount;
+    delete buffer;
+}
+
+void vkGetBufferMemoryRequirements(VkDevice device, VkBuffer buffer, VkMemoryRequirements* pMemoryRequirements)
+{
+    CHECK(device == DEVICE);
+    pMemoryRequirements->alignment = 256;
+    pMemoryRequirements->size = (buffer->size + 255) / 256 * 256;
+    pMemoryRequirements->memoryTypeBits = (1u << MEMORY_TYPE_COUNT) - 1;
+}
+
+VkResult vkAllocateMemory(VkDevice device, const VkMemoryAllocateInfo* pAllocateInfo,
+    const VkAllocationCallbacks*, VkDeviceMemory* pMemory)
+{
+    CHECK(device == DEVICE);
+    CHECK(pAllocateInfo->sType == VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO);
+    CHECK(pAllocateInfo->memoryTypeIndex < MEMORY_TYPE_COUNT);
+    const VkImportMemoryHostPointerInfoEXT* const importInfo =
+        (const VkImportMemoryHostPointerInfoEXT*)pAllocateInfo->pNext;
+    VkDeviceMemory memory = new VkDeviceMemory_T();
+    memory->memoryTypeIndex = pAllocateInfo->memoryTypeIndex;
+    memory->size = pAllocateInfo->allocationSize;
+    if(importInfo)
+    {
+        CHECK(importInfo->sType == VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT);
+        CHECK(g_Mock.externalMemoryHost);
+        CHECK(((1u << pAllocateInfo->memoryTypeIndex) & HOST_POINTER_MEMORY_TYPE_BITS) != 0);
+        CHECK((uintptr_t)importInfo->pHostPointer % HOST_POINTER_ALIGNMENT == 0);
+        CHECK(pAllocateInfo->allocationSize % HOST_POINTER_ALIGNMENT == 0);
+        memory->data = (char*)importInfo->pHostPointer;
+        memory->imported = true;
+        g_Mock.lastImportHandleType = importInfo->handleType;
+    }
+    else
+        memory->data = new char[(size_t)memory->size]();
+    g_Mock.lastMemoryTypeIndex = pAllocateInfo->memoryTypeIndex;
+    ++g_Mock.memoryCount;
+    *pMemory = memory;
+    return VK_SUCCESS;
+}
+
+void vkFreeMemory(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks*)
+{
+    CHECK(device == DEVICE);
+    if(memory == VK_NULL_HANDLE)
+        return;
+    CHECK(!memory->mapped);
+    if(!memory->imported)
+        delete[] memory->data;
+    --g_Mock.memoryCount;
+    delete memory;
+}
+
+VkResult vkMapMemory(VkDevice device, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize,
+    VkMemoryMapFlags, void** ppData)
+{
+    CHECK(device == DEVICE);
+    CHECK((MEMORY_TYPES[memory->memoryTypeIndex] & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0);
+    CHECK(!memory->mapped);
+    memory->mapped = true;
+    *ppData = memory->data + offset;
+    return VK_SUCCESS;
+}
+
+void vkUnmapMemory(VkDevice device, VkDeviceMemory memory)
+{
+    CHECK(device == DEVICE);
+    CHECK(memory->mapped);
+    memory->mapped = false;
+}
+
+VkResult vkBindBufferMemory(VkDevice device, VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize memoryOffset)
+{
+    CHECK(device == DEVICE);
+    CHECK(buffer->memory == VK_NULL_HANDLE);
+    CHECK(memoryOffset + buffer->size <= memory->size);
+    buffer->memory = memory;
+    buffer->memoryOffset = memoryOffset;
+    return VK_SUCCESS;
+}
+
+void vkCmdFillBuffer(VkCommandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset,
+    VkDeviceSize size, uint32_t data)
+{
+    std::lock_guard<std::mutex> lock(g_MockMutex);
+    uint32_t* const dst = (uint32_t*)GetBufferData(dstBuffer, dstOffset, size);
+    if(dst)
+    {
+        for(VkDeviceSize i = 0; i < size / 4; ++i)
+            dst[i] = data;
+    }
+}
+
+void vkCmdUpdateBuffer(VkCommandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset,
+    VkDeviceSize dataSize, const void* pData)
+{
+    std::lock_guard<std::mutex> lock(g_MockMutex);
+    CHECK(dataSize > 0 && dataSize <= 65536);
+    char* const dst = GetBufferData(dstBuffer, dstOffset, dataSize);
+    if(dst)
+        memcpy(dst, pData, (size_t)dataSize);
+}
+
+VkResult vkCreateQueryPool(VkDevice device, const VkQueryPoolCreateInfo* pCreateInfo,
+    const VkAllocationCallbacks*, VkQueryPool* pQueryPool)
+{
+    CHECK(device == DEVICE);
+    CHECK(pCreateInfo->sType == VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO);
+    CHECK(pCreateInfo->queryType == VK_QUERY_TYPE_TIMESTAMP);
+    *pQueryPool = new VkQueryPool_T();
+    (*pQueryPool)->timestamps.resize(pCreateInfo->queryCount);
+    (*pQueryPool)->written.resize(pCreateInfo->queryCount);
+    ++g_Mock.queryPoolCount;
+    return VK_SUCCESS;
+}
+
+void vkDestroyQueryPool(VkDevice device, VkQueryPool queryPool, const VkAllocationCallbacks*)
+{
+    CHECK(device == DEVICE);
+    if(queryPool == VK_NULL_HANDLE)
+        return;
+    --g_Mock.queryPoolCount;
+    delete queryPool;
+}
+
+void vkCmdResetQueryPool(VkCommandBuffer, VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount)
+{
+    std::lock_guard<std::mutex> lock(g_MockMutex);
+    CHECK(firstQuery + queryCount <= queryPool->written.size());
+    for(uint32_t i = 0; i < queryCount && firstQuery + i < queryPool->written.size(); ++i)
+        queryPool->written[firstQuery + i] = false;
+}
+
+void vkCmdWriteTimestamp(VkCommandBuffer, VkPipelineStageFlagBits, VkQueryPool queryPool, uint32_t query)
+{
+    std::lock_guard<std::mutex> lock(g_MockMutex);
+    CHECK(query < queryPool->written.size());
+    if(query >= queryPool->written.size() || !g_Mock.executeTimestamps)
+        return;
+    CHECK(!queryPool->written[query]);
+    const uint64_t validMask = g_Mock.timestampValidBits < 64 ?
+        (1ull << g_Mock.timestampValidBits) - 1 : UINT64_MAX;
+    queryPool->timestamps[query] = (g_Mock.nextTimestamp & validMask) | (g_Mock.timestampInvalidBits & ~validMask);
+    queryPool->written[query] = true;
+    g_Mock.nextTimestamp += g_Mock.timestampStep;
+}
+
+VkResult vkGetQueryPoolResults(VkDevice device, VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount,
+    size_t dataSize, void* pData, VkDeviceSize stride, VkQueryResultFlags flags)
+{
+    std::lock_guard<std::mutex> lock(g_MockMutex);
+    CHECK(device == DEVICE);
+    // Waiting would hang forever on timestamps that are never available.
+    CHECK(flags == (VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT));
+    CHECK(stride == 2 * sizeof(uint64_t));
+    CHECK(dataSize >= queryCount * stride);
+    CHECK(firstQuery + queryCount <= queryPool->written.size());
+    VkResult res = VK_SUCCESS;
+    for(uint32_t i = 0; i < queryCount; ++i)
+    {
+        uint64_t* const result = (uint64_t*)((char*)pData + i * stride);
+        const uint32_t query = firstQuery + i;
+        if(queryPool->written[query])
+        {
+            result[0] = queryPool->timestamps[query];
+            result[1] = 1;
+        }
+        else
+        {
+            // Timestamp is not written if not available.
+            result[1] = 0;
+            res = VK_NOT_READY;
+        }
+    }
+    return res;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Tests
+
+static const VkCommandBuffer COMMAND_BUFFER = (VkCommandBuffer)0x100;
+
+static VkAfterCrash_Device CreateDevice(uint32_t flags)
+{
+    VkAfterCrash_DeviceCreateInfo createInfo = {};
+    createInfo.flags = flags;
+    createInfo.vkPhysicalDevice = PHYSICAL_DEVICE;
+    createInfo.vkDevice = DEVICE;
+    VkAfterCrash_Device device = nullptr;
+    CHECK(VkAfterCrash_CreateDevice(&createInfo, &device) == VK_SUCCESS);
+    return device;
+}
+
+static VkResult CreatePoolBuffer(
+    VkAfterCrash_Device device,
+    VkAfterCrash_Pool pool,
+    uint32_t markerCount,
+    VkAfterCrash_Buffer* pBuffer,
+    uint32_t** pData)
+{
+    VkAfterCrash_BufferCreateInfo createInfo = {};
+    createInfo.markerCount = markerCount;
+    createInfo.pool = pool;
+    return VkAfterCrash_CreateBuffer(device, &createInfo, pBuffer, pData);
+}
+
+static void TestPoolAllocation()
+{
+    ResetMock();
+    VkAfterCrash_Device device = CreateDevice(0);
+    // Rounded up to 1008 markers.
+    VkAfterCrash_PoolCreateInfo poolCreateInfo = { 1000 };
+    VkAfterCrash_Pool pool = nullptr;
+    CHECK(VkAfterCrash_CreatePool(device, &poolCreateInfo, &pool) == VK_SUCCESS);
+    CHECK(g_Mock.bufferCount == 1 && g_Mock.memoryCount == 1);
+
+    // Each takes 112 markers: 100 aligned to 16.
+    VkAfterCrash_Buffer buffers[8] = {};
+    uint32_t* data[8] = {};
+    for(uint32_t i = 0; i < 8; ++i)
+    {
+        CHECK(CreatePoolBuffer(device, pool, 100, &buffers[i], &data[i]) == VK_SUCCESS);
+        CHECK(data[i] == data[0] + i * 112);
+    }
+    // Buffers in a pool have no memory of their own.
+    CHECK(g_Mock.bufferCount == 1 && g_Mock.memoryCount == 1);
+
+    // [896, 1008) is left.
+    VkAfterCrash_Buffer buffer = nullptr;
+    uint32_t* bufferData = nullptr;
+    CHECK(CreatePoolBuffer(device, pool, 113, &buffer, &bufferData) == VK_ERROR_OUT_OF_DEVICE_MEMORY);
+    CHECK(buffer == nullptr && bufferData == nullptr);
+    CHECK(CreatePoolBuffer(device, pool, 112, &buffer, &bufferData) == VK_SUCCESS);
+    CHECK(bufferData == data[0] + 896);
+    VkAfterCrash_DestroyBuffer(buffer);
+
+    // [448, 560) merged with previous [336, 448).
+    VkAfterCrash_DestroyBuffer(buffers[3]);
+    VkAfterCrash_DestroyBuffer(buffers[4]);
+    VkAfterCrash_Buffer mergedPrevBuffer = nullptr;
+    uint32_t* mergedPrevData = nullptr;
+    CHECK(CreatePoolBuffer(device, pool, 200, &mergedPrevBuffer, &mergedPrevData) == VK_SUCCESS);
+    CHECK(mergedPrevData == data[3]);
+
+    // [560, 672) merged with both [544, 560) left after the previous buffer and
+    // [672, 784).
+    VkAfterCrash_DestroyBuffer(buffers[6]);
+    VkAfterCrash_DestroyBuffer(buffers[5]);
+    VkAfterCrash_Buffer mergedBothBuffer = nullptr;
+    uint32_t* mergedBothData = nullptr;
+    CHECK(CreatePoolBuffer(device, pool, 240, &mergedBothBuffer, &mergedBothData) == VK_SUCCESS);
+    CHECK(mergedBothData == data[0] + 544);
+
+    // [0, 112) merged with next [112, 224).
+    VkAfterCrash_DestroyBuffer(buffers[1]);
+    VkAfterCrash_DestroyBuffer(buffers[0]);
+    VkAfterCrash_Buffer mergedNextBuffer = nullptr;
+    uint32_t* mergedNextData = nullptr;
+    CHECK(CreatePoolBuffer(device, pool, 224, &mergedNextBuffer, &mergedNextData) == VK_SUCCESS);
+    CHECK(mergedNextData == data[0]);
+
+    // Nothing left but [896, 1008).
+    CHECK(CreatePoolBuffer(device, pool, 113, &buffer, &bufferData) == VK_ERROR_OUT_OF_DEVICE_MEMORY);
+
+    VkAfterCrash_DestroyBuffer(mergedNextBuffer);
+    VkAfterCrash_DestroyBuffer(buffers[7]);
+    VkAfterCrash_DestroyBuffer(mergedBothBuffer);
+    VkAfterCrash_DestroyBuffer(buffers[2]);
+    VkAfterCrash_DestroyBuffer(mergedPrevBuffer);
+
+    // All merged into one range again.
+    CHECK(CreatePoolBuffer(device, pool, 1009, &buffer, &bufferData) == VK_ERROR_OUT_OF_DEVICE_MEMORY);
+    CHECK(CreatePoolBuffer(device, pool, 1008, &buffer, &bufferData) == VK_SUCCESS);
+    CHECK(bufferData == data[0]);
+    VkAfterCrash_DestroyBuffer(buffer);
+
+    VkAfterCrash_DestroyPool(pool);
+    VkAfterCrash_DestroyDevice(device);
+    CHECK(g_Mock.bufferCount == 0 && g_Mock.memoryCount == 0);
+}
+
+static void TestPoolMarkers()
+{
+    ResetMock();
+    VkAfterCrash_Device device = CreateDevice(0);
+    VkAfterCrash_PoolCreateInfo poolCreateInfo = { 3 * 48 };
+    VkAfterCrash_Pool pool = nullptr;
+    CHECK(VkAfterCrash_CreatePool(device, &poolCreateInfo, &pool) == VK_SUCCESS);
+
+    // Each takes 48 markers, the last 8 are not used.
+    const uint32_t markerCount = 40;
+    VkAfterCrash_Buffer buffers[3] = {};
+    uint32_t* data[3] = {};
+    for(uint32_t i = 0; i < 3; ++i)
+        CHECK(CreatePoolBuffer(device, pool, markerCount, &buffers[i], &data[i]) == VK_SUCCESS);
+
+    for(uint32_t i = 0; i < markerCount; ++i)
+        VkAfterCrash_CmdWriteMarker(COMMAND_BUFFER, buffers[0], i, 0x100 + i);
+    std::vector<uint32_t> values(markerCount);
+    for(uint32_t i = 0; i < markerCount; ++i)
+        values[i] = 0x200 + i;
+    VkAfterCrash_CmdWriteMarkerRange(COMMAND_BUFFER, buffers[1], 0, markerCount, values.data());
+    // A run of all but the last marker, then the last one alone.
+    std::vector<VkAfterCrash_Marker> markers(markerCount);
+    for(uint32_t i = 0; i < markerCount; ++i)
+    {
+        markers[i].markerIndex = i < markerCount - 1 ? i + 1 : 0;
+        markers[i].value = 0x300 + markers[i].markerIndex;
+    }
+    VkAfterCrash_CmdWriteMarkers(COMMAND_BUFFER, buffers[2], markerCount, markers.data());
+
+    for(uint32_t i = 0; i < 3; ++i)
+    {
+        CHECK(data[i] == data[0] + i * 48);
+        for(uint32_t j = 0; j < markerCount; ++j)
+            CHECK(data[i][j] == 0x100 * (i + 1) + j);
+        for(uint32_t j = markerCount; j < 48; ++j)
+            CHECK(data[i][j] == 0);
+    }
+
+    for(uint32_t i = 0; i < 3; ++i)
+        VkAfterCrash_DestroyBuffer(buffers[i]);
+    VkAfterCrash_DestroyPool(pool);
+    VkAfterCrash_DestroyDevice(device);
+}
+
+static void TestPoolThreads()
+{
+    ResetMock();
+    VkAfterCrash_Device device = CreateDevice(0);
+    // Buffers of other threads split free space into at most threadCount
+    // ranges, so with this size one of them is always large enough.
+    const uint32_t threadCount = 4;
+    const uint32_t maxMarkerCount = 64;
+    const uint32_t poolMarkerCount = (2 * threadCount - 1) * maxMarkerCount;
+    VkAfterCrash_PoolCreateInfo poolCreateInfo = { poolMarkerCount };
+    VkAfterCrash_Pool pool = nullptr;
+    CHECK(VkAfterCrash_CreatePool(device, &poolCreateInfo, &pool) == VK_SUCCESS);
+
+    // Every thread fills its buffer with its own values and checks they are
+    // not overwritten by other threads before destroying it.
+    std::atomic<uint32_t> failedCount(0);
+    std::vector<std::thread> threads;
+    for(uint32_t threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+    {
+        threads.emplace_back([&, threadIndex]() {
+            uint32_t random = threadIndex + 1;
+            for(uint32_t iteration = 0; iteration < 2000; ++iteration)
+            {
+                random = random * 1664525 + 1013904223;
+                const uint32_t markerCount = 1 + (random >> 16) % maxMarkerCount;
+                VkAfterCrash_Buffer buffer = nullptr;
+                uint32_t* data = nullptr;
+                if(CreatePoolBuffer(device, pool, markerCount, &buffer, &data) != VK_SUCCESS)
+                {
+                    ++failedCount;
+                    continue;
+                }
+                const uint32_t value = (threadIndex << 24) | iteration;
+                for(uint32_t i = 0; i < markerCount; ++i)
+                    data[i] = value;
+                std::this_thread::yield();
+                for(uint32_t i = 0; i < markerCount; ++i)
+                {
+                    if(data[i] != value)
+                        ++failedCount;
+                }
+                VkAfterCrash_DestroyBuffer(buffer);
+            }
+        });
+    }
+    for(size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+    CHECK(failedCount == 0);
+
+    VkAfterCrash_Buffer buffer = nullptr;
+    uint32_t* data = nullptr;
+    CHECK(CreatePoolBuffer(device, pool, poolMarkerCount, &buffer, &data) == VK_SUCCESS);
+    VkAfterCrash_DestroyBuffer(buffer);
+    VkAfterCrash_DestroyPool(pool);
+    VkAfterCrash_DestroyDevice(device);
+}
+
+static void TestBufferWithoutPool()
+{
+    ResetMock();
+    VkAfterCrash_Device device = CreateDevice(0);
+    VkAfterCrash_BufferCreateInfo createInfo = { 50 };
+    VkAfterCrash_Buffer buffer = nullptr;
+    uint32_t* data = nullptr;
+    CHECK(VkAfterCrash_CreateBuffer(device, &createInfo, &buffer, &data) == VK_SUCCESS);
+    CHECK(g_Mock.bufferCount == 1 && g_Mock.memoryCount == 1);
+    // Host cached is preferred, for faster reading after crash.
+    CHECK(g_Mock.lastMemoryTypeIndex == 2);
+    CHECK(VkAfterCrash_IsBufferFileBacked(buffer) == VK_FALSE);
+
+    VkAfterCrash_CmdWriteMarker(COMMAND_BUFFER, buffer, 0, 1);
+    VkAfterCrash_CmdWriteMarker(COMMAND_BUFFER, buffer, 49, 2);
+    CHECK(data[0] == 1 && data[49] == 2);
+
+    VkAfterCrash_DestroyBuffer(buffer);
+    CHECK(g_Mock.bufferCount == 0 && g_Mock.memoryCount == 0);
+    VkAfterCrash_DestroyDevice(device);
+}
+
+static VkResult CreateProfiler(
+    VkAfterCrash_Device device,
+    uint32_t frameCount,
+    uint32_t maxMarkersPerFrame,
+    uint32_t queueFamilyIndex,
+    VkAfterCrash_Profiler* pProfiler)
+{
+    VkAfterCrash_ProfilerCreateInfo createInfo = { frameCount, maxMarkersPerFrame, queueFamilyIndex };
+    return VkAfterCrash_CreateProfiler(device, &createInfo, pProfiler);
+}
+
+static VkAfterCrash_Buffer CreateProfiledBuffer(VkAfterCrash_Device device, VkAfterCrash_Profiler profiler)
+{
+    VkAfterCrash_BufferCreateInfo createInfo = {};
+    createInfo.markerCount = 16;
+    createInfo.profiler = profiler;
+    VkAfterCrash_Buffer buffer = nullptr;
+    uint32_t* data = nullptr;
+    CHECK(VkAfterCrash_CreateBuffer(device, &createInfo, &buffer, &data) == VK_SUCCESS);
+    return buffer;
+}
+
+static bool IsRegionEqual(
+    const VkAfterCrash_ProfilerRegion& region,
+    uint64_t frameIndex,
+    VkCommandBuffer vkCommandBuffer,
+    uint32_t value,
+    uint64_t beginNs,
+    uint64_t durationNs)
+{
+    return region.frameIndex == frameIndex &&
+        region.vkCommandBuffer == vkCommandBuffer &&
+        region.value == value &&
+        region.beginNs == beginNs &&
+        region.durationNs == durationNs;
+}
+
+static void TestProfilerRegions()
+{
+    ResetMock();
+    g_Mock.timestampPeriod = 2.f;
+    g_Mock.nextTimestamp = 1000;
+    g_Mock.timestampStep = 100;
+    VkAfterCrash_Device device = CreateDevice(0);
+    VkAfterCrash_Profiler profiler = nullptr;
+    CHECK(CreateProfiler(device, 2, 8, 0, &profiler) == VK_SUCCESS);
+    CHECK(g_Mock.queryPoolCount == 2);
+    VkAfterCrash_Buffer buffer = CreateProfiledBuffer(device, profiler);
+
+    // Recorded in parallel, so queries of the command buffers are interleaved.
+    const VkCommandBuffer commandBufferA = (VkCommandBuffer)0x100;
+    const VkCommandBuffer commandBufferB = (VkCommandBuffer)0x200;
+    VkAfterCrash_CmdBeginProfilerFrame(COMMAND_BUFFER, profiler);
+    VkAfterCrash_CmdWriteMarker(commandBufferA, buffer, 0, 10); // 1000
+    VkAfterCrash_CmdWriteMarker(commandBufferB, buffer, 1, 20); // 1100
+    VkAfterCrash_CmdWriteMarker(commandBufferA, buffer, 0, 11); // 1200
+    VkAfterCrash_CmdWriteMarker(commandBufferB, buffer, 1, 21); // 1300
+    VkAfterCrash_CmdWriteMarker(commandBufferA, buffer, 0, 12); // 1400
+
+    // Collected when its query pool is reused, frameCount frames later.
+    VkAfterCrash_ProfilerRegion regions[8] = {};
+    VkAfterCrash_CmdBeginProfilerFrame(COMMAND_BUFFER, profiler);
+    CHECK(VkAfterCrash_GetProfilerRegions(profiler, 8, regions) == 0);
+    VkAfterCrash_CmdBeginProfilerFrame(COMMAND_BUFFER, profiler);
+    CHECK(VkAfterCrash_GetProfilerRegions(profiler, 8, regions) == 3);
+    CHECK(IsRegionEqual(regions[0], 0, commandBufferA, 10, 2000, 400));
+    CHECK(IsRegionEqual(regions[1], 0, commandBufferA, 11, 2400, 400));
+    CHECK(IsRegionEqual(regions[2], 0, commandBufferB, 20, 2200, 400));
+    // Already taken.
+    CHECK(VkAfterCrash_GetProfilerRegions(profiler, 8, regions) == 0);
+
+    VkAfterCrash_DestroyBuffer(buffer);
+    VkAfterCrash_DestroyProfiler(profiler);
+    CHECK(g_Mock.queryPoolCount == 0);
+    VkAfterCrash_DestroyDevice(device);
+}
+
+static void TestProfilerLostTimestamps()
+{
+    ResetMock();
+    VkAfterCrash_Device device = CreateDevice(0);
+    VkAfterCrash_Profiler profiler = nullptr;
+    CHECK(CreateProfiler(device, 1, 4, 0, &profiler) == VK_SUCCESS);
+    VkAfterCrash_Buffer buffer = CreateProfiledBuffer(device, profiler);
+    VkAfterCrash_ProfilerRegion regions[8] = {};
+
+    // Markers above maxMarkersPerFrame don't write timestamps.
+    VkAfterCrash_CmdBeginProfilerFrame(COMMAND_BUFFER, profiler);
+    for(uint32_t i = 0; i < 6; ++i)
+        VkAfterCrash_CmdWriteMarker(COMMAND_BUFFER, buffer, 0, i);
+    VkAfterCrash_CmdBeginProfilerFrame(COMMAND_BUFFER, profiler);
+    CHECK(VkAfterCrash_GetProfilerRegions(profiler, 8, regions) == 3);
+    for(uint32_t i = 0; i < 3; ++i)
+        CHECK(regions[i].value == i && regions[i].durationNs == 1);
+
+    // Regions beginning or ending with a timestamp not available are lost.
+    VkAfterCrash_CmdWriteMarker(COMMAND_BUFFER, buffer, 0, 10);
+    g_Mock.executeTimestamps = false;
+    VkAfterCrash_CmdWriteMarker(COMMAND_BUFFER, buffer, 0, 11);
+    g_Mock.executeTimestamps = true;
+    VkAfterCrash_CmdWriteMarker(COMMAND_BUFFER, buffer, 0, 12);
+    VkAfterCrash_CmdWriteMarker(COMMAND_BUFFER, buffer, 0, 13);
+    VkAfterCrash_CmdBeginProfilerFrame(COMMAND_BUFFER, profiler);
+    CHECK(VkAfterCrash_GetProfilerRegions(profiler, 8, regions) == 1);
+    CHECK(regions[0].frameIndex == 1 && regions[0].value == 12);
+
+    VkAfterCrash_DestroyBuffer(buffer);
+    VkAfterCrash_DestroyProfiler(profiler);
+    VkAfterCrash_DestroyDevice(device);
+}
+
+static void TestProfilerTimestampValidBits()
+{
+    ResetMock();
+    g_Mock.timestampValidBits = 12;
+    g_Mock.timestampInvalidBits = 0xDEADBEEFDEADBEEFull;
+    g_Mock.nextTimestamp = 4000;
+    g_Mock.timestampStep = 50;
+    VkAfterCrash_Device device = CreateDevice(0);
+    VkAfterCrash_Profiler profiler = nullptr;
+    CHECK(CreateProfiler(device, 1, 8, 0, &profiler) == VK_SUCCESS);
+    VkAfterCrash_Buffer buffer = CreateProfiledBuffer(device, profiler);
+
+    // Timestamps 4000, 4050, then wrapped around 4096 to 4 and 54.
+    VkAfterCrash_CmdBeginProfilerFrame(COMMAND_BUFFER, profiler);
+    for(uint32_t i = 0; i < 4; ++i)
+        VkAfterCrash_CmdWriteMarker(COMMAND_BUFFER, buffer, 0, i);
+    VkAfterCrash_CmdBeginProfilerFrame(COMMAND_BUFFER, profiler);
+    VkAfterCrash_ProfilerRegion regions[8] = {};
+    CHECK(VkAfterCrash_GetProfilerRegions(profiler, 8, regions) == 3);
+    CHECK(IsRegionEqual(regions[0], 0, COMMAND_BUFFER, 0, 4000, 50));
+    CHECK(IsRegionEqual(regions[1], 0, COMMAND_BUFFER, 1, 4050, 50));
+    CHECK(IsRegionEqual(regions[2], 0, COMMAND_BUFFER, 2, 4, 50));
+
+    VkAfterCrash_DestroyBuffer(buffer);
+    VkAfterCrash_DestroyProfiler(profiler);
+
+    // Queue family 1 has timestampValidBits = 0.
+    CHECK(CreateProfiler(device, 1, 8, 1, &profiler) == VK_ERROR_FEATURE_NOT_PRESENT);
+    CHECK(profiler == nullptr);
+    CHECK(g_Mock.queryPoolCount == 0);
+    VkAfterCrash_DestroyDevice(device);
+}
+
+static void TestProfilerRegionRing()
+{
+    ResetMock();
+    VkAfterCrash_Device device = CreateDevice(0);
+    VkAfterCrash_Profiler profiler = nullptr;
+    // Space for 2 * 4 regions.
+    CHECK(CreateProfiler(device, 2, 4, 0, &profiler) == VK_SUCCESS);
+    VkAfterCrash_Buffer buffer = CreateProfiledBuffer(device, profiler);
+
+    // 3 regions per frame, never taken. Frames up to 997 are collected.
+    for(uint32_t frameIndex = 0; frameIndex < 1000; ++frameIndex)
+    {
+        VkAfterCrash_CmdBeginProfilerFrame(COMMAND_BUFFER, profiler);
+        for(uint32_t i = 0; i < 4; ++i)
+            VkAfterCrash_CmdWriteMarker(COMMAND_BUFFER, buffer, 0, frameIndex * 4 + i);
+    }
+
+    // Only the newest are kept, oldest first: 2 of frame 995, 3 of 996 and 997.
+    VkAfterCrash_ProfilerRegion regions[16] = {};
+    CHECK(VkAfterCrash_GetProfilerRegions(profiler, 3, regions) == 3);
+    CHECK(VkAfterCrash_GetProfilerRegions(profiler, 16, regions + 3) == 5);
+    CHECK(VkAfterCrash_GetProfilerRegions(profiler, 16, regions) == 0);
+    const uint64_t expectedFrameIndices[] = { 995, 995, 996, 996, 996, 997, 997, 997 };
+    const uint32_t expectedMarkerIndices[] = { 1, 2, 0, 1, 2, 0, 1, 2 };
+    for(uint32_t i = 0; i < 8; ++i)
+    {
+        CHECK(regions[i].frameIndex == expectedFrameIndices[i]);
+        CHECK(regions[i].value == expectedFrameIndices[i] * 4 + expectedMarkerIndices[i]);
+    }
+
+    VkAfterCrash_DestroyBuffer(buffer);
+    VkAfterCrash_DestroyProfiler(profiler);
+    VkAfterCrash_DestroyDevice(device);
+}
+
+// Returns empty string if the file doesn't exist.
+static std::string ReadFile(const char* filePath)
+{
+    std::string content;
+    FILE* file = fopen(filePath, "rb");
+    if(file)
+    {
+        char buf[4096];
+        size_t readSize;
+        while((readSize = fread(buf, 1, sizeof(buf), file)) > 0)
+            content.append(buf, readSize);
+        fclose(file);
+    }
+    return content;
+}
+
+static void TestProfilerTrace()
+{
+    VkAfterCrash_ProfilerRegion regions[2] = {};
+    regions[0].vkCommandBuffer = (VkCommandBuffer)0x100;
+    regions[0].value = 0xA;
+    regions[0].beginNs = 2000;
+    regions[0].durationNs = 400;
+    regions[1].frameIndex = 7;
+    regions[1].vkCommandBuffer = (VkCommandBuffer)0x200;
+    regions[1].value = 0xB;
+    regions[1].beginNs = 2200;
+    regions[1].durationNs = 1500;
+
+    const char* const filePath = "VulkanAfterCrashTest.json";
+    CHECK(VkAfterCrash_WriteProfilerTrace(filePath, 2, regions) == VK_SUCCESS);
+    const std::string trace = ReadFile(filePath);
+    remove(filePath);
+    CHECK(trace.find("{\"traceEvents\": [") == 0);
+    CHECK(trace.find("{\"name\": \"0x0000000A\", \"ph\": \"X\", \"pid\": 0, \"tid\": 0, "
+        "\"ts\": 2.000, \"dur\": 0.400, \"args\": {\"frame\": 0}}") != std::string::npos);
+    CHECK(trace.find("{\"name\": \"0x0000000B\", \"ph\": \"X\", \"pid\": 0, \"tid\": 1, "
+        "\"ts\": 2.200, \"dur\": 1.500, \"args\": {\"frame\": 7}}") != std::string::npos);
+    CHECK(trace.find("\n]}\n") == trace.size() - 4);
+
+    CHECK(VkAfterCrash_WriteProfilerTrace("NonexistentDirectory/VulkanAfterCrashTest.json", 2, regions) ==
+        VK_ERROR_INITIALIZATION_FAILED);
+}
+
+static const char* const FILE_PATH = "VulkanAfterCrashTest.bin";
+static const char* const TEMP_FILE_PATH = "VulkanAfterCrashTest.bin.tmp";
+
+static bool FileExists(const char* filePath)
+{
+    FILE* file = fopen(filePath, "rb");
+    if(file == nullptr)
+        return false;
+    fclose(file);
+    return true;
+}
+
+static void WriteFile(const char* filePath, const std::string& content)
+{
+    FILE* file = fopen(filePath, "wb");
+    CHECK(file != nullptr);
+    if(file)
+    {
+        fwrite(content.data(), 1, content.size(), file);
+        fclose(file);
+    }
+}
+
+static VkResult CreateFileBackedBuffer(
+    VkAfterCrash_Device device,
+    uint32_t markerCount,
+    VkAfterCrash_Buffer* pBuffer,
+    uint32_t** pData)
+{
+    VkAfterCrash_BufferCreateInfo createInfo = {};
+    createInfo.markerCount = markerCount;
+    createInfo.filePath = FILE_PATH;
+    return VkAfterCrash_CreateBuffer(device, &createInfo, pBuffer, pData);
+}
+
+static void TestFileBackedBuffer()
+{
+    ResetMock();
+    g_Mock.externalMemoryHost = true;
+    VkAfterCrash_Device device = CreateDevice(VK_AFTER_CRASH_DEVICE_CREATE_USE_EXT_EXTERNAL_MEMORY_HOST_BIT);
+    remove(FILE_PATH);
+    remove(TEMP_FILE_PATH);
+
+    VkAfterCrash_Buffer buffer = nullptr;
+    uint32_t* data = nullptr;
+    CHECK(CreateFileBackedBuffer(device, 100, &buffer, &data) == VK_SUCCESS);
+    CHECK(VkAfterCrash_IsBufferFileBacked(buffer) == VK_TRUE);
+    CHECK(g_Mock.lastImportHandleType == VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_MAPPED_FOREIGN_MEMORY_BIT_EXT);
+    CHECK(!FileExists(TEMP_FILE_PATH));
+
+    VkAfterCrash_CmdWriteMarker(COMMAND_BUFFER, buffer, 0, 0x12345678);
+    VkAfterCrash_CmdWriteMarker(COMMAND_BUFFER, buffer, 99, 0x9ABCDEF0);
+    CHECK(data[0] == 0x12345678 && data[99] == 0x9ABCDEF0);
+
+    // Markers are in the file while the buffer is alive, and after it is destroyed.
+    for(uint32_t i = 0; i < 2; ++i)
+    {
+        if(i == 1)
+        {
+            VkAfterCrash_DestroyBuffer(buffer);
+            CHECK(g_Mock.bufferCount == 0 && g_Mock.memoryCount == 0);
+        }
+        const std::string content = ReadFile(FILE_PATH);
+        CHECK(content.size() >= 64 + 100 * sizeof(uint32_t));
+        if(content.size() < 64 + 100 * sizeof(uint32_t))
+            continue;
+        VkAfterCrash_FileHeader header = {};
+        memcpy(&header, content.data(), sizeof(header));
+        CHECK(memcmp(header.magic, VK_AFTER_CRASH_FILE_MAGIC, sizeof(header.magic)) == 0);
+        CHECK(header.version == VK_AFTER_CRASH_FILE_VERSION);
+        CHECK(header.headerSize == 64);
+        CHECK(header.markerCount == 100);
+        CHECK(header.creationTime > 0);
+        uint32_t markers[100] = {};
+        memcpy(markers, content.data() + header.headerSize, sizeof(markers));
+        CHECK(markers[0] == 0x12345678 && markers[1] == 0 && markers[99] == 0x9ABCDEF0);
+    }
+
+    // Driver that imports only host allocations, not mapped files.
+    g_Mock.importForeignMemory = false;
+    CHECK(CreateFileBackedBuffer(device, 100, &buffer, &data) == VK_SUCCESS);
+    CHECK(VkAfterCrash_IsBufferFileBacked(buffer) == VK_TRUE);
+    CHECK(g_Mock.lastImportHandleType == VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT);
+    // Replaced the previous file, so markers start from zero.
+    CHECK(data[0] == 0 && data[99] == 0);
+    VkAfterCrash_DestroyBuffer(buffer);
+
+    remove(FILE_PATH);
+    VkAfterCrash_DestroyDevice(device);
+}
+
+static void TestFileBackedBufferFallback()
+{
+    // File left by previous crash, which must stay intact.
+    const std::string previousContent(256, 'P');
+    const uint32_t deviceFlags[] = {
+        // Extension not enabled.
+        0,
+        // Extension enabled, but the function is not available.
+        VK_AFTER_CRASH_DEVICE_CREATE_USE_EXT_EXTERNAL_MEMORY_HOST_BIT,
+        // No handle type can import the mapped file.
+        VK_AFTER_CRASH_DEVICE_CREATE_USE_EXT_EXTERNAL_MEMORY_HOST_BIT,
+    };
+    for(uint32_t i = 0; i < 3; ++i)
+    {
+        ResetMock();
+        g_Mock.externalMemoryHost = i == 2;
+        g_Mock.importForeignMemory = false;
+        g_Mock.importHostAllocation = false;
+        VkAfterCrash_Device device = CreateDevice(deviceFlags[i]);
+        WriteFile(FILE_PATH, previousContent);
+        remove(TEMP_FILE_PATH);
+
+        VkAfterCrash_Buffer buffer = nullptr;
+        uint32_t* data = nullptr;
+        CHECK(CreateFileBackedBuffer(device, 100, &buffer, &data) == VK_SUCCESS);
+        CHECK(VkAfterCrash_IsBufferFileBacked(buffer) == VK_FALSE);
+        CHECK(g_Mock.bufferCount == 1 && g_Mock.memoryCount == 1);
+        CHECK(ReadFile(FILE_PATH) == previousContent);
+        CHECK(!FileExists(TEMP_FILE_PATH));
+
+        // Works like a buffer without file.
+        VkAfterCrash_CmdWriteMarker(COMMAND_BUFFER, buffer, 99, 1);
+        CHECK(data[99] == 1);
+        VkAfterCrash_DestroyBuffer(buffer);
+        CHECK(g_Mock.bufferCount == 0 && g_Mock.memoryCount == 0);
+        CHECK(ReadFile(FILE_PATH) == previousContent);
+        VkAfterCrash_DestroyDevice(device);
+    }
+    remove(FILE_PATH);
+}
+
+static const char* const LABELS[] = { "Shadows", "GBuffer", "Lighting", "Post-process" };
+
+static void TestTimeline()
+{
+    ResetMock();
+    VkAfterCrash_Device device = CreateDevice(0);
+    VkAfterCrash_BufferCreateInfo bufferCreateInfo = { 4 };
+    VkAfterCrash_Buffer buffer = nullptr;
+    uint32_t* data = nullptr;
+    CHECK(VkAfterCrash_CreateBuffer(device, &bufferCreateInfo, &buffer, &data) == VK_SUCCESS);
+    VkAfterCrash_TimelineCreateInfo timelineCreateInfo = { buffer, 2, 4 };
+    VkAfterCrash_Timeline timeline = nullptr;
+    CHECK(VkAfterCrash_CreateTimeline(device, &timelineCreateInfo, &timeline) == VK_SUCCESS);
+
+    VkAfterCrash_TimelineEntry entry = {};
+    CHECK(VkAfterCrash_GetTimelineSequence(timeline) == 0);
+    CHECK(VkAfterCrash_GetTimelineEntry(timeline, 0, &entry) == VK_FALSE);
+    CHECK(VkAfterCrash_GetTimelineEntry(timeline, 1, &entry) == VK_FALSE);
+
+    const VkCommandBuffer commandBufferA = (VkCommandBuffer)0x100;
+    const VkCommandBuffer commandBufferB = (VkCommandBuffer)0x200;
+    CHECK(VkAfterCrash_CmdWriteTimelineMarker(commandBufferA, timeline, LABELS[0]) == 1);
+    CHECK(data[0] == 0 && data[1] == 0 && data[2] == 1 && data[3] == 0);
+    CHECK(VkAfterCrash_GetTimelineSequence(timeline) == 1);
+    CHECK(VkAfterCrash_GetTimelineEntry(timeline, 1, &entry) == VK_TRUE);
+    CHECK(entry.sequence == 1 && entry.vkCommandBuffer == commandBufferA && entry.label == LABELS[0]);
+
+    // 6 entries in a ring of 4, so 1 and 2 are overwritten.
+    for(uint32_t sequence = 2; sequence <= 6; ++sequence)
+        CHECK(VkAfterCrash_CmdWriteTimelineMarker(commandBufferB, timeline, LABELS[sequence % 4]) == sequence);
+    CHECK(data[2] == 6);
+    CHECK(VkAfterCrash_GetTimelineSequence(timeline) == 6);
+    CHECK(VkAfterCrash_GetTimelineEntry(timeline, 1, &entry) == VK_FALSE);
+    CHECK(VkAfterCrash_GetTimelineEntry(timeline, 2, &entry) == VK_FALSE);
+    for(uint32_t sequence = 3; sequence <= 6; ++sequence)
+    {
+        CHECK(VkAfterCrash_GetTimelineEntry(timeline, sequence, &entry) == VK_TRUE);
+        CHECK(entry.sequence == sequence && entry.vkCommandBuffer == commandBufferB &&
+            entry.label == LABELS[sequence % 4]);
+    }
+    CHECK(VkAfterCrash_GetTimelineEntry(timeline, 7, &entry) == VK_FALSE);
+
+    VkAfterCrash_DestroyTimeline(timeline);
+    VkAfterCrash_DestroyBuffer(buffer);
+    VkAfterCrash_DestroyDevice(device);
+}
+
+static void TestTimelineThreads()
+{
+    ResetMock();
+    VkAfterCrash_Device device = CreateDevice(0);
+    VkAfterCrash_BufferCreateInfo bufferCreateInfo = { 1 };
+    VkAfterCrash_Buffer buffer = nullptr;
+    uint32_t* data = nullptr;
+    CHECK(VkAfterCrash_CreateBuffer(device, &bufferCreateInfo, &buffer, &data) == VK_SUCCESS);
+    // Small, so threads often write entries with sequence numbers entryCount apart.
+    const uint32_t entryCount = 64;
+    VkAfterCrash_TimelineCreateInfo timelineCreateInfo = { buffer, 0, entryCount };
+    VkAfterCrash_Timeline timeline = nullptr;
+    CHECK(VkAfterCrash_CreateTimeline(device, &timelineCreateInfo, &timeline) == VK_SUCCESS);
+
+    // Thread i records command buffer i + 1 with label i, so an entry with
+    // any other pair is mixed from two entries.
+    const uint32_t threadCount = 4;
+    const uint32_t markerCount = 20000;
+    std::vector<std::vector<uint32_t>> sequences(threadCount);
+    std::vector<std::thread> threads;
+    for(uint32_t threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+    {
+        threads.emplace_back([&, threadIndex]() {
+            const VkCommandBuffer vkCommandBuffer = (VkCommandBuffer)(uintptr_t)(threadIndex + 1);
+            for(uint32_t i = 0; i < markerCount; ++i)
+                sequences[threadIndex].push_back(
+                    VkAfterCrash_CmdWriteTimelineMarker(vkCommandBuffer, timeline, LABELS[threadIndex]));
+        });
+    }
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> mixedCount(0);
+    std::thread reader([&]() {
+        while(!done)
+        {
+            const uint32_t lastSequence = VkAfterCrash_GetTimelineSequence(timeline);
+            for(uint32_t sequence = lastSequence - entryCount; sequence != lastSequence + entryCount; ++sequence)
+            {
+                VkAfterCrash_TimelineEntry entry = {};
+                if(VkAfterCrash_GetTimelineEntry(timeline, sequence, &entry) &&
+                    (entry.sequence != sequence ||
+                        (uintptr_t)entry.vkCommandBuffer < 1 ||
+                        (uintptr_t)entry.vkCommandBuffer > threadCount ||
+                        entry.label != LABELS[(uintptr_t)entry.vkCommandBuffer - 1]))
+                {
+                    ++mixedCount;
+                }
+            }
+        }
+    });
+    for(size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+    done = true;
+    reader.join();
+    CHECK(mixedCount == 0);
+
+    // Every sequence number was taken exactly once. The marker holds the last
+    // one of some thread.
+    const uint32_t totalCount = threadCount * markerCount;
+    std::vector<uint32_t> threadOfSequence(totalCount + 1, UINT32_MAX);
+    uint32_t duplicateCount = 0;
+    for(uint32_t threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+    {
+        for(size_t i = 0; i < sequences[threadIndex].size(); ++i)
+        {
+            const uint32_t sequence = sequences[threadIndex][i];
+            if(sequence == 0 || sequence > totalCount || threadOfSequence[sequence] != UINT32_MAX)
+                ++duplicateCount;
+            else
+                threadOfSequence[sequence] = threadIndex;
+        }
+    }
+    CHECK(duplicateCount == 0);
+    const uint32_t lastSequence = VkAfterCrash_GetTimelineSequence(timeline);
+    bool lastOfThread = false;
+    for(uint32_t threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+        lastOfThread = lastOfThread || sequences[threadIndex].back() == lastSequence;
+    CHECK(lastOfThread);
+
+    // Entries left in the ring belong to threads that took their numbers.
+    uint32_t foundCount = 0;
+    for(uint32_t sequence = totalCount - entryCount + 1; sequence <= totalCount; ++sequence)
+    {
+        VkAfterCrash_TimelineEntry entry = {};
+        if(VkAfterCrash_GetTimelineEntry(timeline, sequence, &entry))
+        {
+            ++foundCount;
+            CHECK(entry.vkCommandBuffer == (VkCommandBuffer)(uintptr_t)(threadOfSequence[sequence] + 1));
+            CHECK(entry.label == LABELS[threadOfSequence[sequence]]);
+        }
+    }
+    CHECK(foundCount > 0);
+
+    VkAfterCrash_DestroyTimeline(timeline);
+    VkAfterCrash_DestroyBuffer(buffer);
+    VkAfterCrash_DestroyDevice(device);
+}
+
+int main()
+{
+    TestPoolAllocation();
+    TestPoolMarkers();
+    TestPoolThreads();
+    TestBufferWithoutPool();
+    TestProfilerRegions();
+    TestProfilerLostTimestamps();
+    TestProfilerTimestampValidBits();
+    TestProfilerRegionRing();
+    TestProfilerTrace();
+    TestFileBackedBuffer();
+    TestFileBackedBufferFallback();
+    TestTimeline();
+    TestTimelineThreads();
+
+    if(g_FailedCount > 0)
+    {
+        printf("%d check(s) failed.\n", g_FailedCount);
+        return 1;
+    }
+    printf("All checks passed.\n");
+    return 0;
+}